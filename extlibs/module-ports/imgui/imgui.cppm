@@ -37,6 +37,13 @@ export using ::ImGuiTreeNodeFlags_NoTreePushOnOpen;
 export using ::ImGuiTreeNodeFlags_OpenOnArrow;
 export using ::ImGuiTreeNodeFlags_SpanAllColumns;
 export using ::ImGuiTreeNodeFlags_Selected;
+export using ::ImGuiWindowFlags;
+export using ::ImGuiWindowFlags_AlwaysAutoResize;
+export using ::ImGuiWindowFlags_NoDecoration;
+export using ::ImGuiWindowFlags_NoFocusOnAppearing;
+export using ::ImGuiWindowFlags_NoMove;
+export using ::ImGuiWindowFlags_NoNav;
+export using ::ImGuiWindowFlags_NoSavedSettings;
 export using ::ImTextureID;
 export using ::ImU32;
 export using ::ImVec2;
@@ -120,6 +127,8 @@ namespace ImGui {
     export using ImGui::SetCursorPosX;
     export using ImGui::SetItemDefaultFocus;
     export using ImGui::SetNextItemWidth;
+    export using ImGui::SetNextWindowBgAlpha;
+    export using ImGui::SetNextWindowPos;
     export using ImGui::TableHeadersRow;
     export using ImGui::TableNextRow;
     export using ImGui::TableSetColumnIndex;
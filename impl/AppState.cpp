@@ -63,6 +63,7 @@ void vk_gltf_viewer::AppState::GltfAsset::switchNodeVisibilityType() {
             nodeVisibilities.emplace<std::vector<std::optional<bool>>>(visibilities.size(), true);
         },
     }, nodeVisibilities);
+    notifyNodeVisibilitiesChanged();
 }
 
 auto vk_gltf_viewer::AppState::pushRecentGltfPath(const std::filesystem::path &path) -> void {
@@ -215,7 +215,9 @@ vk_gltf_viewer::MainApp::~MainApp() {
 
 void vk_gltf_viewer::MainApp::run() {
     vulkan::SharedData sharedData { gpu, swapchainExtent, swapchainImages };
-    std::array frames = ARRAY_OF(FRAMES_IN_FLIGHT, vulkan::Frame { gpu, sharedData });
+    // Worker threads for the concurrent command buffer recording, shared by the frames.
+    BS::thread_pool commandRecordingThreadPool { 2 };
+    std::array frames = ARRAY_OF(FRAMES_IN_FLIGHT, vulkan::Frame { gpu, sharedData, commandRecordingThreadPool });
 
     gpu.device.updateDescriptorSets({
         sharedData.imageBasedLightingDescriptorSet.getWriteOne<0>({ imageBasedLightingResources.cubemapSphericalHarmonicsBuffer, 0, vk::WholeSize }),
@@ -226,7 +228,17 @@ void vk_gltf_viewer::MainApp::run() {
     // Booleans that indicates frame at the corresponding index should handle swapchain resizing.
     std::array<bool, FRAMES_IN_FLIGHT> shouldHandleSwapchainResize{};
 
+    // Booleans that indicates frame at the corresponding index should re-record its cached scene rendering commands,
+    // because the descriptor sets or pipelines used by them are changed.
+    std::array<bool, FRAMES_IN_FLIGHT> shouldInvalidateSceneRenderingCommands{};
+
+    // Indices of the nodes whose local transforms are propagated by GPU in the last execution of the frame at the
+    // corresponding index, or std::nullopt if the propagation was not performed. Host side world transforms and scene
+    // bounds of their subtrees are updated when the propagated world transforms are read back from the frame.
+    std::array<std::optional<std::vector<std::size_t>>, FRAMES_IN_FLIGHT> gpuPropagatedNodeIndices{};
+
     std::vector<control::Task> tasks;
+    double lastTime = glfwGetTime();
     for (std::uint64_t frameIndex = 0; !glfwWindowShouldClose(window); frameIndex = (frameIndex + 1) % FRAMES_IN_FLIGHT) {
         tasks.clear();
 
@@ -242,20 +254,30 @@ void vk_gltf_viewer::MainApp::run() {
                 passthruRect,
             };
 
-            imguiTaskCollector.menuBar(appState.getRecentGltfPaths(), appState.getRecentSkyboxPaths());
+            imguiTaskCollector.menuBar(appState.getRecentGltfPaths(), appState.getRecentSkyboxPaths(), appState.interleaveVertexAttributes, appState.compressVertexAttributes, appState.gltfAsset.and_then(&AppState::GltfAsset::vertexAttributeCompressionError));
             if (auto &gltfAsset = appState.gltfAsset) {
                 imguiTaskCollector.assetInspector(gltfAsset->asset, gltf->directory);
                 imguiTaskCollector.materialEditor(gltfAsset->asset, gltfAsset->assetInspectorMaterialIndex, assetTextureDescriptorSets);
                 imguiTaskCollector.sceneHierarchy(gltfAsset->asset, gltfAsset->getSceneIndex(), gltfAsset->nodeVisibilities, gltfAsset->hoveringNodeIndex, gltfAsset->selectedNodeIndices);
                 imguiTaskCollector.nodeInspector(gltfAsset->asset, gltfAsset->selectedNodeIndices);
+                if (auto &playback = gltfAsset->animationPlayback) {
+                    imguiTaskCollector.animation(gltfAsset->asset, *playback, gltf->animations[playback->animationIndex].duration);
+                }
             }
             if (const auto &iblInfo = appState.imageBasedLightingProperties) {
                 imguiTaskCollector.imageBasedLighting(*iblInfo, skyboxResources->imGuiEqmapTextureDescriptorSet);
             }
             imguiTaskCollector.background(appState.canSelectSkyboxBackground, appState.background);
-            imguiTaskCollector.inputControl(appState.camera, appState.automaticNearFarPlaneAdjustment, appState.useFrustumCulling, appState.hoveringNodeOutline, appState.selectedNodeOutline);
+            imguiTaskCollector.inputControl(appState.camera, appState.automaticNearFarPlaneAdjustment, appState.useFrustumCulling, appState.useOcclusionCulling, appState.useGpuNodeTransformPropagation, appState.useMultithreadedCommandRecording, appState.commandRecordingDuration, appState.useFullDepthPrepass, appState.opaqueSubpassStatistics, appState.useCpuPicking, appState.hoveringNodeOutline, appState.selectedNodeOutline);
+            if (const auto &statistics = appState.occlusionCullingStatistics) {
+                imguiTaskCollector.occlusionCullingStatistics(*statistics);
+            }
             if (appState.gltfAsset && appState.gltfAsset->selectedNodeIndices.size() == 1) {
                 const std::size_t selectedNodeIndex = *appState.gltfAsset->selectedNodeIndices.begin();
+                if (gltf->sceneGpuBuffers.gpuNodeTransformPropagation) {
+                    // Host side world transforms may be outdated while GPU node transform propagation is used.
+                    gltf->sceneHierarchy.updateNodeTransformsOf(gltf->sceneHierarchy.getAncestorClosedNodeIndices({ &selectedNodeIndex, 1 }));
+                }
                 imguiTaskCollector.imguizmo(appState.camera, gltf->sceneHierarchy.nodeWorldTransforms[selectedNodeIndex], appState.imGuizmoOperation);
             }
             else {
@@ -263,7 +285,93 @@ void vk_gltf_viewer::MainApp::run() {
             }
         }
 
+        // Advance the animation playback time.
+        const double currentTime = glfwGetTime();
+        const float timeDelta = static_cast<float>(currentTime - std::exchange(lastTime, currentTime));
+        if (appState.gltfAsset && appState.gltfAsset->animationPlayback && appState.gltfAsset->animationPlayback->playing) {
+            AppState::GltfAsset::AnimationPlayback &playback = *appState.gltfAsset->animationPlayback;
+            const float duration = gltf->animations[playback.animationIndex].duration;
+            const float previousTime = playback.time;
+            playback.time += timeDelta;
+            if (playback.time > duration) {
+                if (playback.loop && duration > 0.f) {
+                    playback.time = std::fmod(playback.time, duration);
+                }
+                else {
+                    playback.time = duration;
+                    playback.playing = false;
+                }
+            }
+
+            // Sampling is skipped if the time is not changed (e.g. zero-length animation), or it is already requested
+            // by the animation window in this frame.
+            if (playback.time != previousTime && std::ranges::none_of(tasks, LIFT(holds_alternative<control::task::ChangeAnimationTime>))) {
+                tasks.emplace_back(std::in_place_type<control::task::ChangeAnimationTime>);
+            }
+        }
+
         bool regenerateDrawCommands = false;
+        bool propagateNodeWorldTransforms = false;
+        std::vector<std::size_t> propagatedNodeIndices; // Nodes whose local transforms are uploaded for GPU propagation in this frame.
+        bool deformMeshes = false;
+
+        // Host side transforms are not updated while GPU node transform propagation is used, therefore they have to
+        // be recalculated when it is turned off.
+        if (gltf && !appState.useGpuNodeTransformPropagation && gltf->sceneGpuBuffers.gpuNodeTransformPropagation) {
+            gltf->sceneGpuBuffers.gpuNodeTransformPropagation.reset();
+            gltf->sceneHierarchy.updateNodeTransforms();
+            for (std::size_t nodeIndex : gltf->scene.nodeIndices) {
+                gltf->sceneGpuBuffers.updateMeshNodeTransformsFrom(nodeIndex, gltf->sceneHierarchy);
+                gltf->refitSceneBounds(nodeIndex);
+            }
+            gpuPropagatedNodeIndices.fill(std::nullopt);
+        }
+
+        // Update the world transforms of the node (whose local transform is changed) and its descendants, and the
+        // mesh node transforms and scene bounds that are derived from them.
+        const auto updateNodeTransformsFrom = [&](std::size_t nodeIndex) {
+            if (appState.useGpuNodeTransformPropagation) {
+                // Only the changed local transform is uploaded, and the world transforms will be calculated by compute
+                // shader in this frame. Host side world transforms and scene bounds are updated from the readback.
+                if (gltf->sceneGpuBuffers.gpuNodeTransformPropagation) {
+                    gltf->sceneGpuBuffers.updateGpuNodeLocalTransform(nodeIndex);
+                }
+                else {
+                    gltf->sceneGpuBuffers.createGpuNodeTransformPropagation(gpu, gltf->sceneHierarchy);
+                }
+                propagateNodeWorldTransforms = true;
+                propagatedNodeIndices.push_back(nodeIndex);
+                deformMeshes = true;
+                return;
+            }
+
+            fastgltf::math::fmat4x4 nodeWorldTransform = visit(fastgltf::visitor {
+                [](const fastgltf::TRS &trs) { return toMatrix(trs); },
+                [](fastgltf::math::fmat4x4 matrix) { return matrix; }
+            }, gltf->asset.nodes[nodeIndex].transform);
+            if (auto parentNodeIndex = gltf->sceneHierarchy.getParentNodeIndex(nodeIndex)) {
+                nodeWorldTransform = gltf->sceneHierarchy.nodeWorldTransforms[*parentNodeIndex] * nodeWorldTransform;
+            }
+
+            // Update the current and its descendant nodes' world transforms in sceneHierarchy.
+            gltf->sceneHierarchy.updateDescendantNodeTransformsFrom(nodeIndex, nodeWorldTransform);
+
+            // Passing sceneHierarchy into sceneGpuBuffers to update GPU mesh node transform buffer.
+            gltf->sceneGpuBuffers.updateMeshNodeTransformsFrom(nodeIndex, gltf->sceneHierarchy);
+
+            gltf->refitSceneBounds(nodeIndex);
+            deformMeshes = true;
+        };
+
+        // Tighten the camera's near/far plane to the depth range of the mesh node instances that are inside the side
+        // planes of the view frustum. Near/far planes are excluded as they are what to be determined.
+        const auto tightenCameraNearFar = [&]() {
+            const math::Frustum frustum = appState.camera.getFrustum();
+            if (auto depthRange = gltf->sceneBvh.getDepthRange(appState.camera.position, normalize(appState.camera.direction), std::span { frustum.planes }.subspan(2))) {
+                appState.camera.tightenNearFar(depthRange->first, depthRange->second);
+            }
+        };
+
         for (const control::Task &task : tasks) {
             visit(multilambda {
                 [this](const control::task::ChangePassthruRect &task) {
@@ -276,7 +384,7 @@ void vk_gltf_viewer::MainApp::run() {
                     gpu.device.waitIdle();
 
                     try {
-                        gltf.emplace(parser, task.path, gpu);
+                        gltf.emplace(parser, task.path, gpu, appState.interleaveVertexAttributes, appState.compressVertexAttributes);
                     }
                     catch (gltf::AssetProcessError error) {
                         std::println(std::cerr, "The glTF file cannot be processed because of an error: {}", to_string(error));
@@ -293,7 +401,16 @@ void vk_gltf_viewer::MainApp::run() {
                         std::rethrow_exception(std::current_exception());
                     }
 
+                    // Skinned vertex buffers are not initialized yet.
+                    deformMeshes = true;
+
+                    // Transforms changed by the former tasks are for the previous asset.
+                    propagateNodeWorldTransforms = false;
+                    propagatedNodeIndices.clear();
+                    gpuPropagatedNodeIndices.fill(std::nullopt);
+
                     sharedData.updateTextureCount(1 + gltf->asset.textures.size());
+                    shouldInvalidateSceneRenderingCommands.fill(true);
 
                     std::vector<vk::DescriptorImageInfo> imageInfos;
                     imageInfos.reserve(1 + gltf->asset.textures.size());
@@ -312,6 +429,7 @@ void vk_gltf_viewer::MainApp::run() {
                         sharedData.assetDescriptorSet.getWriteOne<1>({ gltf->assetGpuBuffers.materialBuffer, 0, vk::WholeSize }),
                         sharedData.assetDescriptorSet.getWrite<2>(imageInfos),
                         sharedData.sceneDescriptorSet.getWriteOne<0>({ gltf->sceneGpuBuffers.nodeBuffer, 0, vk::WholeSize }),
+                        sharedData.sceneDescriptorSet.getWriteOne<1>({ gltf->sceneGpuBuffers.drawIndirectionBuffer, 0, vk::WholeSize }),
                     }, {});
 
                     // TODO: due to the ImGui's gamma correction issue, base color/emissive texture is rendered darker than it should be.
@@ -335,10 +453,13 @@ void vk_gltf_viewer::MainApp::run() {
 
                     // Update AppState.
                     appState.gltfAsset.emplace(gltf->asset);
+                    appState.gltfAsset->vertexAttributeCompressionError = gltf->assetGpuBuffers.attributeCompressionError.transform([](const gltf::AssetGpuBuffers::AttributeCompressionError &error) {
+                        return AppState::VertexAttributeCompressionError { error.maxNormalAngle, error.maxTangentAngle, error.maxTexcoordError };
+                    });
                     appState.pushRecentGltfPath(task.path);
 
                     // Adjust the camera based on the scene enclosing sphere.
-                    const auto &[center, radius] = gltf->sceneMiniball;
+                    const auto &[center, radius] = gltf->getSceneMiniball();
                     const float distance = radius / std::sin(appState.camera.fov / 2.f);
                     appState.camera.position = glm::make_vec3(center.data()) - glm::dvec3 { distance * normalize(appState.camera.direction) };
                     appState.camera.zMin = distance - radius;
@@ -347,6 +468,10 @@ void vk_gltf_viewer::MainApp::run() {
                 },
                 [&](control::task::CloseGltf) {
                     gltf.reset();
+                    propagateNodeWorldTransforms = false;
+                    propagatedNodeIndices.clear();
+                    gpuPropagatedNodeIndices.fill(std::nullopt);
+                    shouldInvalidateSceneRenderingCommands.fill(true);
 
                     // Update AppState.
                     appState.gltfAsset.reset();
@@ -360,6 +485,7 @@ void vk_gltf_viewer::MainApp::run() {
                         sharedData.imageBasedLightingDescriptorSet.getWriteOne<1>({ {}, *imageBasedLightingResources.prefilteredmapImageView, vk::ImageLayout::eShaderReadOnlyOptimal }),
                         sharedData.skyboxDescriptorSet.getWriteOne<0>({ {}, *skyboxResources->cubemapImageView, vk::ImageLayout::eShaderReadOnlyOptimal }),
                     }, {});
+                    shouldInvalidateSceneRenderingCommands.fill(true);
 
                     // Update AppState.
                     appState.pushRecentSkyboxPath(task.path);
@@ -370,16 +496,24 @@ void vk_gltf_viewer::MainApp::run() {
                     gpu.device.waitIdle();
 
                     gltf->setScene(task.newSceneIndex);
+                    deformMeshes = true;
 
-                    gpu.device.updateDescriptorSets(
+                    // Transforms changed by the former tasks are for the previous scene.
+                    propagateNodeWorldTransforms = false;
+                    propagatedNodeIndices.clear();
+                    gpuPropagatedNodeIndices.fill(std::nullopt);
+
+                    gpu.device.updateDescriptorSets({
                         sharedData.sceneDescriptorSet.getWriteOne<0>({ gltf->sceneGpuBuffers.nodeBuffer, 0, vk::WholeSize }),
-                        {});
+                        sharedData.sceneDescriptorSet.getWriteOne<1>({ gltf->sceneGpuBuffers.drawIndirectionBuffer, 0, vk::WholeSize }),
+                    }, {});
+                    shouldInvalidateSceneRenderingCommands.fill(true);
 
                     // Update AppState.
                     appState.gltfAsset->setScene(task.newSceneIndex);
 
                     // Adjust the camera based on the scene enclosing sphere.
-                    const auto &[center, radius] = gltf->sceneMiniball;
+                    const auto &[center, radius] = gltf->getSceneMiniball();
                     const float distance = radius / std::sin(appState.camera.fov / 2.f);
                     appState.camera.position = glm::make_vec3(center.data()) - glm::dvec3 { distance * normalize(appState.camera.direction) };
                     appState.camera.zMin = distance - radius;
@@ -400,7 +534,7 @@ void vk_gltf_viewer::MainApp::run() {
                             }
 
                             tristate::propagateTopDown(
-                                [&](auto i) -> decltype(auto) { return gltf->asset.nodes[i].children; },
+                                gltf->sceneHierarchy.getDescendantNodeIndices(task.nodeIndex),
                                 task.nodeIndex, visibilities);
                             tristate::propagateBottomUp(
                                 [&](auto i) { return gltf->sceneHierarchy.getParentNodeIndex(i).value_or(i); },
@@ -411,6 +545,7 @@ void vk_gltf_viewer::MainApp::run() {
                             visibilities[task.nodeIndex].flip();
                         },
                     }, appState.gltfAsset->nodeVisibilities);
+                    appState.gltfAsset->notifyNodeVisibilitiesChanged();
                 },
                 [this](const control::task::SelectNodeFromSceneHierarchy &task) {
                     if (!task.combine) {
@@ -421,33 +556,18 @@ void vk_gltf_viewer::MainApp::run() {
                 [this](const control::task::HoverNodeFromSceneHierarchy &task) {
                     appState.gltfAsset->hoveringNodeIndex.emplace(task.nodeIndex);
                 },
-                [this](const control::task::ChangeNodeLocalTransform &task) {
-                    fastgltf::math::fmat4x4 nodeWorldTransform = visit(fastgltf::visitor {
-                        [](const fastgltf::TRS &trs) { return toMatrix(trs); },
-                        [](fastgltf::math::fmat4x4 matrix) { return matrix; }
-                    }, gltf->asset.nodes[task.nodeIndex].transform);
-                    if (auto parentNodeIndex = gltf->sceneHierarchy.getParentNodeIndex(task.nodeIndex)) {
-                        nodeWorldTransform = gltf->sceneHierarchy.nodeWorldTransforms[*parentNodeIndex] * nodeWorldTransform;
-                    }
-
-                    // Update the current and its descendant nodes' world transforms in sceneHierarchy.
-                    gltf->sceneHierarchy.updateDescendantNodeTransformsFrom(task.nodeIndex, nodeWorldTransform);
+                [&](const control::task::ChangeNodeLocalTransform &task) {
+                    updateNodeTransformsFrom(task.nodeIndex);
 
-                    // Passing sceneHierarchy into sceneGpuBuffers to update GPU mesh node transform buffer.
-                    gltf->sceneGpuBuffers.updateMeshNodeTransformsFrom(task.nodeIndex, gltf->sceneHierarchy, gltf->assetExternalBuffers);
-
-                    // Scene enclosing sphere would be changed. Adjust the camera's near/far plane if necessary.
+                    // Scene bounds would be changed. Adjust the camera's near/far plane if necessary.
                     if (appState.automaticNearFarPlaneAdjustment) {
-                        const auto &[center, radius]
-                            = gltf->sceneMiniball
-                            = gltf::algorithm::getMiniball(
-                                gltf->asset, gltf->scene, [this](std::size_t nodeIndex, std::size_t instanceIndex) {
-                                    return cast<double>(gltf->sceneGpuBuffers.getMeshNodeWorldTransform(nodeIndex, instanceIndex));
-                                });
-                        appState.camera.tightenNearFar(glm::make_vec3(center.data()), radius);
+                        tightenCameraNearFar();
                     }
                 },
-                [this](control::task::ChangeSelectedNodeWorldTransform) {
+                [&](const control::task::ChangeNodeMorphTargetWeights&) {
+                    deformMeshes = true;
+                },
+                [&](control::task::ChangeSelectedNodeWorldTransform) {
                     const std::size_t selectedNodeIndex = *appState.gltfAsset->selectedNodeIndices.begin();
                     const fastgltf::math::fmat4x4 &selectedNodeWorldTransform = gltf->sceneHierarchy.nodeWorldTransforms[selectedNodeIndex];
 
@@ -461,21 +581,10 @@ void vk_gltf_viewer::MainApp::run() {
                     // (node world transform matrix) = (parent node world transform matrix) * (node local transform matrix).
                     // => (node local transform matrix) = (parent node world transform matrix)^-1 * (node world transform matrix).
 
-                    // TODO: replace this function with fastgltf provided if it exported.
-                    static constexpr auto affineInverse = []<typename T>(const fastgltf::math::mat<T, 4, 4>& m) noexcept {
-                        const auto inv = inverse(fastgltf::math::mat<T, 3, 3>(m));
-                        const auto l = -inv * fastgltf::math::vec<T, 3>(m.col(3));
-                        return fastgltf::math::mat<T, 4, 4>(
-                            fastgltf::math::vec<T, 4>(inv.col(0).x(), inv.col(0).y(), inv.col(0).z(), 0.f),
-                            fastgltf::math::vec<T, 4>(inv.col(1).x(), inv.col(1).y(), inv.col(1).z(), 0.f),
-                            fastgltf::math::vec<T, 4>(inv.col(2).x(), inv.col(2).y(), inv.col(2).z(), 0.f),
-                            fastgltf::math::vec<T, 4>(l.x(), l.y(), l.z(), 1.f));
-                    };
-
                     visit(fastgltf::visitor {
                         [&](fastgltf::math::fmat4x4 &transformMatrix) {
                             if (auto parentNodeIndex = gltf->sceneHierarchy.getParentNodeIndex(selectedNodeIndex)) {
-                                transformMatrix = affineInverse(gltf->sceneHierarchy.nodeWorldTransforms[*parentNodeIndex]) * selectedNodeWorldTransform;
+                                transformMatrix = fastgltf::math::affineInverse(gltf->sceneHierarchy.nodeWorldTransforms[*parentNodeIndex]) * selectedNodeWorldTransform;
                             }
                             else {
                                 transformMatrix = selectedNodeWorldTransform;
@@ -483,7 +592,7 @@ void vk_gltf_viewer::MainApp::run() {
                         },
                         [&](fastgltf::TRS &trs) {
                             if (auto parentNodeIndex = gltf->sceneHierarchy.getParentNodeIndex(selectedNodeIndex)) {
-                                const fastgltf::math::fmat4x4 transformMatrix = affineInverse(gltf->sceneHierarchy.nodeWorldTransforms[*parentNodeIndex]) * selectedNodeWorldTransform;
+                                const fastgltf::math::fmat4x4 transformMatrix = fastgltf::math::affineInverse(gltf->sceneHierarchy.nodeWorldTransforms[*parentNodeIndex]) * selectedNodeWorldTransform;
                                 decomposeTransformMatrix(transformMatrix, trs.scale, trs.rotation, trs.translation);
                             }
                             else {
@@ -492,34 +601,50 @@ void vk_gltf_viewer::MainApp::run() {
                         },
                     }, gltf->asset.nodes[selectedNodeIndex].transform);
 
-                    // Update the current and its descendant nodes' world transforms in sceneHierarchy.
-                    gltf->sceneHierarchy.updateDescendantNodeTransformsFrom(selectedNodeIndex, selectedNodeWorldTransform);
+                    updateNodeTransformsFrom(selectedNodeIndex);
 
-                    // Passing sceneHierarchy into sceneGpuBuffers to update GPU mesh node transform buffer.
-                    gltf->sceneGpuBuffers.updateMeshNodeTransformsFrom(selectedNodeIndex, gltf->sceneHierarchy, gltf->assetExternalBuffers);
+                    // Scene bounds would be changed. Adjust the camera's near/far plane if necessary.
+                    if (appState.automaticNearFarPlaneAdjustment) {
+                        tightenCameraNearFar();
+                    }
+                },
+                [&](control::task::ChangeAnimationTime) {
+                    // Asset could be changed by the former task in the same frame.
+                    if (!appState.gltfAsset || !appState.gltfAsset->animationPlayback) return;
+
+                    const AppState::GltfAsset::AnimationPlayback &playback = *appState.gltfAsset->animationPlayback;
+                    auto &animation = gltf->animations[playback.animationIndex];
+                    animation.update(playback.time, gltf->asset, gltf->threadPool);
+
+                    if (appState.useGpuNodeTransformPropagation) {
+                        // Every animated node's local transform has to be uploaded for GPU propagation.
+                        for (std::size_t nodeIndex : animation.getTransformedNodeIndices()) {
+                            updateNodeTransformsFrom(nodeIndex);
+                        }
+                    }
+                    else {
+                        // Updating from the topmost animated nodes also covers their animated descendants.
+                        for (std::size_t nodeIndex : gltf->sceneHierarchy.getTopmostNodeIndices(animation.getTransformedNodeIndices())) {
+                            updateNodeTransformsFrom(nodeIndex);
+                        }
+                    }
+
+                    if (!animation.getMorphedNodeIndices().empty()) {
+                        deformMeshes = true;
+                    }
 
-                    // Scene enclosing sphere would be changed. Adjust the camera's near/far plane if necessary.
                     if (appState.automaticNearFarPlaneAdjustment) {
-                        const auto &[center, radius]
-                            = gltf->sceneMiniball
-                            = gltf::algorithm::getMiniball(
-                                gltf->asset, gltf->scene, [this](std::size_t nodeIndex, std::size_t instanceIndex) {
-                                    return cast<double>(gltf->sceneGpuBuffers.getMeshNodeWorldTransform(nodeIndex, instanceIndex));
-                                });
-                        appState.camera.tightenNearFar(glm::make_vec3(center.data()), radius);
+                        tightenCameraNearFar();
                     }
                 },
-                [this](control::task::TightenNearFarPlane) {
+                [&](control::task::TightenNearFarPlane) {
                     if (gltf) {
-                        const auto &[center, radius] = gltf->sceneMiniball;
-                        appState.camera.tightenNearFar(glm::make_vec3(center.data()), radius);
+                        tightenCameraNearFar();
                     }
                 },
-                [this](control::task::ChangeCameraView) {
+                [&](control::task::ChangeCameraView) {
                     if (appState.automaticNearFarPlaneAdjustment && gltf) {
-                        // Tighten near/far plane based on the scene enclosing sphere.
-                        const auto &[center, radius] = gltf->sceneMiniball;
-                        appState.camera.tightenNearFar(glm::make_vec3(center.data()), radius);
+                        tightenCameraNearFar();
                     }
                 },
                 [&](control::task::InvalidateDrawCommandSeparation) {
@@ -528,10 +653,70 @@ void vk_gltf_viewer::MainApp::run() {
             }, task);
         }
 
+        if (gltf) {
+            // Joint matrices and morph target weights are recalculated at most once per frame, regardless of how many
+            // nodes are changed.
+            if (deformMeshes) {
+                if (gltf->sceneGpuBuffers.gpuNodeTransformPropagation) {
+                    // Host side world transforms may be outdated, therefore only the nodes that are needed for the
+                    // joint matrices are updated.
+                    gltf->sceneHierarchy.updateNodeTransformsOf(gltf->sceneSkinning.dependentNodeIndices);
+                }
+                gltf->sceneSkinning.updateJointMatrices(gltf->sceneHierarchy);
+                gltf->sceneMorphTargets.updateWeights();
+            }
+
+            gltf->updatePrimitiveTriangles(appState.useCpuPicking);
+        }
+
         // Wait for previous frame execution to end.
         vulkan::Frame &frame = frames[frameIndex];
         frame.waitForPreviousExecution();
 
+        const std::optional<vk::Offset2D> cursorPosFromPassthruRectTopLeft = appState.hoveringMousePosition.and_then([&](const glm::vec2 &position) -> std::optional<vk::Offset2D> {
+            // If cursor is outside the framebuffer, cursor position is undefined.
+            const glm::vec2 framebufferSize = window.getFramebufferSize();
+            const glm::vec2 framebufferCursorPosition = position * framebufferSize / glm::vec2 { window.getSize() };
+            if (framebufferCursorPosition.x >= framebufferSize.x || framebufferCursorPosition.y >= framebufferSize.y) return std::nullopt;
+
+            const vk::Offset2D offset {
+                static_cast<std::int32_t>(framebufferCursorPosition.x) - passthruRect.offset.x,
+                static_cast<std::int32_t>(framebufferCursorPosition.y) - passthruRect.offset.y
+            };
+            return value_if(0 <= offset.x && offset.x < passthruRect.extent.width && 0 <= offset.y && offset.y < passthruRect.extent.height, offset);
+        });
+
+        // GPU mouse picking pass is used until the triangles for the CPU picking are built.
+        const bool useCpuPicking = appState.useCpuPicking && gltf && gltf->primitiveTriangles;
+
+        std::optional<std::uint32_t> cpuPickedNodeIndex;
+        mousePickingNodeIndices.clear();
+        if (gltf && cursorPosFromPassthruRectTopLeft) {
+            // Cast the ray from the near plane (depth=1 in reversed depth) to the far plane (depth=0) through the pixel
+            // center. Viewport is negative, therefore the top of the passthru rect is NDC y=1.
+            const glm::vec2 ndc {
+                (cursorPosFromPassthruRectTopLeft->x + 0.5f) / passthruRect.extent.width * 2.f - 1.f,
+                1.f - (cursorPosFromPassthruRectTopLeft->y + 0.5f) / passthruRect.extent.height * 2.f,
+            };
+            const glm::mat4 inverseProjectionView = inverse(appState.camera.getProjectionViewMatrix());
+            const glm::vec4 nearPoint = inverseProjectionView * glm::vec4 { ndc, 1.f, 1.f };
+            const glm::vec4 farPoint = inverseProjectionView * glm::vec4 { ndc, 0.f, 1.f };
+            const glm::vec3 rayOrigin = glm::vec3 { nearPoint } / nearPoint.w;
+            const glm::vec3 rayDirection = glm::vec3 { farPoint } / farPoint.w - rayOrigin;
+
+            if (useCpuPicking) {
+                // The hovering node is determined in the current frame without the GPU mouse picking pass.
+                cpuPickedNodeIndex = gltf->pickNode(rayOrigin, rayDirection, appState.gltfAsset->getVisibleNodeIndices());
+                if (cpuPickedNodeIndex) {
+                    appState.gltfAsset->hoveringNodeIndex = cpuPickedNodeIndex;
+                }
+            }
+            else {
+                // Only the nodes that may be under the cursor are drawn in the GPU mouse picking pass.
+                gltf->collectRayCandidateNodeIndices(rayOrigin, rayDirection, appState.gltfAsset->getVisibleNodeIndices(), mousePickingNodeIndices);
+            }
+        }
+
         // Update frame resources.
         const vulkan::Frame::UpdateResult updateResult = frame.update({
             .passthruRect = passthruRect,
@@ -539,18 +724,11 @@ void vk_gltf_viewer::MainApp::run() {
             .frustum = value_if(appState.useFrustumCulling, [this]() {
                 return appState.camera.getFrustum();
             }),
-            .cursorPosFromPassthruRectTopLeft = appState.hoveringMousePosition.and_then([&](const glm::vec2 &position) -> std::optional<vk::Offset2D> {
-                // If cursor is outside the framebuffer, cursor position is undefined.
-                const glm::vec2 framebufferSize = window.getFramebufferSize();
-                const glm::vec2 framebufferCursorPosition = position * framebufferSize / glm::vec2 { window.getSize() };
-                if (framebufferCursorPosition.x >= framebufferSize.x || framebufferCursorPosition.y >= framebufferSize.y) return std::nullopt;
-
-                const vk::Offset2D offset {
-                    static_cast<std::int32_t>(framebufferCursorPosition.x) - passthruRect.offset.x,
-                    static_cast<std::int32_t>(framebufferCursorPosition.y) - passthruRect.offset.y
-                };
-                return value_if(0 <= offset.x && offset.x < passthruRect.extent.width && 0 <= offset.y && offset.y < passthruRect.extent.height, offset);
-            }),
+            .useOcclusionCulling = appState.useOcclusionCulling,
+            .useMultithreadedCommandRecording = appState.useMultithreadedCommandRecording,
+            .useFullDepthPrepass = appState.useFullDepthPrepass,
+            // Mouse picking pass is not needed if CPU picking is used.
+            .cursorPosFromPassthruRectTopLeft = useCpuPicking ? std::optional<vk::Offset2D>{} : cursorPosFromPassthruRectTopLeft,
             .gltf = gltf.transform([&](Gltf &gltf) {
                 assert(appState.gltfAsset && "Synchronization error: gltfAsset is not set in AppState.");
                 return vulkan::Frame::ExecutionTask::Gltf {
@@ -558,11 +736,17 @@ void vk_gltf_viewer::MainApp::run() {
                     .assetGpuBuffers = gltf.assetGpuBuffers,
                     .sceneHierarchy = gltf.sceneHierarchy,
                     .sceneGpuBuffers = gltf.sceneGpuBuffers,
+                    .sceneSkinning = gltf.sceneSkinning,
+                    .sceneMorphTargets = gltf.sceneMorphTargets,
+                    .shouldPropagateNodeWorldTransforms = propagateNodeWorldTransforms,
+                    .shouldDeformMeshes = deformMeshes,
                     .renderingNodes = {
                         .indices = appState.gltfAsset->getVisibleNodeIndices(),
+                        .sceneVersion = appState.gltfAsset->getSceneVersion(),
+                        .version = appState.gltfAsset->getNodeVisibilityVersion(),
                         .shouldRegenerateDrawCommands = regenerateDrawCommands,
                     },
-                    .hoveringNode = transform([&](std::uint16_t index, const AppState::Outline &outline) {
+                    .hoveringNode = transform([&](std::uint32_t index, const AppState::Outline &outline) {
                         return vulkan::Frame::ExecutionTask::Gltf::HoveringNode {
                             index, outline.color, outline.thickness, regenerateDrawCommands,
                         };
@@ -575,15 +759,47 @@ void vk_gltf_viewer::MainApp::run() {
                             regenerateDrawCommands,
                         };
                     }),
+                    .mousePickingNodeIndices = mousePickingNodeIndices,
                 };
             }),
             .solidBackground = appState.background.to_optional(),
             .handleSwapchainResize = std::exchange(shouldHandleSwapchainResize[frameIndex % frames.size()], false),
+            .invalidateSceneRenderingCommands = std::exchange(shouldInvalidateSceneRenderingCommands[frameIndex % frames.size()], false),
         });
 
         // Feedback the update result into this.
         if (appState.gltfAsset) {
-            appState.gltfAsset->hoveringNodeIndex = updateResult.hoveringNodeIndex;
+            appState.gltfAsset->hoveringNodeIndex = useCpuPicking ? cpuPickedNodeIndex : updateResult.hoveringNodeIndex;
+        }
+        appState.occlusionCullingStatistics = updateResult.occlusionCullingStatistics.transform([](const vulkan::CullingComputer::Statistics &statistics) {
+            return AppState::OcclusionCullingStatistics { statistics.testedInstanceCount, statistics.occludedInstanceCount };
+        });
+        if (updateResult.opaqueSubpassStatistics) {
+            // Keep the last statistics if the query result is not available yet.
+            appState.opaqueSubpassStatistics.emplace(updateResult.opaqueSubpassStatistics->vertexShaderInvocations, updateResult.opaqueSubpassStatistics->fragmentShaderInvocations);
+        }
+        if (gltf) {
+            // Changed transforms are copied into the frame's own buffer, and will be copied to the device by it.
+            gltf->sceneGpuBuffers.clearPendingBufferUpdates();
+
+            // Update the host side world transforms and scene bounds from the world transforms propagated by the
+            // previous execution of this frame.
+            std::optional<std::vector<std::size_t>> &readbackNodeIndices = gpuPropagatedNodeIndices[frameIndex % frames.size()];
+            if (updateResult.nodeWorldTransforms && readbackNodeIndices) {
+                for (std::size_t nodeIndex : gltf->sceneHierarchy.getTopmostNodeIndices(*readbackNodeIndices)) {
+                    for (std::size_t subtreeNodeIndex : gltf->sceneHierarchy.getSubtreeNodeIndices(nodeIndex)) {
+                        gltf->sceneHierarchy.nodeWorldTransforms[subtreeNodeIndex] = (*updateResult.nodeWorldTransforms)[subtreeNodeIndex];
+                    }
+                    gltf->refitSceneBounds(nodeIndex);
+                }
+            }
+
+            if (propagateNodeWorldTransforms) {
+                readbackNodeIndices.emplace(std::move(propagatedNodeIndices));
+            }
+            else {
+                readbackNodeIndices.reset();
+            }
         }
 
         try {
@@ -593,7 +809,8 @@ void vk_gltf_viewer::MainApp::run() {
                 *swapchain, ~0ULL, frame.getSwapchainImageAcquireSemaphore()).value;
 
             // Execute frame.
-            frame.recordCommandsAndSubmit(swapchainImageIndex);
+            appState.commandRecordingDuration = frame.recordCommandsAndSubmit(swapchainImageIndex);
+            ++sharedData.sceneRenderingTimelineValue;
 
             // Present the rendered swapchain image to swapchain.
             if (gpu.queues.graphicsPresent.presentKHR({
@@ -638,27 +855,153 @@ vk_gltf_viewer::MainApp::Gltf::Gltf(
     fastgltf::Parser &parser,
     const std::filesystem::path &path,
     const vulkan::Gpu &gpu [[clang::lifetimebound]],
-    BS::thread_pool threadPool
+    bool interleaveVertexAttributes,
+    bool compressVertexAttributes
 ) : dataBuffer { get_checked(fastgltf::GltfDataBuffer::FromPath(path)) },
     directory { path.parent_path() },
     asset { get_checked(parser.loadGltf(dataBuffer, directory)) },
     gpu { gpu },
-    assetGpuBuffers { asset, gpu, threadPool, assetExternalBuffers },
+    assetExternalBuffers { asset, directory, threadPool },
+    assetGpuBuffers { asset, gpu, threadPool, assetExternalBuffers, interleaveVertexAttributes, compressVertexAttributes },
     assetGpuTextures { asset, directory, gpu, threadPool, assetExternalBuffers },
-    sceneGpuBuffers { asset, scene, sceneHierarchy, gpu, assetExternalBuffers },
-    sceneMiniball { gltf::algorithm::getMiniball(asset, scene, [this](std::size_t nodeIndex, std::size_t instanceIndex) {
-        return cast<double>(sceneGpuBuffers.getMeshNodeWorldTransform(nodeIndex, instanceIndex));
-    }) } { }
+    animations { std::from_range, asset.animations | std::views::transform([this](const fastgltf::Animation &animation) {
+        return gltf::AssetAnimation { asset, animation, assetExternalBuffers };
+    }) },
+    sceneGpuBuffers { asset, scene, sceneHierarchy, gpu, threadPool, [this](std::size_t nodeIndex, const fastgltf::Primitive &primitive) { return assetGpuBuffers.getPrimitiveIndex(nodeIndex, primitive); }, assetExternalBuffers },
+    sceneSkinning { asset, sceneHierarchy, assetExternalBuffers },
+    sceneMorphTargets { asset, sceneHierarchy },
+    sceneBvh { asset, scene, sceneHierarchy, LIFT(getMeshNodeWorldTransform) } { }
 
 void vk_gltf_viewer::MainApp::Gltf::setScene(std::size_t sceneIndex) {
     scene = asset.scenes[sceneIndex];
     sceneHierarchy = { asset, scene };
-    sceneGpuBuffers = { asset, scene, sceneHierarchy, gpu, assetExternalBuffers };
-    sceneMiniball = gltf::algorithm::getMiniball(asset, scene, [this](std::size_t nodeIndex, std::size_t instanceIndex) {
-        return cast<double>(sceneGpuBuffers.getMeshNodeWorldTransform(nodeIndex, instanceIndex));
+    sceneGpuBuffers = { asset, scene, sceneHierarchy, gpu, threadPool, [this](std::size_t nodeIndex, const fastgltf::Primitive &primitive) { return assetGpuBuffers.getPrimitiveIndex(nodeIndex, primitive); }, assetExternalBuffers };
+    sceneSkinning = { asset, sceneHierarchy, assetExternalBuffers };
+    sceneMorphTargets = { asset, sceneHierarchy };
+    sceneBvh = { asset, scene, sceneHierarchy, LIFT(getMeshNodeWorldTransform) };
+    sceneMiniball.reset();
+    deformedMeshNodeIndices = createDeformedMeshNodeIndices();
+}
+
+const std::pair<fastgltf::math::dvec3, double> &vk_gltf_viewer::MainApp::Gltf::getSceneMiniball() {
+    if (!sceneMiniball) {
+        sceneMiniball.emplace(gltf::algorithm::getMiniball(asset, scene, LIFT(getMeshNodeWorldTransform)));
+    }
+    return *sceneMiniball;
+}
+
+void vk_gltf_viewer::MainApp::Gltf::refitSceneBounds(std::size_t nodeIndex) {
+    sceneBvh.refitFrom(nodeIndex, LIFT(getMeshNodeWorldTransform));
+    sceneMiniball.reset();
+}
+
+void vk_gltf_viewer::MainApp::Gltf::updatePrimitiveTriangles(bool enabled) {
+    if (!enabled) {
+        // Future from std::async waits for the pending build at the assignment.
+        primitiveTrianglesBuild = {};
+        primitiveTriangles.reset();
+        return;
+    }
+
+    if (primitiveTriangles) return;
+
+    if (!primitiveTrianglesBuild.valid()) {
+        // Not launched in threadPool, as the build itself waits for the parallel loop in it.
+        primitiveTrianglesBuild = std::async(std::launch::async, [this] {
+            return gltf::AssetPrimitiveTriangles { asset, threadPool, assetExternalBuffers };
+        });
+    }
+    else if (primitiveTrianglesBuild.wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
+        primitiveTriangles.emplace(primitiveTrianglesBuild.get());
+    }
+}
+
+std::optional<std::uint32_t> vk_gltf_viewer::MainApp::Gltf::pickNode(
+    const glm::vec3 &rayOrigin,
+    const glm::vec3 &rayDirection,
+    const std::unordered_set<std::uint32_t> &visibleNodeIndices
+) const {
+    if (!primitiveTriangles) {
+        return std::nullopt;
+    }
+
+    // Ray spans from the near plane to the far plane at t=[0, 1], and the intersection beyond the far plane is not visible.
+    return sceneBvh.getClosestIntersection(rayOrigin, rayDirection, 1.f, [&](const gltf::AssetSceneBvh::Leaf &leaf, float maxDistance) -> std::optional<float> {
+        if (!visibleNodeIndices.contains(leaf.nodeIndex)) {
+            return std::nullopt;
+        }
+
+        // Intersect in the instance's local space. The ray direction is not normalized after the transformation,
+        // therefore the distance is preserved.
+        const glm::mat4 transform { glm::make_mat4(getMeshNodeWorldTransform(leaf.nodeIndex, leaf.instanceIndex).data()) };
+        const glm::mat4 inverseTransform = inverse(transform);
+        const glm::vec3 localRayOrigin { inverseTransform * glm::vec4 { rayOrigin, 1.f } };
+        const glm::vec3 localRayDirection { inverseTransform * glm::vec4 { rayDirection, 0.f } };
+        const bool mirrored = determinant(glm::mat3 { transform }) < 0.f;
+
+        std::optional<float> result;
+        for (const fastgltf::Primitive &primitive : asset.meshes[*asset.nodes[leaf.nodeIndex].meshIndex].primitives) {
+            bool doubleSided = false;
+            if (primitive.materialIndex) {
+                const fastgltf::Material &material = asset.materials[*primitive.materialIndex];
+                if (material.alphaMode == fastgltf::AlphaMode::Mask && material.pbrData.baseColorFactor.w() < material.alphaCutoff) {
+                    continue;
+                }
+                doubleSided = material.doubleSided;
+            }
+
+            if (std::optional<float> distance = primitiveTriangles->intersect(primitive, localRayOrigin, localRayDirection, maxDistance, !doubleSided, mirrored)) {
+                result = maxDistance = *distance;
+            }
+        }
+        return result;
+    }).transform([](const auto &intersection) {
+        return intersection.first.nodeIndex;
     });
 }
 
+void vk_gltf_viewer::MainApp::Gltf::collectRayCandidateNodeIndices(
+    const glm::vec3 &rayOrigin,
+    const glm::vec3 &rayDirection,
+    const std::unordered_set<std::uint32_t> &visibleNodeIndices,
+    std::vector<std::uint32_t> &result
+) const {
+    result.clear();
+    sceneBvh.forEachLeafAlongRay(rayOrigin, rayDirection, [&](const gltf::AssetSceneBvh::Leaf &leaf) {
+        if (visibleNodeIndices.contains(leaf.nodeIndex)) {
+            result.push_back(leaf.nodeIndex);
+        }
+    });
+    for (std::uint32_t nodeIndex : deformedMeshNodeIndices) {
+        if (visibleNodeIndices.contains(nodeIndex)) {
+            result.push_back(nodeIndex);
+        }
+    }
+
+    // EXT_mesh_gpu_instancing node may have multiple leaves.
+    std::ranges::sort(result);
+    const auto [first, last] = std::ranges::unique(result);
+    result.erase(first, last);
+}
+
+std::vector<std::uint32_t> vk_gltf_viewer::MainApp::Gltf::createDeformedMeshNodeIndices() const {
+    std::vector<std::uint32_t> result;
+    for (std::size_t rootNodeIndex : scene.nodeIndices) {
+        for (std::size_t nodeIndex : sceneHierarchy.getSubtreeNodeIndices(rootNodeIndex)) {
+            if (!assetGpuBuffers.getDeformedPrimitives(nodeIndex).empty()) {
+                result.push_back(static_cast<std::uint32_t>(nodeIndex));
+            }
+        }
+    }
+    return result;
+}
+
+fastgltf::math::dmat4x4 vk_gltf_viewer::MainApp::Gltf::getMeshNodeWorldTransform(std::size_t nodeIndex, std::size_t instanceIndex) const noexcept {
+    // Mesh node transform buffer may not be updated yet if GPU node transform propagation is used, therefore
+    // calculate it from the host side transforms.
+    return cast<double>(sceneHierarchy.nodeWorldTransforms[nodeIndex] * sceneGpuBuffers.getInstanceLocalTransform(nodeIndex, static_cast<std::uint32_t>(instanceIndex)));
+}
+
 auto vk_gltf_viewer::MainApp::createInstance() const -> vk::raii::Instance {
     std::vector<const char*> extensions{
 #if __APPLE__
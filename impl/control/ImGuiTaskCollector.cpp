@@ -345,6 +345,12 @@ vk_gltf_viewer::control::ImGuiTaskCollector::~ImGuiTaskCollector() {
         }
         ImGui::End();
     }
+    if (!animationCalled) {
+        if (ImGui::Begin("Animation")) {
+            ImGui::TextUnformatted("No animation in the asset."sv);
+        }
+        ImGui::End();
+    }
     if (!imageBasedLightingCalled) {
         if (ImGui::Begin("IBL")) {
             ImGui::TextUnformatted("Input equirectangular map not loaded."sv);
@@ -357,7 +363,10 @@ vk_gltf_viewer::control::ImGuiTaskCollector::~ImGuiTaskCollector() {
 
 void vk_gltf_viewer::control::ImGuiTaskCollector::menuBar(
     const std::list<std::filesystem::path> &recentGltfs,
-    const std::list<std::filesystem::path> &recentSkyboxes
+    const std::list<std::filesystem::path> &recentSkyboxes,
+    bool &interleaveVertexAttributes,
+    bool &compressVertexAttributes,
+    const std::optional<AppState::VertexAttributeCompressionError> &vertexAttributeCompressionError
 ) {
     if (ImGui::BeginMainMenuBar()) {
         if (ImGui::BeginMenu("File")) {
@@ -386,6 +395,21 @@ void vk_gltf_viewer::control::ImGuiTaskCollector::menuBar(
             if (ImGui::MenuItem("Close glTF File", "Ctrl+W")) {
                 tasks.emplace_back(std::in_place_type<task::CloseGltf>);
             }
+            ImGui::Separator();
+            ImGui::MenuItem("Interleave Vertex Attributes", nullptr, &interleaveVertexAttributes);
+            ImGui::SameLine();
+            ImGui::HelperMarker("Vertex attributes will be repacked into a single stream per primitive at the next glTF loading.");
+            ImGui::MenuItem("Compress Vertex Attributes", nullptr, &compressVertexAttributes);
+            ImGui::SameLine();
+            ImGui::HelperMarker("Normals and tangents will be encoded to 32-bit octahedral, and texture coordinates to half floats at the next glTF loading.");
+            if (vertexAttributeCompressionError) {
+                // Error of the currently loaded asset.
+                ImGui::TextUnformatted(tempStringBuffer.write(
+                    "Max error: normal {:.4f} deg, tangent {:.4f} deg, texcoord {:.2e}",
+                    glm::degrees(vertexAttributeCompressionError->maxNormalAngle),
+                    glm::degrees(vertexAttributeCompressionError->maxTangentAngle),
+                    vertexAttributeCompressionError->maxTexcoordError));
+            }
             ImGui::EndMenu();
         }
         if (ImGui::BeginMenu("Skybox")) {
@@ -612,8 +636,8 @@ void vk_gltf_viewer::control::ImGuiTaskCollector::sceneHierarchy(
     fastgltf::Asset &asset,
     std::size_t sceneIndex,
     const std::variant<std::vector<std::optional<bool>>, std::vector<bool>> &visibilities,
-    const std::optional<std::uint16_t> &hoveringNodeIndex,
-    const std::unordered_set<std::uint16_t> &selectedNodeIndices
+    const std::optional<std::uint32_t> &hoveringNodeIndex,
+    const std::unordered_set<std::uint32_t> &selectedNodeIndices
 ) {
     if (ImGui::Begin("Scene Hierarchy")) {
         if (ImGui::BeginCombo("Scene", nonempty_or(asset.scenes[sceneIndex].name, [&]() { return tempStringBuffer.write("<Unnamed scene {}>", sceneIndex).view(); }).c_str())) {
@@ -816,14 +840,14 @@ void vk_gltf_viewer::control::ImGuiTaskCollector::sceneHierarchy(
 
 void vk_gltf_viewer::control::ImGuiTaskCollector::nodeInspector(
     fastgltf::Asset &asset,
-    const std::unordered_set<std::uint16_t> &selectedNodeIndices
+    const std::unordered_set<std::uint32_t> &selectedNodeIndices
 ) {
     if (ImGui::Begin("Node Inspector")) {
         if (selectedNodeIndices.empty()) {
             ImGui::TextUnformatted("No nodes are selected."sv);
         }
         else if (selectedNodeIndices.size() == 1) {
-            const std::uint16_t selectedNodeIndex = *selectedNodeIndices.begin();
+            const std::uint32_t selectedNodeIndex = *selectedNodeIndices.begin();
             fastgltf::Node &node = asset.nodes[selectedNodeIndex];
             ImGui::InputTextWithHint("Name", "<empty>", &node.name);
 
@@ -878,6 +902,30 @@ void vk_gltf_viewer::control::ImGuiTaskCollector::nodeInspector(
                     fastgltf::Mesh &mesh = asset.meshes[*node.meshIndex];
                     ImGui::InputTextWithHint("Name", "<empty>", &mesh.name);
 
+                    // All primitives of a mesh have the same number of morph targets.
+                    if (const std::size_t targetCount = mesh.primitives.empty() ? 0 : mesh.primitives[0].targets.size();
+                        targetCount != 0 && ImGui::CollapsingHeader("Morph target weights")) {
+                        for (std::size_t targetIndex : ranges::views::upto(targetCount)) {
+                            // Node weights override the mesh weights, which default to zeros.
+                            float weight = node.weights.size() == targetCount ? node.weights[targetIndex]
+                                : mesh.weights.size() == targetCount ? mesh.weights[targetIndex] : 0.f;
+                            // glTF does not restrict the weight range, and negative or greater than 1 weights are valid.
+                            if (ImGui::DragFloat(tempStringBuffer.write("Target {}", targetIndex).view().c_str(), &weight, 0.01f)) {
+                                if (node.weights.size() != targetCount) {
+                                    if (mesh.weights.size() == targetCount) {
+                                        node.weights.assign(mesh.weights.begin(), mesh.weights.end());
+                                    }
+                                    else {
+                                        node.weights.clear();
+                                        node.weights.resize(targetCount, 0.f);
+                                    }
+                                }
+                                node.weights[targetIndex] = weight;
+                                tasks.emplace_back(std::in_place_type<task::ChangeNodeMorphTargetWeights>, selectedNodeIndex);
+                            }
+                        }
+                    }
+
                     for (auto &&[primitiveIndex, primitive]: mesh.primitives | ranges::views::enumerate) {
                         if (ImGui::CollapsingHeader(tempStringBuffer.write("Primitive {}", primitiveIndex).view().c_str())) {
                             ImGui::LabelText("Type", "%s", to_string(primitive.type).c_str());
@@ -930,6 +978,45 @@ void vk_gltf_viewer::control::ImGuiTaskCollector::nodeInspector(
     nodeInspectorCalled = true;
 }
 
+void vk_gltf_viewer::control::ImGuiTaskCollector::animation(
+    const fastgltf::Asset &asset,
+    AppState::GltfAsset::AnimationPlayback &playback,
+    float duration
+) {
+    if (ImGui::Begin("Animation")) {
+        const auto getAnimationName = [&](std::size_t animationIndex) {
+            return nonempty_or(asset.animations[animationIndex].name, [&]() { return tempStringBuffer.write("<Unnamed animation {}>", animationIndex).view(); });
+        };
+        if (ImGui::BeginCombo("Animation", getAnimationName(playback.animationIndex).c_str())) {
+            for (std::size_t animationIndex : ranges::views::upto(asset.animations.size())) {
+                if (ImGui::Selectable(getAnimationName(animationIndex).c_str(), animationIndex == playback.animationIndex) && animationIndex != playback.animationIndex) {
+                    playback.animationIndex = animationIndex;
+                    playback.time = 0.f;
+                    tasks.emplace_back(std::in_place_type<task::ChangeAnimationTime>);
+                }
+            }
+            ImGui::EndCombo();
+        }
+
+        if (ImGui::Button(playback.playing ? "Pause" : "Play")) {
+            // Restart from the beginning if the non-looping playback is already finished.
+            if (!playback.playing && !playback.loop && playback.time >= duration) {
+                playback.time = 0.f;
+            }
+            playback.playing = !playback.playing;
+        }
+        ImGui::SameLine();
+        ImGui::Checkbox("Loop", &playback.loop);
+
+        if (ImGui::SliderFloat("Time", &playback.time, 0.f, duration, "%.3f s")) {
+            tasks.emplace_back(std::in_place_type<task::ChangeAnimationTime>);
+        }
+    }
+    ImGui::End();
+
+    animationCalled = true;
+}
+
 void vk_gltf_viewer::control::ImGuiTaskCollector::background(
     bool canSelectSkyboxBackground,
     full_optional<glm::vec3> &solidBackground
@@ -1001,6 +1088,13 @@ void vk_gltf_viewer::control::ImGuiTaskCollector::inputControl(
     Camera &camera,
     bool &automaticNearFarPlaneAdjustment,
     bool &useFrustumCulling,
+    bool &useOcclusionCulling,
+    bool &useGpuNodeTransformPropagation,
+    bool &useMultithreadedCommandRecording,
+    std::chrono::nanoseconds commandRecordingDuration,
+    bool &useFullDepthPrepass,
+    const std::optional<AppState::OpaqueSubpassStatistics> &opaqueSubpassStatistics,
+    bool &useCpuPicking,
     full_optional<AppState::Outline> &hoveringNodeOutline,
     full_optional<AppState::Outline> &selectedNodeOutline
 ) {
@@ -1038,9 +1132,45 @@ void vk_gltf_viewer::control::ImGuiTaskCollector::inputControl(
             ImGui::Checkbox("Use Frustum Culling", &useFrustumCulling);
             ImGui::SameLine();
             ImGui::HelperMarker("The primitives outside the camera frustum will be culled.");
+
+            ImGui::WithDisabled([&]() {
+                ImGui::Checkbox("Use Occlusion Culling", &useOcclusionCulling);
+            }, !useFrustumCulling);
+            ImGui::SameLine();
+            ImGui::HelperMarker("The primitives hidden behind the primitives visible in the last frame will be culled, by testing their bounding spheres against the hierarchical depth buffer.");
+
+            ImGui::Checkbox("Propagate Node Transforms on GPU", &useGpuNodeTransformPropagation);
+            ImGui::SameLine();
+            ImGui::HelperMarker("When a node transform is changed, the mesh node world transforms will be calculated by compute shader.");
+        }
+
+        if (ImGui::CollapsingHeader("Command recording")) {
+            ImGui::Checkbox("Multithreaded recording", &useMultithreadedCommandRecording);
+            ImGui::SameLine();
+            ImGui::HelperMarker("The scene prepass, compute passes and scene rendering command buffers will be recorded concurrently by the worker threads.");
+
+            ImGui::TextUnformatted(tempStringBuffer.write("Recording time: {:.3f} ms", std::chrono::duration<float, std::milli> { commandRecordingDuration }.count()));
+        }
+
+        if (ImGui::CollapsingHeader("Opaque rendering")) {
+            ImGui::Checkbox("Full depth prepass", &useFullDepthPrepass);
+            ImGui::SameLine();
+            ImGui::HelperMarker("The depths of the opaque and alpha masked primitives will be rendered first, and then only the visible fragments will be shaded by the equal depth test.");
+
+            if (opaqueSubpassStatistics) {
+                ImGui::TextUnformatted(tempStringBuffer.write("Vertex shader invocations: {}", opaqueSubpassStatistics->vertexShaderInvocationCount));
+                ImGui::TextUnformatted(tempStringBuffer.write("Fragment shader invocations: {}", opaqueSubpassStatistics->fragmentShaderInvocationCount));
+            }
+            else {
+                ImGui::TextUnformatted("Pipeline statistics are not available.");
+            }
         }
 
         if (ImGui::CollapsingHeader("Node selection")) {
+            ImGui::Checkbox("Ray-cast picking on CPU", &useCpuPicking);
+            ImGui::SameLine();
+            ImGui::HelperMarker("The hovering node will be picked by casting a ray against the scene triangles in the host, instead of rendering the node indices. Texture alpha and mesh deformation are not considered.");
+
             bool showHoveringNodeOutline = hoveringNodeOutline.has_value();
             if (ImGui::Checkbox("Hovering node outline", &showHoveringNodeOutline)) {
                 hoveringNodeOutline.set_active(showHoveringNodeOutline);
@@ -1063,6 +1193,18 @@ void vk_gltf_viewer::control::ImGuiTaskCollector::inputControl(
     ImGui::End();
 }
 
+void vk_gltf_viewer::control::ImGuiTaskCollector::occlusionCullingStatistics(const AppState::OcclusionCullingStatistics &statistics) {
+    // Overlay at the top left corner of the passthru rect.
+    ImGui::SetNextWindowPos(centerNodeRect.Min + ImVec2 { 8.f, 8.f });
+    ImGui::SetNextWindowBgAlpha(0.5f);
+    if (ImGui::Begin("Occlusion culling statistics", nullptr,
+        ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove)) {
+        const float occludedPercentage = statistics.testedInstanceCount == 0 ? 0.f : 100.f * statistics.occludedInstanceCount / statistics.testedInstanceCount;
+        ImGui::TextUnformatted(tempStringBuffer.write("Occluded: {}/{} ({:.1f}%)", statistics.occludedInstanceCount, statistics.testedInstanceCount, occludedPercentage));
+    }
+    ImGui::End();
+}
+
 void vk_gltf_viewer::control::ImGuiTaskCollector::imguizmo(Camera &camera) {
     // Set ImGuizmo rect.
     ImGuizmo::BeginFrame();
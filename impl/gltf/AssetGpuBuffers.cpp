@@ -95,32 +95,60 @@ vku::AllocatedBuffer vk_gltf_viewer::gltf::AssetGpuBuffers::createMaterialBuffer
 }
 
 vku::AllocatedBuffer vk_gltf_viewer::gltf::AssetGpuBuffers::createPrimitiveBuffer() {
-    vku::AllocatedBuffer stagingBuffer = vku::MappedBuffer {
-        gpu.allocator,
-        std::from_range, orderedPrimitives | std::views::transform([this](const fastgltf::Primitive *pPrimitive) {
+    const auto createGpuPrimitive = [](
+        const AssetPrimitiveInfo &primitiveInfo,
+        const AssetPrimitiveInfo::AttributeBufferInfo &positionInfo,
+        const AssetPrimitiveInfo::AttributeBufferInfo &normalInfo,
+        const AssetPrimitiveInfo::AttributeBufferInfo &tangentInfo
+    ) {
+        return GpuPrimitive {
+            .pPositionBuffer = positionInfo.address,
+            .pNormalBuffer = normalInfo.address,
+            .pTangentBuffer = tangentInfo.address,
+            .pTexcoordAttributeMappingInfoBuffer = primitiveInfo.texcoordsInfo.pMappingBuffer,
+            .pColorAttributeMappingInfoBuffer = primitiveInfo.colorsInfo.pMappingBuffer,
+            .positionByteStride = positionInfo.byteStride,
+            .normalByteStride = normalInfo.byteStride,
+            .tangentByteStride = tangentInfo.byteStride,
+            .attributeEncodingFlags = static_cast<std::uint8_t>(
+                (normalInfo.componentType == AssetPrimitiveInfo::ComponentType::Octahedral ? 0b01U : 0U)
+                | (tangentInfo.componentType == AssetPrimitiveInfo::ComponentType::Octahedral ? 0b10U : 0U)),
+            .materialIndex
+                = primitiveInfo.materialIndex.transform([](std::size_t index) {
+                    return 1U /* index 0 is reserved for the fallback material */ + static_cast<std::uint32_t>(index);
+                })
+                .value_or(0U),
+        };
+    };
+
+    // If normal and tangent not presented (nullopt), it will use a faceted mesh renderer, and they will does not
+    // dereference those buffers. Therefore, it is okay to pass nullptr into shaders
+    std::vector<GpuPrimitive> gpuPrimitives
+        = orderedPrimitives
+        | std::views::transform([&](const fastgltf::Primitive *pPrimitive) {
             const AssetPrimitiveInfo &primitiveInfo = primitiveInfos[pPrimitive];
+            return createGpuPrimitive(
+                primitiveInfo,
+                primitiveInfo.positionInfo,
+                primitiveInfo.normalInfo.value_or(AssetPrimitiveInfo::AttributeBufferInfo{}),
+                primitiveInfo.tangentInfo.value_or(AssetPrimitiveInfo::AttributeBufferInfo{}));
+        })
+        | std::ranges::to<std::vector>();
 
-            // If normal and tangent not presented (nullopt), it will use a faceted mesh renderer, and they will does not
-            // dereference those buffers. Therefore, it is okay to pass nullptr into shaders
-            const auto normalInfo = primitiveInfo.normalInfo.value_or(AssetPrimitiveInfo::AttributeBufferInfo{});
-            const auto tangentInfo = primitiveInfo.tangentInfo.value_or(AssetPrimitiveInfo::AttributeBufferInfo{});
-
-            return GpuPrimitive {
-                .pPositionBuffer = primitiveInfo.positionInfo.address,
-                .pNormalBuffer = normalInfo.address,
-                .pTangentBuffer = tangentInfo.address,
-                .pTexcoordAttributeMappingInfoBuffer = primitiveInfo.texcoordsInfo.pMappingBuffer,
-                .pColorAttributeMappingInfoBuffer = 0ULL, // TODO: implement color attribute mapping.
-                .positionByteStride = primitiveInfo.positionInfo.byteStride,
-                .normalByteStride = normalInfo.byteStride,
-                .tangentByteStride = tangentInfo.byteStride,
-                .materialIndex
-                    = primitiveInfo.materialIndex.transform([](std::size_t index) {
-                        return 1U /* index 0 is reserved for the fallback material */ + static_cast<std::uint32_t>(index);
-                    })
-                    .value_or(0U),
-            };
-        }),
+    // Node specific primitives are rendered from the compute deformation outputs, which are tightly packed float vec4s.
+    gpuPrimitives.append_range(deformedPrimitives | std::views::transform([&](const DeformedPrimitive &deformedPrimitive) {
+        const AssetPrimitiveInfo &primitiveInfo = primitiveInfos[deformedPrimitive.pPrimitive];
+        const AssetPrimitiveInfo::DeformedAttributeBufferInfo &attributeBufferInfo = deformedPrimitive.attributeBufferInfo;
+        return createGpuPrimitive(
+            primitiveInfo,
+            { .address = attributeBufferInfo.pPositionBuffer, .byteStride = 16 },
+            primitiveInfo.normalInfo ? AssetPrimitiveInfo::AttributeBufferInfo { .address = attributeBufferInfo.pNormalBuffer, .byteStride = 16 } : AssetPrimitiveInfo::AttributeBufferInfo{},
+            primitiveInfo.tangentInfo ? AssetPrimitiveInfo::AttributeBufferInfo { .address = attributeBufferInfo.pTangentBuffer, .byteStride = 16 } : AssetPrimitiveInfo::AttributeBufferInfo{});
+    }));
+
+    vku::AllocatedBuffer stagingBuffer = vku::MappedBuffer {
+        gpu.allocator,
+        std::from_range, gpuPrimitives,
         gpu.isUmaDevice ? vk::BufferUsageFlagBits::eStorageBuffer : vk::BufferUsageFlagBits::eTransferSrc,
     }.unmap();
 
@@ -140,22 +168,69 @@ vku::AllocatedBuffer vk_gltf_viewer::gltf::AssetGpuBuffers::createPrimitiveBuffe
     return dstBuffer;
 }
 
+vku::AllocatedBuffer vk_gltf_viewer::gltf::AssetGpuBuffers::createPrimitiveBoundingSphereBuffer() {
+    std::vector<glm::vec4> boundingSpheres
+        = orderedPrimitives
+        | std::views::transform([this](const fastgltf::Primitive *pPrimitive) {
+            const AssetPrimitiveInfo &primitiveInfo = primitiveInfos[pPrimitive];
+            const glm::vec3 center { (primitiveInfo.min + primitiveInfo.max) / 2.0 };
+            const float radius = static_cast<float>(length(primitiveInfo.max - primitiveInfo.min) / 2.0);
+            return glm::vec4 { center, radius };
+        })
+        | std::ranges::to<std::vector>();
+
+    // Bounds of the node specific deformed primitives are not known.
+    boundingSpheres.resize(boundingSpheres.size() + deformedPrimitives.size(), glm::vec4 { 0.f, 0.f, 0.f, -1.f });
+
+    vku::AllocatedBuffer stagingBuffer = vku::MappedBuffer {
+        gpu.allocator,
+        std::from_range, boundingSpheres,
+        // Staging buffer is used as is if it is device local (including resizable BAR of the discrete GPU), therefore
+        // it must have the usages of the culling compute shader access.
+        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress
+            | (gpu.isUmaDevice ? vk::BufferUsageFlags{} : vk::BufferUsageFlagBits::eTransferSrc),
+    }.unmap();
+
+    if (gpu.isUmaDevice || vku::contains(gpu.allocator.getAllocationMemoryProperties(stagingBuffer.allocation), vk::MemoryPropertyFlagBits::eDeviceLocal)) {
+        return stagingBuffer;
+    }
+
+    vku::AllocatedBuffer dstBuffer{ gpu.allocator, vk::BufferCreateInfo {
+        {},
+        stagingBuffer.size,
+        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+    } };
+    stagingInfos.emplace_back(
+        std::move(stagingBuffer),
+        dstBuffer,
+        vk::BufferCopy{ 0, 0, dstBuffer.size });
+    return dstBuffer;
+}
+
 void vk_gltf_viewer::gltf::AssetGpuBuffers::createPrimitiveIndexedAttributeMappingBuffers() {
-    // Collect primitives that have any TEXCOORD attributes.
-    const std::vector primitiveWithTexcoordAttributeInfos
-        = primitiveInfos
-        | std::views::values
-        | std::views::filter([](const AssetPrimitiveInfo &primitiveInfo) { return !primitiveInfo.texcoordsInfo.attributeInfos.empty(); })
-        | std::views::transform([](AssetPrimitiveInfo &primitiveInfo) { return std::tie(primitiveInfo, primitiveInfo.texcoordsInfo.attributeInfos); })
+    // Collect (IndexedAttributeBufferInfos, attributeInfos) pairs of primitives that have any TEXCOORD or COLOR attributes.
+    const auto getNonEmptyInfos = [this](AssetPrimitiveInfo::IndexedAttributeBufferInfos AssetPrimitiveInfo::*member) {
+        return primitiveInfos
+            | std::views::values
+            | std::views::transform([=](AssetPrimitiveInfo &primitiveInfo) -> AssetPrimitiveInfo::IndexedAttributeBufferInfos& {
+                return primitiveInfo.*member;
+            })
+            | std::views::filter([](const AssetPrimitiveInfo::IndexedAttributeBufferInfos &infos) { return !infos.attributeInfos.empty(); })
+            | std::views::transform([](AssetPrimitiveInfo::IndexedAttributeBufferInfos &infos) { return std::tie(infos, infos.attributeInfos); });
+    };
+    const std::vector indexedAttributeBufferInfos
+        = ranges::views::concat(
+            getNonEmptyInfos(&AssetPrimitiveInfo::texcoordsInfo),
+            getNonEmptyInfos(&AssetPrimitiveInfo::colorsInfo))
         | std::ranges::to<std::vector>();
 
-    if (primitiveWithTexcoordAttributeInfos.empty()) {
+    if (indexedAttributeBufferInfos.empty()) {
         return;
     }
 
     auto [buffer, copyOffsets] = createCombinedStagingBuffer(
         gpu.allocator,
-        primitiveWithTexcoordAttributeInfos | std::views::values,
+        indexedAttributeBufferInfos | std::views::values,
         gpu.isUmaDevice
             ? vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress
             : vk::BufferUsageFlagBits::eTransferSrc);
@@ -174,8 +249,8 @@ void vk_gltf_viewer::gltf::AssetGpuBuffers::createPrimitiveIndexedAttributeMappi
     }
 
     const vk::DeviceAddress pIndexAttributeMappingBuffer = gpu.device.getBufferAddress({ buffer });
-    for (auto &&[primitiveInfo, copyOffset] : std::views::zip(primitiveWithTexcoordAttributeInfos | std::views::keys, copyOffsets)) {
-        primitiveInfo.texcoordsInfo.pMappingBuffer = pIndexAttributeMappingBuffer + copyOffset;
+    for (auto &&[infos, copyOffset] : std::views::zip(indexedAttributeBufferInfos | std::views::keys, copyOffsets)) {
+        infos.pMappingBuffer = pIndexAttributeMappingBuffer + copyOffset;
     }
 
     internalBuffers.emplace_back(std::move(buffer));
@@ -6,20 +6,216 @@ module vk_gltf_viewer;
 import :gltf.AssetSceneGpuBuffers;
 
 import std;
-import :gltf.algorithm.traversal;
 import :helpers.fastgltf;
 import :helpers.ranges;
 
 #define FWD(...) static_cast<decltype(__VA_ARGS__) &&>(__VA_ARGS__)
 #define LIFT(...) [&](auto &&...xs) { return (__VA_ARGS__)(FWD(xs)...); }
 
-const fastgltf::math::fmat4x4 &vk_gltf_viewer::gltf::AssetSceneGpuBuffers::getMeshNodeWorldTransform(std::uint16_t nodeIndex, std::uint32_t instanceIndex) const noexcept {
-    return meshNodeWorldTransformBuffer.asRange<const fastgltf::math::fmat4x4>()[instanceOffsets[nodeIndex] + instanceIndex];
+/**
+ * @brief Create a device local storage buffer that has the content of \p data.
+ *
+ * The data is written into a host visible staging buffer. If it is device local (UMA device, or resizable BAR on the
+ * discrete GPU), the staging buffer is used as is, otherwise it is copied into a new device local buffer. As both can
+ * be returned, the staging buffer is created with the final usage.
+ *
+ * @param gpu GPU that is used for the buffer creation and the transfer.
+ * @param data Data to be written.
+ * @param additionalUsage Usage of the result other than the storage buffer and the shader device address, e.g. the
+ * transfer destination for the buffer that is updated by the frames.
+ * @return Storage buffer that has the content of \p data.
+ */
+[[nodiscard]] vku::AllocatedBuffer createDeviceLocalStorageBuffer(
+    const vk_gltf_viewer::vulkan::Gpu &gpu,
+    std::ranges::input_range auto &&data,
+    vk::BufferUsageFlags additionalUsage = {}
+) {
+    const vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress | additionalUsage;
+    vku::AllocatedBuffer stagingBuffer = vku::MappedBuffer {
+        gpu.allocator,
+        std::from_range, FWD(data),
+        gpu.isUmaDevice ? usage : usage | vk::BufferUsageFlagBits::eTransferSrc,
+    }.unmap();
+    if (gpu.isUmaDevice || vku::contains(gpu.allocator.getAllocationMemoryProperties(stagingBuffer.allocation), vk::MemoryPropertyFlagBits::eDeviceLocal)) {
+        return stagingBuffer;
+    }
+
+    vku::AllocatedBuffer dstBuffer{ gpu.allocator, vk::BufferCreateInfo {
+        {},
+        stagingBuffer.size,
+        usage | vk::BufferUsageFlagBits::eTransferDst,
+    } };
+
+    const vk::raii::CommandPool transferCommandPool { gpu.device, vk::CommandPoolCreateInfo { {}, gpu.queueFamilies.transfer } };
+    const vk::raii::Fence fence { gpu.device, vk::FenceCreateInfo{} };
+    vku::executeSingleCommand(*gpu.device, *transferCommandPool, gpu.queues.transfer, [&](vk::CommandBuffer cb) {
+        cb.copyBuffer(stagingBuffer, dstBuffer, vk::BufferCopy { 0, 0, dstBuffer.size });
+    }, *fence);
+
+    std::ignore = gpu.device.waitForFences(*fence, true, ~0ULL); // TODO: failure handling
+
+    return dstBuffer;
 }
 
-std::vector<std::uint32_t> vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createInstanceCounts(const fastgltf::Scene &scene) const {
+/**
+ * @brief Sort and coalesce the overlapping or adjacent ranges of \p data, and append them into \p updates.
+ * @param ranges (offset, count) ranges of \p data.
+ * @param dstBuffer Destination buffer, whose layout is as same as \p data.
+ * @param data Host data.
+ * @param updates Buffer updates to be appended.
+ */
+void appendCoalescedBufferUpdates(
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> ranges,
+    vk::Buffer dstBuffer,
+    std::span<const fastgltf::math::fmat4x4> data,
+    std::vector<vk_gltf_viewer::gltf::AssetSceneGpuBuffers::BufferUpdate> &updates
+) {
+    std::ranges::sort(ranges);
+
+    std::optional<std::pair<std::uint32_t, std::uint32_t>> current; // (start, end)
+    const auto append = [&]() {
+        updates.emplace_back(
+            dstBuffer,
+            sizeof(fastgltf::math::fmat4x4) * current->first,
+            as_bytes(data.subspan(current->first, current->second - current->first)));
+    };
+    for (auto [offset, count] : ranges) {
+        if (current && current->second >= offset) {
+            current->second = std::max(current->second, offset + count);
+        }
+        else {
+            if (current) append();
+            current.emplace(offset, offset + count);
+        }
+    }
+    if (current) append();
+}
+
+const fastgltf::math::fmat4x4 &vk_gltf_viewer::gltf::AssetSceneGpuBuffers::getMeshNodeWorldTransform(std::uint32_t nodeIndex, std::uint32_t instanceIndex) const noexcept {
+    return meshNodeWorldTransforms[instanceOffsets[nodeIndex] + instanceIndex];
+}
+
+void vk_gltf_viewer::gltf::AssetSceneGpuBuffers::updateMeshNodeTransformsFrom(std::uint32_t nodeIndex, const AssetSceneHierarchy &sceneHierarchy) {
+    for (std::size_t nodeIndex : sceneHierarchy.getSubtreeNodeIndices(nodeIndex)) {
+        const fastgltf::Node &node = pAsset->nodes[nodeIndex];
+        if (!node.meshIndex) {
+            continue;
+        }
+
+        const std::uint32_t offset = instanceOffsets[nodeIndex];
+        const std::uint32_t count = instanceCounts[nodeIndex];
+        const fastgltf::math::fmat4x4 &nodeWorldTransform = sceneHierarchy.nodeWorldTransforms[nodeIndex];
+        if (node.instancingAttributes.empty()) {
+            meshNodeWorldTransforms[offset] = nodeWorldTransform;
+        }
+        else {
+            for (std::uint32_t i = offset; i < offset + count; ++i) {
+                meshNodeWorldTransforms[i] = nodeWorldTransform * instanceLocalTransforms[i];
+            }
+        }
+
+        // Extend the last dirty range if the current range is adjacent to it.
+        if (!dirtyMeshNodeWorldTransformRanges.empty()) {
+            auto &[lastOffset, lastCount] = dirtyMeshNodeWorldTransformRanges.back();
+            if (lastOffset + lastCount == offset) {
+                lastCount += count;
+                continue;
+            }
+        }
+        dirtyMeshNodeWorldTransformRanges.emplace_back(offset, count);
+    }
+}
+
+std::vector<vk_gltf_viewer::gltf::AssetSceneGpuBuffers::BufferUpdate> vk_gltf_viewer::gltf::AssetSceneGpuBuffers::getPendingBufferUpdates() const {
+    std::vector<BufferUpdate> result;
+    if (!dirtyMeshNodeWorldTransformRanges.empty()) {
+        appendCoalescedBufferUpdates(dirtyMeshNodeWorldTransformRanges, meshNodeWorldTransformBuffer, meshNodeWorldTransforms, result);
+    }
+    if (gpuNodeTransformPropagation && !gpuNodeTransformPropagation->dirtyNodeIndices.empty()) {
+        appendCoalescedBufferUpdates(
+            gpuNodeTransformPropagation->dirtyNodeIndices
+                | std::views::transform([](std::uint32_t nodeIndex) { return std::pair { nodeIndex, 1U }; })
+                | std::ranges::to<std::vector>(),
+            gpuNodeTransformPropagation->nodeLocalTransformBuffer,
+            gpuNodeTransformPropagation->nodeLocalTransforms,
+            result);
+    }
+    return result;
+}
+
+void vk_gltf_viewer::gltf::AssetSceneGpuBuffers::clearPendingBufferUpdates() noexcept {
+    dirtyMeshNodeWorldTransformRanges.clear();
+    if (gpuNodeTransformPropagation) {
+        gpuNodeTransformPropagation->dirtyNodeIndices.clear();
+    }
+}
+
+void vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createGpuNodeTransformPropagation(const vulkan::Gpu &gpu, const AssetSceneHierarchy &sceneHierarchy) {
+    constexpr vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress;
+
+    std::vector nodeLocalTransforms { std::from_range, pAsset->nodes | std::views::transform([](const fastgltf::Node &node) {
+        return visit(fastgltf::visitor {
+            [](const fastgltf::TRS &trs) { return toMatrix(trs); },
+            [](const fastgltf::math::fmat4x4 &matrix) { return matrix; },
+        }, node.transform);
+    }) };
+
+    // Sort the scene nodes by their depth. As std::ranges::stable_sort is used, nodes in the same level are ordered
+    // by their pre-order position.
+    std::vector levelOrderedNodeIndices { std::from_range, sceneHierarchy.getNodeIndices() | std::views::transform([](std::size_t nodeIndex) {
+        return static_cast<std::uint32_t>(nodeIndex);
+    }) };
+    std::ranges::stable_sort(levelOrderedNodeIndices, {}, [&](std::uint32_t nodeIndex) {
+        return sceneHierarchy.getNodeDepth(nodeIndex);
+    });
+
+    std::vector<std::uint32_t> levelOffsets { 0U };
+    for (std::uint32_t i = 1; i < levelOrderedNodeIndices.size(); ++i) {
+        if (sceneHierarchy.getNodeDepth(levelOrderedNodeIndices[i - 1]) != sceneHierarchy.getNodeDepth(levelOrderedNodeIndices[i])) {
+            levelOffsets.push_back(i);
+        }
+    }
+    levelOffsets.push_back(static_cast<std::uint32_t>(levelOrderedNodeIndices.size()));
+
+    std::vector<std::uint32_t> instanceNodeIndices(instanceLocalTransforms.size());
+    for (std::size_t nodeIndex : sceneHierarchy.getNodeIndices()) {
+        std::fill_n(instanceNodeIndices.begin() + instanceOffsets[nodeIndex], instanceCounts[nodeIndex], static_cast<std::uint32_t>(nodeIndex));
+    }
+
+    gpuNodeTransformPropagation.emplace(
+        // Changed local transforms are copied by the frames.
+        createDeviceLocalStorageBuffer(gpu, nodeLocalTransforms, vk::BufferUsageFlagBits::eTransferDst),
+        vku::AllocatedBuffer { gpu.allocator, vk::BufferCreateInfo {
+            {},
+            sizeof(fastgltf::math::fmat4x4) * pAsset->nodes.size(),
+            usage | vk::BufferUsageFlagBits::eTransferSrc,
+        } },
+        vku::MappedBuffer { gpu.allocator, std::from_range, levelOrderedNodeIndices, usage },
+        vku::MappedBuffer {
+            gpu.allocator,
+            std::from_range, ranges::views::upto(pAsset->nodes.size()) | std::views::transform([&](std::size_t nodeIndex) {
+                return static_cast<std::uint32_t>(sceneHierarchy.getParentNodeIndex(nodeIndex).value_or(nodeIndex));
+            }),
+            usage,
+        },
+        vku::MappedBuffer { gpu.allocator, std::from_range, instanceNodeIndices, usage },
+        vku::MappedBuffer { gpu.allocator, std::from_range, instanceLocalTransforms, usage },
+        std::move(levelOffsets),
+        std::move(nodeLocalTransforms),
+        std::vector<std::uint32_t>{});
+}
+
+void vk_gltf_viewer::gltf::AssetSceneGpuBuffers::updateGpuNodeLocalTransform(std::size_t nodeIndex) {
+    gpuNodeTransformPropagation->nodeLocalTransforms[nodeIndex] = visit(fastgltf::visitor {
+        [](const fastgltf::TRS &trs) { return toMatrix(trs); },
+        [](const fastgltf::math::fmat4x4 &matrix) { return matrix; },
+    }, pAsset->nodes[nodeIndex].transform);
+    gpuNodeTransformPropagation->dirtyNodeIndices.push_back(static_cast<std::uint32_t>(nodeIndex));
+}
+
+std::vector<std::uint32_t> vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createInstanceCounts(const AssetSceneHierarchy &sceneHierarchy) const {
     std::vector<std::uint32_t> result(pAsset->nodes.size(), 0U);
-    algorithm::traverseScene(*pAsset, scene, [&](std::size_t nodeIndex) {
+    for (std::size_t nodeIndex : sceneHierarchy.getNodeIndices()) {
         result[nodeIndex] = [&]() -> std::uint32_t {
             const fastgltf::Node &node = pAsset->nodes[nodeIndex];
             if (!node.meshIndex) {
@@ -34,7 +230,7 @@ std::vector<std::uint32_t> vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createIns
                 return pAsset->accessors[node.instancingAttributes[0].accessorIndex].count;
             }
         }();
-    });
+    }
     return result;
 }
 
@@ -44,34 +240,71 @@ std::vector<std::uint32_t> vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createIns
     return result;
 }
 
-vku::AllocatedBuffer vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createNodeBuffer(const vulkan::Gpu &gpu) const {
-    const vk::DeviceAddress nodeTransformBufferStartAddress = gpu.device.getBufferAddress({ meshNodeWorldTransformBuffer });
+std::vector<std::uint32_t> vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createMeshInstanceCounts(const AssetSceneHierarchy &sceneHierarchy) const {
+    std::vector<std::uint32_t> result(pAsset->meshes.size(), 0U);
+    for (std::size_t nodeIndex : sceneHierarchy.getNodeIndices()) {
+        if (const auto &meshIndex = pAsset->nodes[nodeIndex].meshIndex) {
+            result[*meshIndex] += instanceCounts[nodeIndex];
+        }
+    }
+    return result;
+}
 
-    vku::AllocatedBuffer stagingBuffer = vku::MappedBuffer {
-        gpu.allocator,
-        std::from_range, instanceOffsets | std::views::transform([=](std::uint32_t offset) {
-            return nodeTransformBufferStartAddress + sizeof(fastgltf::math::fmat4x4) * offset;
-        }),
-        gpu.isUmaDevice ? vk::BufferUsageFlagBits::eStorageBuffer : vk::BufferUsageFlagBits::eTransferSrc,
-    }.unmap();
+std::vector<std::uint32_t> vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createMeshInstanceOffsets(const AssetSceneHierarchy &sceneHierarchy) const {
+    std::vector<std::uint32_t> result(pAsset->nodes.size(), 0U);
+    std::vector<std::uint32_t> visitedInstanceCounts(pAsset->meshes.size(), 0U);
+    for (std::size_t nodeIndex : sceneHierarchy.getNodeIndices()) {
+        if (const auto &meshIndex = pAsset->nodes[nodeIndex].meshIndex) {
+            result[nodeIndex] = std::exchange(visitedInstanceCounts[*meshIndex], visitedInstanceCounts[*meshIndex] + instanceCounts[nodeIndex]);
+        }
+    }
+    return result;
+}
 
-    if (gpu.isUmaDevice || vku::contains(gpu.allocator.getAllocationMemoryProperties(stagingBuffer.allocation), vk::MemoryPropertyFlagBits::eDeviceLocal)) {
-        return stagingBuffer;
+std::vector<std::uint32_t> vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createMeshDrawIndirectionOffsets() const {
+    // The last element is the total entry count.
+    std::vector<std::uint32_t> result(pAsset->meshes.size() + 1, 0U);
+    for (const auto &[meshIndex, mesh] : pAsset->meshes | ranges::views::enumerate) {
+        result[meshIndex + 1] = result[meshIndex] + static_cast<std::uint32_t>(mesh.primitives.size()) * meshInstanceCounts[meshIndex];
     }
+    return result;
+}
 
-    vku::AllocatedBuffer dstBuffer{ gpu.allocator, vk::BufferCreateInfo {
-        {},
-        stagingBuffer.size,
-        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
-    } };
+std::vector<fastgltf::math::fmat4x4> vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createMeshNodeWorldTransforms(const AssetSceneHierarchy &sceneHierarchy) const {
+    std::vector<fastgltf::math::fmat4x4> result(instanceLocalTransforms.size());
+    for (std::size_t nodeIndex : sceneHierarchy.getNodeIndices()) {
+        const fastgltf::Node &node = pAsset->nodes[nodeIndex];
+        if (!node.meshIndex) {
+            continue;
+        }
 
-    const vk::raii::CommandPool transferCommandPool { gpu.device, vk::CommandPoolCreateInfo { {}, gpu.queueFamilies.transfer } };
-    const vk::raii::Fence fence { gpu.device, vk::FenceCreateInfo{} };
-    vku::executeSingleCommand(*gpu.device, *transferCommandPool, gpu.queues.transfer, [&](vk::CommandBuffer cb) {
-        cb.copyBuffer(stagingBuffer, dstBuffer, vk::BufferCopy { 0, 0, dstBuffer.size });
-    }, *fence);
+        const std::uint32_t offset = instanceOffsets[nodeIndex];
+        if (node.instancingAttributes.empty()) {
+            result[offset] = sceneHierarchy.nodeWorldTransforms[nodeIndex];
+        }
+        else {
+            for (std::uint32_t i = offset; i < offset + instanceCounts[nodeIndex]; ++i) {
+                result[i] = sceneHierarchy.nodeWorldTransforms[nodeIndex] * instanceLocalTransforms[i];
+            }
+        }
+    }
+    return result;
+}
 
-    std::ignore = gpu.device.waitForFences(*fence, true, ~0ULL); // TODO: failure handling
+vku::AllocatedBuffer vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createMeshNodeWorldTransformBuffer(const vulkan::Gpu &gpu) const {
+    // Changed transforms are copied by the frames.
+    return createDeviceLocalStorageBuffer(gpu, meshNodeWorldTransforms, vk::BufferUsageFlagBits::eTransferDst);
+}
 
-    return dstBuffer;
-}
\ No newline at end of file
+vku::AllocatedBuffer vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createNodeBuffer(const vulkan::Gpu &gpu) const {
+    const vk::DeviceAddress nodeTransformBufferStartAddress = gpu.device.getBufferAddress({ meshNodeWorldTransformBuffer });
+    return createDeviceLocalStorageBuffer(gpu, instanceOffsets | std::views::transform([=](std::uint32_t offset) {
+        return nodeTransformBufferStartAddress + sizeof(fastgltf::math::fmat4x4) * offset;
+    }));
+}
+
+vku::AllocatedBuffer vk_gltf_viewer::gltf::AssetSceneGpuBuffers::createDrawIndirectionBuffer(const vulkan::Gpu &gpu) const {
+    // Vulkan requires non-zero buffer size, therefore a dummy element is used for the scene without mesh node.
+    static constexpr DrawIndirection dummy{};
+    return createDeviceLocalStorageBuffer(gpu, drawIndirections.empty() ? std::span<const DrawIndirection> { &dummy, 1 } : std::span<const DrawIndirection> { drawIndirections });
+}
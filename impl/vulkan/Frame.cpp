@@ -12,14 +12,20 @@ import :helpers.concepts;
 import :helpers.fastgltf;
 import :helpers.functional;
 import :helpers.ranges;
+import :math.extended_arithmetic;
 import :vulkan.ag.DepthPrepass;
 
-constexpr auto NO_INDEX = std::numeric_limits<std::uint16_t>::max();
+constexpr auto NO_INDEX = std::numeric_limits<std::uint32_t>::max();
 
-vk_gltf_viewer::vulkan::Frame::Frame(const Gpu &gpu, const SharedData &sharedData)
+vk_gltf_viewer::vulkan::Frame::Frame(const Gpu &gpu, const SharedData &sharedData, BS::thread_pool &commandRecordingThreadPool)
     : gpu { gpu }
     , hoveringNodeIndexBuffer { gpu.allocator, NO_INDEX, vk::BufferUsageFlagBits::eTransferDst, vku::allocation::hostRead }
-    , sharedData { sharedData } {
+    , cullingParameterBuffer { gpu.allocator, CullingComputer::Parameters{}, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress }
+    , occlusionCullingStatisticsBuffer { gpu.allocator, CullingComputer::Statistics{}, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress, vku::allocation::hostRead }
+    , cameraBuffer { gpu.allocator, pl::Primitive::Camera{}, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress }
+    , skyboxProjectionViewBuffer { gpu.allocator, glm::mat4{}, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress }
+    , sharedData { sharedData }
+    , commandRecordingThreadPool { commandRecordingThreadPool } {
     // Change initial attachment layouts.
     const vk::raii::Fence fence { gpu.device, vk::FenceCreateInfo{} };
     vku::executeSingleCommand(*gpu.device, *graphicsCommandPool, gpu.queues.graphicsPresent, [&](vk::CommandBuffer cb) {
@@ -28,13 +34,17 @@ vk_gltf_viewer::vulkan::Frame::Frame(const Gpu &gpu, const SharedData &sharedDat
     std::ignore = gpu.device.waitForFences(*fence, true, ~0ULL); // TODO: failure handling
 
     // Allocate descriptor sets.
-    std::tie(hoveringNodeJumpFloodSet, selectedNodeJumpFloodSet, hoveringNodeOutlineSet, selectedNodeOutlineSet, weightedBlendedCompositionSet)
+    std::tie(hoveringNodeJumpFloodSet, selectedNodeJumpFloodSet, hoveringNodeOutlineSet, selectedNodeOutlineSet, weightedBlendedCompositionSet, culledSceneDescriptorSet, previouslyVisibleSceneDescriptorSet, depthPyramidSet, cullingSet)
         = allocateDescriptorSets(*gpu.device, *descriptorPool, std::tie(
             sharedData.jumpFloodComputer.descriptorSetLayout,
             sharedData.jumpFloodComputer.descriptorSetLayout,
             sharedData.outlineRenderer.descriptorSetLayout,
             sharedData.outlineRenderer.descriptorSetLayout,
-            sharedData.weightedBlendedCompositionRenderer.descriptorSetLayout));
+            sharedData.weightedBlendedCompositionRenderer.descriptorSetLayout,
+            sharedData.sceneDescriptorSetLayout,
+            sharedData.sceneDescriptorSetLayout,
+            sharedData.depthPyramidComputer.descriptorSetLayout,
+            sharedData.cullingComputer.descriptorSetLayout));
 
     // Update descriptor set.
     gpu.device.updateDescriptorSets(
@@ -45,9 +55,12 @@ vk_gltf_viewer::vulkan::Frame::Frame(const Gpu &gpu, const SharedData &sharedDat
         {});
 
     // Allocate per-frame command buffers.
-    std::tie(jumpFloodCommandBuffer) = vku::allocateCommandBuffers<1>(*gpu.device, *computeCommandPool);
-    std::tie(scenePrepassCommandBuffer, sceneRenderingCommandBuffer, compositionCommandBuffer)
-        = vku::allocateCommandBuffers<3>(*gpu.device, *graphicsCommandPool);
+    std::tie(jumpFloodCommandBuffer, deformationCommandBuffer) = vku::allocateCommandBuffers<2>(*gpu.device, *computeCommandPool);
+    scenePrepassCommandBuffer = vku::allocateCommandBuffers<1>(*gpu.device, *scenePrepassCommandPool)[0];
+    std::tie(sceneRenderingCommandBuffer, compositionCommandBuffer) = vku::allocateCommandBuffers<2>(*gpu.device, *graphicsCommandPool);
+    const std::vector sceneSubpassCommandBuffers = (*gpu.device).allocateCommandBuffers({ *sceneSubpassCommandPool, vk::CommandBufferLevel::eSecondary, 2 });
+    sceneOpaqueSubpassCommandBuffer = sceneSubpassCommandBuffers[0];
+    sceneBlendSubpassCommandBuffer = sceneSubpassCommandBuffers[1];
 }
 
 auto vk_gltf_viewer::vulkan::Frame::update(const ExecutionTask &task) -> UpdateResult {
@@ -81,10 +94,30 @@ auto vk_gltf_viewer::vulkan::Frame::update(const ExecutionTask &task) -> UpdateR
 
     // Get node index under the cursor from hoveringNodeIndexBuffer.
     // If it is not NO_INDEX (i.e. node index is found), update hoveringNodeIndex.
-    if (auto value = std::exchange(hoveringNodeIndexBuffer.asValue<std::uint16_t>(), NO_INDEX); value != NO_INDEX) {
+    if (auto value = std::exchange(hoveringNodeIndexBuffer.asValue<std::uint32_t>(), NO_INDEX); value != NO_INDEX) {
         result.hoveringNodeIndex = value;
     }
 
+    // Get the occlusion test statistics of the previous execution, and reset them for the accumulation.
+    if (std::exchange(occlusionCullingStatisticsPending, false)) {
+        result.occlusionCullingStatistics = std::exchange(occlusionCullingStatisticsBuffer.asValue<CullingComputer::Statistics>(), CullingComputer::Statistics{});
+        gpu.allocator.flushAllocation(occlusionCullingStatisticsBuffer.allocation, 0, vk::WholeSize);
+    }
+
+    // Get the opaque subpass pipeline statistics of the previous execution. Results are written in the order of the
+    // statistic flag bits.
+    if (std::exchange(opaqueSubpassStatisticsPending, false)) {
+        const auto [queryResult, statistics] = opaqueSubpassStatisticsQueryPool->getResult<std::array<std::uint64_t, 2>>(0, 1, sizeof(std::array<std::uint64_t, 2>), vk::QueryResultFlagBits::e64);
+        if (queryResult == vk::Result::eSuccess) {
+            result.opaqueSubpassStatistics.emplace(statistics[0], statistics[1]);
+        }
+    }
+
+    // Get the node world transforms propagated by the previous execution.
+    if (std::exchange(nodeWorldTransformReadbackPending, false)) {
+        result.nodeWorldTransforms.emplace(nodeWorldTransformReadbackBuffer->asRange<const fastgltf::math::fmat4x4>());
+    }
+
     // If passthru extent is different from the current's, dependent images have to be recreated.
     if (!passthruResources || passthruResources->extent != task.passthruRect.extent) {
         // TODO: can this operation be non-blocking?
@@ -94,24 +127,210 @@ auto vk_gltf_viewer::vulkan::Frame::update(const ExecutionTask &task) -> UpdateR
         }, *fence);
         std::ignore = gpu.device.waitForFences(*fence, true, ~0ULL); // TODO: failure handling
 
+        // Unused mip level descriptors are filled with the last mip level image view.
+        const std::span depthPyramidMipImageViews = passthruResources->depthPyramidResources.mipImageViews;
+        const std::vector depthPyramidMipImageInfos
+            = std::views::iota(0U, DepthPyramidComputer::MAX_MIP_LEVELS)
+            | std::views::transform([&](std::uint32_t level) {
+                return vk::DescriptorImageInfo { {}, *depthPyramidMipImageViews[std::min<std::size_t>(level, depthPyramidMipImageViews.size() - 1)], vk::ImageLayout::eGeneral };
+            })
+            | std::ranges::to<std::vector>();
+
         gpu.device.updateDescriptorSets({
             hoveringNodeJumpFloodSet.getWriteOne<0>({ {}, *passthruResources->hoveringNodeOutlineJumpFloodResources.imageView, vk::ImageLayout::eGeneral }),
             selectedNodeJumpFloodSet.getWriteOne<0>({ {}, *passthruResources->selectedNodeOutlineJumpFloodResources.imageView, vk::ImageLayout::eGeneral }),
+            depthPyramidSet.getWriteOne<0>({ {}, *passthruResources->depthPrepassAttachmentGroup.depthStencilAttachment->view, vk::ImageLayout::eShaderReadOnlyOptimal }),
+            depthPyramidSet.getWrite<1>(depthPyramidMipImageInfos),
+            cullingSet.getWriteOne<0>({ {}, *passthruResources->depthPyramidResources.imageView, vk::ImageLayout::eGeneral }),
         }, {});
     }
 
+    // Cached scene subpass commands have the passthru rect as their viewport and scissor, and reference the
+    // framebuffer attachments through the render pass.
+    if (task.handleSwapchainResize || task.invalidateSceneRenderingCommands || passthruRect != task.passthruRect || useFullDepthPrepass != task.useFullDepthPrepass) {
+        sceneSubpassCommandsOutdated = true;
+    }
+
+    // Camera is read from the buffers by its device address, therefore the cached commands don't have to be
+    // re-recorded when only the camera is changed.
     projectionViewMatrix = task.camera.projection * task.camera.view;
-    viewPosition = inverse(task.camera.view)[3];
-    translationlessProjectionViewMatrix = task.camera.projection * glm::mat4 { glm::mat3 { task.camera.view } };
+    cameraBuffer.asValue<pl::Primitive::Camera>() = { projectionViewMatrix, inverse(task.camera.view)[3] };
+    gpu.allocator.flushAllocation(cameraBuffer.allocation, 0, vk::WholeSize);
+    skyboxProjectionViewBuffer.asValue<glm::mat4>() = task.camera.projection * glm::mat4 { glm::mat3 { task.camera.view } };
+    gpu.allocator.flushAllocation(skyboxProjectionViewBuffer.allocation, 0, vk::WholeSize);
+
     passthruRect = task.passthruRect;
     cursorPosFromPassthruRectTopLeft = task.cursorPosFromPassthruRectTopLeft;
+    useMultithreadedCommandRecording = task.useMultithreadedCommandRecording;
+    useFullDepthPrepass = task.useFullDepthPrepass;
 
     // If there is a glTF scene to be rendered, related resources have to be updated.
+    nodeTransformBufferCopies.clear();
+    nodeWorldTransformPropagationInfo.reset();
+    morphTargetPushConstants.clear();
+    skinningPushConstants.clear();
+    cullingPushConstants.clear();
+    previouslyVisibleCullingPushConstants.clear();
     if (task.gltf) {
-        indexBuffers
-            = task.gltf->assetGpuBuffers.indexBuffers
-            | ranges::views::value_transform([](vk::Buffer buffer) { return buffer; })
-            | std::ranges::to<std::unordered_map>();
+        // Transform buffers may be still read by the other frame in flight, therefore the host changes are staged into
+        // the per-frame buffer, and copied by the commands that are ordered after the previous reads in the same queue.
+        if (const std::vector updates = task.gltf->sceneGpuBuffers.getPendingBufferUpdates(); !updates.empty()) {
+            const vk::DeviceSize uploadSize = std::ranges::fold_left(
+                updates | std::views::transform([](const auto &update) { return update.data.size(); }),
+                vk::DeviceSize { 0 }, std::plus{});
+            if (!nodeTransformUploadBuffer || nodeTransformUploadBuffer->size < uploadSize) {
+                nodeTransformUploadBuffer.emplace(gpu.allocator, vk::BufferCreateInfo {
+                    {},
+                    uploadSize,
+                    vk::BufferUsageFlagBits::eTransferSrc,
+                });
+            }
+
+            vk::DeviceSize srcOffset = 0;
+            for (const auto &[dstBuffer, dstOffset, data] : updates) {
+                std::ranges::copy(data, static_cast<std::byte*>(nodeTransformUploadBuffer->data) + srcOffset);
+                nodeTransformBufferCopies.emplace_back(dstBuffer, vk::BufferCopy { srcOffset, dstOffset, data.size() });
+                srcOffset += data.size();
+            }
+            gpu.allocator.flushAllocation(nodeTransformUploadBuffer->allocation, 0, uploadSize);
+        }
+
+        if (task.gltf->shouldPropagateNodeWorldTransforms) {
+            const auto &propagation = *task.gltf->sceneGpuBuffers.gpuNodeTransformPropagation;
+
+            // Propagated world transforms are read back for the host side consumers (e.g. scene bounding volume hierarchy).
+            if (!nodeWorldTransformReadbackBuffer || nodeWorldTransformReadbackBuffer->size != propagation.nodeWorldTransformBuffer.size) {
+                nodeWorldTransformReadbackBuffer.emplace(gpu.allocator, vk::BufferCreateInfo {
+                    {},
+                    propagation.nodeWorldTransformBuffer.size,
+                    vk::BufferUsageFlagBits::eTransferDst,
+                }, vku::allocation::hostRead);
+            }
+            nodeWorldTransformBuffer = propagation.nodeWorldTransformBuffer;
+            nodeWorldTransformReadbackPending = true;
+
+            nodeWorldTransformPropagationInfo.emplace(
+                gpu.device.getBufferAddress({ propagation.nodeLocalTransformBuffer }),
+                gpu.device.getBufferAddress({ propagation.nodeWorldTransformBuffer }),
+                gpu.device.getBufferAddress({ propagation.levelOrderedNodeIndexBuffer }),
+                gpu.device.getBufferAddress({ propagation.parentNodeIndexBuffer }),
+                gpu.device.getBufferAddress({ propagation.instanceNodeIndexBuffer }),
+                gpu.device.getBufferAddress({ propagation.instanceLocalTransformBuffer }),
+                gpu.device.getBufferAddress({ task.gltf->sceneGpuBuffers.meshNodeWorldTransformBuffer }),
+                propagation.levelOffsets,
+                static_cast<std::uint32_t>(task.gltf->sceneGpuBuffers.meshNodeWorldTransformBuffer.size / sizeof(fastgltf::math::fmat4x4)));
+        }
+
+        if (task.gltf->shouldDeformMeshes) {
+            // Upload the host data into the (grown on demand) per-frame buffer, and return its device address.
+            const auto upload = [&](std::optional<vku::MappedBuffer> &buffer, std::span<const std::byte> data) -> vk::DeviceAddress {
+                if (!buffer || buffer->size < data.size()) {
+                    buffer.emplace(gpu.allocator, vk::BufferCreateInfo {
+                        {},
+                        data.size(),
+                        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                    });
+                }
+                std::ranges::copy(data, static_cast<std::byte*>(buffer->data));
+                gpu.allocator.flushAllocation(buffer->allocation, 0, data.size());
+                return gpu.device.getBufferAddress({ *buffer });
+            };
+
+            const auto getAttributeEncodingFlags = [](const auto &normalInfo, const auto &tangentInfo) -> std::uint32_t {
+                return (normalInfo.componentType == gltf::AssetPrimitiveInfo::ComponentType::Octahedral ? 0b01U : 0U)
+                     | (tangentInfo.componentType == gltf::AssetPrimitiveInfo::ComponentType::Octahedral ? 0b10U : 0U);
+            };
+
+            // Morph target blending reads the original attributes and writes the deformed attributes of each (node,
+            // primitive), with the node's weights.
+            if (const std::span weights = task.gltf->sceneMorphTargets.weights; !weights.empty()) {
+                const vk::DeviceAddress pWeightBuffer = upload(morphTargetWeightBuffer, as_bytes(weights));
+                for (const gltf::AssetSceneMorphTargets::MorphedNode &morphedNode : task.gltf->sceneMorphTargets.morphedNodes) {
+                    for (const gltf::AssetGpuBuffers::DeformedPrimitive &deformedPrimitive : task.gltf->assetGpuBuffers.getDeformedPrimitives(morphedNode.nodeIndex)) {
+                        const gltf::AssetPrimitiveInfo &primitiveInfo = task.gltf->assetGpuBuffers.primitiveInfos.at(deformedPrimitive.pPrimitive);
+                        if (!primitiveInfo.morphTargetInfo) continue;
+
+                        const gltf::AssetPrimitiveInfo::MorphTargetInfo &morphTargetInfo = *primitiveInfo.morphTargetInfo;
+                        const gltf::AssetPrimitiveInfo::DeformedAttributeBufferInfo &deformedInfo = deformedPrimitive.attributeBufferInfo;
+                        const auto normalInfo = primitiveInfo.normalInfo.value_or(gltf::AssetPrimitiveInfo::AttributeBufferInfo{});
+                        const auto tangentInfo = primitiveInfo.tangentInfo.value_or(gltf::AssetPrimitiveInfo::AttributeBufferInfo{});
+                        morphTargetPushConstants.push_back({
+                            .pDeltaBuffer = morphTargetInfo.pDeltaBuffer,
+                            .pVertexDeltaOffsetBuffer = morphTargetInfo.pVertexDeltaOffsetBuffer,
+                            .pSourcePositionBuffer = primitiveInfo.positionInfo.address,
+                            .pSourceNormalBuffer = normalInfo.address,
+                            .pSourceTangentBuffer = tangentInfo.address,
+                            .pMorphedPositionBuffer = deformedInfo.pPositionBuffer,
+                            .pMorphedNormalBuffer = deformedInfo.pNormalBuffer,
+                            .pMorphedTangentBuffer = deformedInfo.pTangentBuffer,
+                            .pWeights = pWeightBuffer + sizeof(float) * morphedNode.weightOffset,
+                            .vertexCount = deformedInfo.vertexCount,
+                            .positionByteStride = primitiveInfo.positionInfo.byteStride,
+                            .normalByteStride = normalInfo.byteStride,
+                            .tangentByteStride = tangentInfo.byteStride,
+                            .attributeEncodingFlags = getAttributeEncodingFlags(normalInfo, tangentInfo),
+                        });
+                    }
+                }
+            }
+
+            // Skinning reads the morphed attributes (in-place) if the primitive is also morphed, otherwise the original
+            // attributes. Each skinned node has its own outputs, therefore one dispatch is recorded per (node, primitive).
+            if (const std::span jointMatrices = task.gltf->sceneSkinning.jointMatrices; !jointMatrices.empty()) {
+                const vk::DeviceAddress pJointMatrixBuffer = upload(jointMatrixBuffer, as_bytes(jointMatrices));
+                for (const gltf::AssetSceneSkinning::SkinnedNode &skinnedNode : task.gltf->sceneSkinning.skinnedNodes) {
+                    for (const gltf::AssetGpuBuffers::DeformedPrimitive &deformedPrimitive : task.gltf->assetGpuBuffers.getDeformedPrimitives(skinnedNode.nodeIndex)) {
+                        const gltf::AssetPrimitiveInfo &primitiveInfo = task.gltf->assetGpuBuffers.primitiveInfos.at(deformedPrimitive.pPrimitive);
+                        if (!primitiveInfo.skinningInfo) continue;
+
+                        const gltf::AssetPrimitiveInfo::SkinningInfo &skinningInfo = *primitiveInfo.skinningInfo;
+                        const gltf::AssetPrimitiveInfo::DeformedAttributeBufferInfo &deformedInfo = deformedPrimitive.attributeBufferInfo;
+                        SkinningComputer::PushConstant &pushConstant = skinningPushConstants.emplace_back(SkinningComputer::PushConstant {
+                            .pInfluenceBuffer = skinningInfo.pInfluenceBuffer,
+                            .pSkinnedPositionBuffer = deformedInfo.pPositionBuffer,
+                            .pSkinnedNormalBuffer = deformedInfo.pNormalBuffer,
+                            .pSkinnedTangentBuffer = deformedInfo.pTangentBuffer,
+                            .pJointMatrices = pJointMatrixBuffer + sizeof(fastgltf::math::fmat4x4) * skinnedNode.jointMatrixOffset,
+                            .vertexCount = deformedInfo.vertexCount,
+                            .influenceSetCount = skinningInfo.influenceSetCount,
+                        });
+                        if (primitiveInfo.morphTargetInfo) {
+                            pushConstant.pSourcePositionBuffer = deformedInfo.pPositionBuffer;
+                            pushConstant.pSourceNormalBuffer = deformedInfo.pNormalBuffer;
+                            pushConstant.pSourceTangentBuffer = deformedInfo.pTangentBuffer;
+                            pushConstant.positionByteStride = pushConstant.normalByteStride = pushConstant.tangentByteStride = sizeof(glm::vec4);
+                            pushConstant.attributeEncodingFlags = 0;
+                        }
+                        else {
+                            const auto normalInfo = primitiveInfo.normalInfo.value_or(gltf::AssetPrimitiveInfo::AttributeBufferInfo{});
+                            const auto tangentInfo = primitiveInfo.tangentInfo.value_or(gltf::AssetPrimitiveInfo::AttributeBufferInfo{});
+                            pushConstant.pSourcePositionBuffer = primitiveInfo.positionInfo.address;
+                            pushConstant.pSourceNormalBuffer = normalInfo.address;
+                            pushConstant.pSourceTangentBuffer = tangentInfo.address;
+                            pushConstant.positionByteStride = primitiveInfo.positionInfo.byteStride;
+                            pushConstant.normalByteStride = normalInfo.byteStride;
+                            pushConstant.tangentByteStride = tangentInfo.byteStride;
+                            pushConstant.attributeEncodingFlags = getAttributeEncodingFlags(normalInfo, tangentInfo);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Index buffers are changed only when the asset is reloaded, therefore the map is rebuilt only if it differs from
+        // the asset's.
+        if (const auto &assetIndexBuffers = task.gltf->assetGpuBuffers.indexBuffers;
+            indexBuffers.size() != assetIndexBuffers.size() ||
+            !std::ranges::all_of(assetIndexBuffers, [&](const auto &keyValue) {
+                const auto it = indexBuffers.find(keyValue.first);
+                return it != indexBuffers.end() && it->second == static_cast<vk::Buffer>(keyValue.second);
+            })) {
+            indexBuffers
+                = assetIndexBuffers
+                | ranges::views::value_transform([](vk::Buffer buffer) { return buffer; })
+                | std::ranges::to<std::unordered_map>();
+            sceneSubpassCommandsOutdated = true;
+        }
 
         const auto criteriaGetter = [&](const gltf::AssetPrimitiveInfo &primitiveInfo) {
             CommandSeparationCriteria result {
@@ -153,50 +372,128 @@ auto vk_gltf_viewer::vulkan::Frame::update(const ExecutionTask &task) -> UpdateR
         if (!task.gltf->renderingNodes.indices.empty()) {
             if (!renderingNodes ||
                 task.gltf->renderingNodes.shouldRegenerateDrawCommands ||
-                (renderingNodes && renderingNodes->indices != task.gltf->renderingNodes.indices)) {
+                renderingNodes->sceneVersion != task.gltf->renderingNodes.sceneVersion) {
+                // Slots are created once per scene, and their visibilities are updated in place below.
+                const auto primitiveInfoGetter = [&](const fastgltf::Primitive &primitive) -> decltype(auto) { return task.gltf->assetGpuBuffers.primitiveInfos.at(&primitive); };
                 renderingNodes.emplace(
-                    task.gltf->renderingNodes.indices,
-                    task.gltf->sceneGpuBuffers.createIndirectDrawCommandBuffers<decltype(criteriaGetter), CommandSeparationCriteriaComparator>(gpu.allocator, criteriaGetter, task.gltf->renderingNodes.indices, [&](const fastgltf::Primitive &primitive) -> decltype(auto) { return task.gltf->assetGpuBuffers.primitiveInfos.at(&primitive); }));
+                    task.gltf->renderingNodes.sceneVersion,
+                    0,
+                    task.gltf->sceneGpuBuffers.createPersistentIndirectDrawCommandBuffers<decltype(criteriaGetter), CommandSeparationCriteriaComparator>(gpu.allocator, criteriaGetter, primitiveInfoGetter),
+                    task.gltf->sceneGpuBuffers.createPersistentIndirectDrawCommandBuffers<decltype(criteriaGetter), CommandSeparationCriteriaComparator>(gpu.allocator, criteriaGetter, primitiveInfoGetter),
+                    vku::AllocatedBuffer { gpu.allocator, vk::BufferCreateInfo {
+                        {},
+                        task.gltf->sceneGpuBuffers.drawIndirectionBuffer.size,
+                        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                    } },
+                    task.gltf->sceneGpuBuffers.createPersistentIndirectDrawCommandBuffers<decltype(criteriaGetter), CommandSeparationCriteriaComparator>(gpu.allocator, criteriaGetter, primitiveInfoGetter),
+                    vku::AllocatedBuffer { gpu.allocator, vk::BufferCreateInfo {
+                        {},
+                        task.gltf->sceneGpuBuffers.drawIndirectionBuffer.size,
+                        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                    } },
+                    vku::MappedBuffer {
+                        gpu.allocator,
+                        std::from_range,
+                        std::vector<std::uint32_t>(
+                            math::divCeil<vk::DeviceSize>(task.gltf->sceneGpuBuffers.drawIndirectionBuffer.size / sizeof(gltf::AssetSceneGpuBuffers::DrawIndirection), 32),
+                            ~0U),
+                        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                    },
+                    false,
+                    false);
+
+                gpu.device.updateDescriptorSets({
+                    culledSceneDescriptorSet.getWriteOne<0>({ task.gltf->sceneGpuBuffers.nodeBuffer, 0, vk::WholeSize }),
+                    culledSceneDescriptorSet.getWriteOne<1>({ renderingNodes->culledDrawIndirectionBuffer, 0, vk::WholeSize }),
+                    previouslyVisibleSceneDescriptorSet.getWriteOne<0>({ task.gltf->sceneGpuBuffers.nodeBuffer, 0, vk::WholeSize }),
+                    previouslyVisibleSceneDescriptorSet.getWriteOne<1>({ renderingNodes->previouslyVisibleDrawIndirectionBuffer, 0, vk::WholeSize }),
+                }, {});
+                sceneSubpassCommandsOutdated = true;
             }
 
-            if (task.frustum) {
+            if (renderingNodes->version != task.gltf->renderingNodes.version) {
                 for (auto &buffer : renderingNodes->indirectDrawCommandBuffers | std::views::values) {
-                    visit([&]<bool Indexed>(buffer::IndirectDrawCommands<Indexed> &indirectDrawCommands) -> void {
-                        indirectDrawCommands.partition([&](const buffer::IndirectDrawCommands<Indexed>::command_t &command) {
-                            if (command.instanceCount > 1) {
-                                // Do not perform frustum culling for instanced mesh.
-                                return true;
-                            }
-
-                            const std::uint16_t nodeIndex = command.firstInstance >> 16U;
-                            const std::uint16_t primitiveIndex = command.firstInstance & 0xFFFFU;
-                            const fastgltf::Primitive &primitive = task.gltf->assetGpuBuffers.getPrimitiveByOrder(primitiveIndex);
+                    visit([&]<bool Indexed>(buffer::IndirectDrawCommands<Indexed> &indirectDrawCommands) {
+                        task.gltf->sceneGpuBuffers.updateIndirectDrawCommandVisibilities(indirectDrawCommands, [&](std::uint32_t nodeIndex) {
+                            return task.gltf->renderingNodes.indices.contains(nodeIndex);
+                        });
+                    }, buffer);
+                }
+                renderingNodes->version = task.gltf->renderingNodes.version;
 
-                            const gltf::AssetPrimitiveInfo &primitiveInfo = task.gltf->assetGpuBuffers.primitiveInfos.at(&primitive);
+                // Draw count is recorded in the command buffer if drawIndirectCount is not supported.
+                sceneSubpassCommandsOutdated = true;
+            }
 
-                            const glm::mat4 nodeWorldTransform = glm::make_mat4(task.gltf->sceneHierarchy.nodeWorldTransforms[nodeIndex].data());
-                            const glm::vec3 transformedMin { nodeWorldTransform * glm::vec4 { primitiveInfo.min, 1.f } };
-                            const glm::vec3 transformedMax { nodeWorldTransform * glm::vec4 { primitiveInfo.max, 1.f } };
+            // Drawn draw command buffers and scene descriptor set are determined by whether frustum culling is enabled.
+            if (renderingNodes->frustumCulled != task.frustum.has_value()) {
+                sceneSubpassCommandsOutdated = true;
+            }
+            renderingNodes->frustumCulled = task.frustum.has_value();
+            renderingNodes->occlusionCulled = task.frustum && task.useOcclusionCulling;
+            if (task.frustum) {
+                auto &parameters = cullingParameterBuffer.asValue<CullingComputer::Parameters>();
+                std::ranges::transform(task.frustum->planes, parameters.frustumPlanes.begin(), [](const math::Plane &plane) {
+                    return glm::vec4 { plane.normal, plane.distance };
+                });
+                parameters.projectionView = projectionViewMatrix;
+                gpu.allocator.flushAllocation(cullingParameterBuffer.allocation, 0, vk::WholeSize);
+
+                // Every instance of the visible commands is culled in the device, including EXT_mesh_gpu_instancing
+                // instances. If drawIndirectCount is not supported, commands are not compacted and the culled ones are
+                // drawn with zero instance count.
+                const auto addPushConstants = [&](
+                    CriteriaSeparatedIndirectDrawCommands &dstIndirectDrawCommandBuffers,
+                    vk::Buffer dstDrawIndirectionBuffer,
+                    std::uint32_t flags,
+                    std::vector<CullingComputer::PushConstant> &pushConstants
+                ) {
+                    if (gpu.supportDrawIndirectCount) {
+                        flags |= CullingComputer::Compact;
+                    }
 
-                            const glm::vec3 halfDisplacement = (transformedMax - transformedMin) / 2.f;
-                            const glm::vec3 center = transformedMin + halfDisplacement;
-                            const float radius = length(halfDisplacement);
+                    for (auto &[criteria, buffer] : renderingNodes->indirectDrawCommandBuffers) {
+                        visit([&]<bool Indexed>(buffer::IndirectDrawCommands<Indexed> &indirectDrawCommands) {
+                            auto &dstIndirectDrawCommands = get<buffer::IndirectDrawCommands<Indexed>>(dstIndirectDrawCommandBuffers.at(criteria));
+                            const std::uint32_t commandCount = indirectDrawCommands.drawCount();
+                            dstIndirectDrawCommands.setDrawCount(gpu.supportDrawIndirectCount ? 0U : commandCount);
+                            if (commandCount == 0) {
+                                return;
+                            }
 
-                            return task.frustum->isOverlapApprox(center, radius);
-                        });
-                    }, buffer);
+                            pushConstants.push_back({
+                                .pSrcCommands = gpu.device.getBufferAddress({ indirectDrawCommands }) + sizeof(std::uint32_t),
+                                .pDstCommandBuffer = gpu.device.getBufferAddress({ dstIndirectDrawCommands }),
+                                .pDrawIndirections = gpu.device.getBufferAddress({ task.gltf->sceneGpuBuffers.drawIndirectionBuffer }),
+                                .pCulledDrawIndirections = gpu.device.getBufferAddress({ dstDrawIndirectionBuffer }),
+                                .pNodes = gpu.device.getBufferAddress({ task.gltf->sceneGpuBuffers.nodeBuffer }),
+                                .pPrimitiveBoundingSpheres = gpu.device.getBufferAddress({ task.gltf->assetGpuBuffers.primitiveBoundingSphereBuffer }),
+                                .pParameters = gpu.device.getBufferAddress({ cullingParameterBuffer }),
+                                .pInstanceVisibilities = gpu.device.getBufferAddress({ renderingNodes->instanceVisibilityBuffer }),
+                                .pStatistics = gpu.device.getBufferAddress({ occlusionCullingStatisticsBuffer }),
+                                .commandCount = commandCount,
+                                .commandDwordCount = sizeof(typename buffer::IndirectDrawCommands<Indexed>::command_t) / sizeof(std::uint32_t),
+                                .flags = flags,
+                            });
+                        }, buffer);
+                    }
+                };
+
+                if (renderingNodes->occlusionCulled) {
+                    // Phase 1: instances visible in the last occlusion test, which are rendered into the depth pyramid.
+                    addPushConstants(renderingNodes->previouslyVisibleIndirectDrawCommandBuffers, renderingNodes->previouslyVisibleDrawIndirectionBuffer, CullingComputer::PreviouslyVisibleOnly, previouslyVisibleCullingPushConstants);
+                    // Phase 2: all instances are tested against the depth pyramid.
+                    addPushConstants(renderingNodes->culledIndirectDrawCommandBuffers, renderingNodes->culledDrawIndirectionBuffer, CullingComputer::OcclusionTest, cullingPushConstants);
+                    occlusionCullingStatisticsPending = true;
                 }
-            }
-            else {
-                for (auto &buffer : renderingNodes->indirectDrawCommandBuffers | std::views::values) {
-                    visit([&]<bool Indexed>(buffer::IndirectDrawCommands<Indexed> &indirectDrawCommands) {
-                        indirectDrawCommands.resetDrawCount();
-                    }, buffer);
+                else {
+                    addPushConstants(renderingNodes->culledIndirectDrawCommandBuffers, renderingNodes->culledDrawIndirectionBuffer, 0U, cullingPushConstants);
                 }
             }
         }
-        else {
+        else if (renderingNodes) {
             renderingNodes.reset();
+            sceneSubpassCommandsOutdated = true;
         }
 
         if (task.gltf->selectedNodes) {
@@ -243,41 +540,99 @@ auto vk_gltf_viewer::vulkan::Frame::update(const ExecutionTask &task) -> UpdateR
         else {
             hoveringNode.reset();
         }
+
+        if (task.cursorPosFromPassthruRectTopLeft && !task.gltf->mousePickingNodeIndices.empty()) {
+            if (!mousePickingNodes ||
+                task.gltf->renderingNodes.shouldRegenerateDrawCommands ||
+                mousePickingNodes->sceneVersion != task.gltf->renderingNodes.sceneVersion) {
+                // Like renderingNodes, slots are created once per scene, and their visibilities are updated in place below.
+                mousePickingNodes.emplace(
+                    task.gltf->renderingNodes.sceneVersion,
+                    std::vector<std::uint32_t>{},
+                    task.gltf->sceneGpuBuffers.createPersistentIndirectDrawCommandBuffers<decltype(criteriaGetter), CommandSeparationCriteriaComparator>(gpu.allocator, criteriaGetter, [&](const fastgltf::Primitive &primitive) -> decltype(auto) { return task.gltf->assetGpuBuffers.primitiveInfos.at(&primitive); }));
+            }
+
+            if (!std::ranges::equal(mousePickingNodes->indices, task.gltf->mousePickingNodeIndices)) {
+                mousePickingNodes->indices.assign_range(task.gltf->mousePickingNodeIndices);
+                for (auto &buffer : mousePickingNodes->indirectDrawCommandBuffers | std::views::values) {
+                    visit([&]<bool Indexed>(buffer::IndirectDrawCommands<Indexed> &indirectDrawCommands) {
+                        task.gltf->sceneGpuBuffers.updateIndirectDrawCommandVisibilities(indirectDrawCommands, [&](std::uint32_t nodeIndex) {
+                            return std::ranges::binary_search(mousePickingNodes->indices, nodeIndex);
+                        });
+                    }, buffer);
+                }
+            }
+        }
+        else if (mousePickingNodes) {
+            // Slots are kept for the next hovering, and the pass is skipped.
+            mousePickingNodes->indices.clear();
+        }
     }
 
+    // Solid background is the clear value of the render pass, therefore only the change between the solid color and the
+    // skybox affects the cached commands.
     if (task.solidBackground) {
+        if (!holds_alternative<glm::vec3>(background)) {
+            sceneSubpassCommandsOutdated = true;
+        }
         background.emplace<glm::vec3>(*task.solidBackground);
     }
     else {
+        if (!holds_alternative<vku::DescriptorSet<dsl::Skybox>>(background)) {
+            sceneSubpassCommandsOutdated = true;
+        }
         background.emplace<vku::DescriptorSet<dsl::Skybox>>(sharedData.skyboxDescriptorSet);
     }
 
     return result;
 }
 
-void vk_gltf_viewer::vulkan::Frame::recordCommandsAndSubmit(std::uint32_t swapchainImageIndex) const {
+auto vk_gltf_viewer::vulkan::Frame::recordCommandsAndSubmit(std::uint32_t swapchainImageIndex) -> std::chrono::nanoseconds {
+    const auto recordingStartTime = std::chrono::steady_clock::now();
+
     // Record commands.
     graphicsCommandPool.reset();
+    scenePrepassCommandPool.reset();
     computeCommandPool.reset();
 
-    // Depth prepass and jump flood seed image calculation pass.
-    {
-        scenePrepassCommandBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
-        recordScenePrepassCommands(scenePrepassCommandBuffer);
-        scenePrepassCommandBuffer.end();
+    // Command buffers allocated from the different command pools can be recorded concurrently. Deformation and jump
+    // flood commands (computeCommandPool) and scene prepass commands (scenePrepassCommandPool) are recorded by the
+    // worker threads, and scene rendering and composition commands (graphicsCommandPool) are recorded by the calling
+    // thread. If multithreaded recording is disabled, the recordings are deferred until their results are requested.
+    const auto launchRecording = [this]<std::invocable F>(F &&f) {
+        return useMultithreadedCommandRecording
+            ? commandRecordingThreadPool.submit_task(std::forward<F>(f))
+            : std::async(std::launch::deferred, std::forward<F>(f));
+    };
 
-        gpu.queues.graphicsPresent.submit(vk::SubmitInfo {
-            {},
-            {},
-            scenePrepassCommandBuffer,
-            *scenePrepassFinishSema,
-        });
-    }
+    const bool deformMeshes = !morphTargetPushConstants.empty() || !skinningPushConstants.empty();
 
-    // Jump flood calculation pass.
-    // TODO: If there are multiple compute queues, distribute the tasks to avoid the compute pipeline stalling.
-    std::optional<bool> hoveringNodeJumpFloodForward{}, selectedNodeJumpFloodForward{};
-    {
+    // Compute vertex deformation pass (morph target blending -> skinning) and jump flood calculation pass.
+    // Return the jump flood directions of the hovering node and selected nodes, which are used by the composition pass.
+    std::future computeRecording = launchRecording([this, deformMeshes]() -> std::pair<std::optional<bool>, std::optional<bool>> {
+        if (deformMeshes) {
+            deformationCommandBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+            if (!morphTargetPushConstants.empty()) {
+                sharedData.morphTargetComputer.compute(deformationCommandBuffer, morphTargetPushConstants);
+            }
+            if (!skinningPushConstants.empty()) {
+                if (!morphTargetPushConstants.empty()) {
+                    // Skinning of the morphed primitives reads the morphed attributes.
+                    deformationCommandBuffer.pipelineBarrier(
+                        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+                        {},
+                        vk::MemoryBarrier {
+                            vk::AccessFlagBits::eShaderWrite,
+                            vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+                        },
+                        {}, {});
+                }
+                sharedData.skinningComputer.compute(deformationCommandBuffer, skinningPushConstants);
+            }
+            deformationCommandBuffer.end();
+        }
+
+        std::optional<bool> hoveringNodeJumpFloodForward{}, selectedNodeJumpFloodForward{};
         jumpFloodCommandBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
         if (hoveringNode) {
             hoveringNodeJumpFloodForward = recordJumpFloodComputeCommands(
@@ -313,18 +668,70 @@ void vk_gltf_viewer::vulkan::Frame::recordCommandsAndSubmit(std::uint32_t swapch
         }
         jumpFloodCommandBuffer.end();
 
-        gpu.queues.compute.submit(vk::SubmitInfo {
-            *scenePrepassFinishSema,
-            vku::unsafeProxy(vk::Flags { vk::PipelineStageFlagBits::eComputeShader }),
-            jumpFloodCommandBuffer,
-            *jumpFloodFinishSema,
-        });
-    }
+        return { hoveringNodeJumpFloodForward, selectedNodeJumpFloodForward };
+    });
+
+    // Depth prepass and jump flood seed image calculation pass.
+    std::future scenePrepassRecording = launchRecording([this]() {
+        scenePrepassCommandBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+        if (!nodeTransformBufferCopies.empty()) {
+            // Transform buffers may be still read by the previously submitted commands in the same queue (write-after-read).
+            scenePrepassCommandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eComputeShader,
+                vk::PipelineStageFlagBits::eTransfer,
+                {}, {}, {}, {});
+
+            // Copies are grouped by their destination buffer.
+            for (auto &&copies : nodeTransformBufferCopies | std::views::chunk_by([](const auto &lhs, const auto &rhs) { return lhs.first == rhs.first; })) {
+                scenePrepassCommandBuffer.copyBuffer(
+                    *nodeTransformUploadBuffer, copies.front().first,
+                    copies | std::views::values | std::ranges::to<std::vector>());
+            }
+
+            // Copied transforms are read by the node world transform propagation, vertex shaders and frustum culling.
+            scenePrepassCommandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eComputeShader,
+                {}, vk::MemoryBarrier { vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead }, {}, {});
+        }
+        if (nodeWorldTransformPropagationInfo) {
+            // Mesh node world transforms must be calculated before any vertex shader reads them.
+            sharedData.nodeWorldTransformComputer.compute(scenePrepassCommandBuffer, *nodeWorldTransformPropagationInfo);
+
+            scenePrepassCommandBuffer.copyBuffer(
+                nodeWorldTransformBuffer, *nodeWorldTransformReadbackBuffer,
+                vk::BufferCopy { 0, 0, nodeWorldTransformReadbackBuffer->size });
+
+            // Node world transforms have to be available to the host.
+            scenePrepassCommandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
+                {}, {},
+                vk::BufferMemoryBarrier {
+                    vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead,
+                    vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+                    *nodeWorldTransformReadbackBuffer, 0, vk::WholeSize,
+                },
+                {});
+        }
+        recordScenePrepassCommands(scenePrepassCommandBuffer);
+        scenePrepassCommandBuffer.end();
+    });
 
-    // glTF scene rendering pass.
+    // glTF scene rendering pass. Opaque and blend subpasses are executed from the cached secondary command buffers,
+    // which are re-recorded only if any state they depend on is changed.
     {
+        if (sceneSubpassCommandsOutdated) {
+            sceneHasBlendMesh = recordSceneSubpassCommands();
+            sceneSubpassCommandsOutdated = false;
+        }
+
         sceneRenderingCommandBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
 
+        if (opaqueSubpassStatisticsQueryPool) {
+            // Query is begun and ended by sceneOpaqueSubpassCommandBuffer, but it must be reset outside the render pass.
+            sceneRenderingCommandBuffer.resetQueryPool(**opaqueSubpassStatisticsQueryPool, 0, 1);
+        }
+
         vk::ClearColorValue backgroundColor { 0.f, 0.f, 0.f, 0.f };
         if (auto *clearColor = get_if<glm::vec3>(&background)) {
             backgroundColor.setFloat32({ clearColor->x, clearColor->y, clearColor->z, 1.f });
@@ -342,34 +749,24 @@ void vk_gltf_viewer::vulkan::Frame::recordCommandsAndSubmit(std::uint32_t swapch
                 vk::ClearColorValue { 1.f, 0.f, 0.f, 0.f },
                 vk::ClearColorValue{},
             }),
-        }, vk::SubpassContents::eInline);
-
-        const vk::Viewport passthruViewport {
-            // Use negative viewport.
-            static_cast<float>(passthruRect.offset.x), static_cast<float>(passthruRect.offset.y + passthruRect.extent.height),
-            static_cast<float>(passthruRect.extent.width), -static_cast<float>(passthruRect.extent.height),
-            0.f, 1.f,
-        };
-        sceneRenderingCommandBuffer.setViewport(0, passthruViewport);
-        sceneRenderingCommandBuffer.setScissor(0, passthruRect);
-
-        if (renderingNodes) {
-            recordSceneOpaqueMeshDrawCommands(sceneRenderingCommandBuffer);
-        }
-        if (holds_alternative<vku::DescriptorSet<dsl::Skybox>>(background)) {
-            recordSkyboxDrawCommands(sceneRenderingCommandBuffer);
-        }
+        }, vk::SubpassContents::eSecondaryCommandBuffers);
+        sceneRenderingCommandBuffer.executeCommands(sceneOpaqueSubpassCommandBuffer);
 
         // Render meshes whose AlphaMode=Blend.
-        sceneRenderingCommandBuffer.nextSubpass(vk::SubpassContents::eInline);
-        bool hasBlendMesh = false;
-        if (renderingNodes) {
-            hasBlendMesh = recordSceneBlendMeshDrawCommands(sceneRenderingCommandBuffer);
-        }
+        sceneRenderingCommandBuffer.nextSubpass(vk::SubpassContents::eSecondaryCommandBuffers);
+        sceneRenderingCommandBuffer.executeCommands(sceneBlendSubpassCommandBuffer);
 
         sceneRenderingCommandBuffer.nextSubpass(vk::SubpassContents::eInline);
 
-        if (hasBlendMesh) {
+        if (sceneHasBlendMesh) {
+            // Dynamic states set by the secondary command buffers are not inherited.
+            sceneRenderingCommandBuffer.setViewport(0, vk::Viewport {
+                static_cast<float>(passthruRect.offset.x), static_cast<float>(passthruRect.offset.y + passthruRect.extent.height),
+                static_cast<float>(passthruRect.extent.width), -static_cast<float>(passthruRect.extent.height),
+                0.f, 1.f,
+            });
+            sceneRenderingCommandBuffer.setScissor(0, passthruRect);
+
             // Weighted blended composition.
             sceneRenderingCommandBuffer.bindPipeline(
                 vk::PipelineBindPoint::eGraphics,
@@ -386,7 +783,9 @@ void vk_gltf_viewer::vulkan::Frame::recordCommandsAndSubmit(std::uint32_t swapch
         sceneRenderingCommandBuffer.end();
     }
 
-    // Post-composition pass.
+    // Post-composition pass. Outline descriptor sets are updated by the jump flood recording, therefore it must be
+    // finished before they are bound.
+    const auto [hoveringNodeJumpFloodForward, selectedNodeJumpFloodForward] = computeRecording.get();
     {
         compositionCommandBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
 
@@ -420,12 +819,64 @@ void vk_gltf_viewer::vulkan::Frame::recordCommandsAndSubmit(std::uint32_t swapch
         compositionCommandBuffer.end();
     }
 
+    scenePrepassRecording.get();
+    const std::chrono::nanoseconds recordingDuration = std::chrono::steady_clock::now() - recordingStartTime;
+
+    // Submit the recorded commands, in the order of the semaphore signal and wait.
+
+    // Deformed vertices are read by the vertex shaders of both scene prepass and scene rendering, and binary semaphore
+    // wait only orders its own batch, therefore each of them waits for its own semaphore.
+    boost::container::static_vector<vk::Semaphore, 1> scenePrepassWaitSemas;
+    boost::container::static_vector<vk::PipelineStageFlags, 1> scenePrepassWaitStages;
+    boost::container::static_vector<vk::Semaphore, 2> sceneRenderingWaitSemas { *swapchainImageAcquireSema };
+    boost::container::static_vector<vk::PipelineStageFlags, 2> sceneRenderingWaitStages { vk::PipelineStageFlagBits::eColorAttachmentOutput };
+
+    if (deformMeshes) {
+        // Deformed vertex attribute buffers may be still read by the scene rendering of the previously submitted frame
+        // (write-after-read).
+        const vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo {
+            vku::unsafeProxy(sharedData.sceneRenderingTimelineValue),
+            {},
+        };
+        gpu.queues.compute.submit(vk::SubmitInfo {
+            *sharedData.sceneRenderingTimelineSema,
+            vku::unsafeProxy(vk::Flags { vk::PipelineStageFlagBits::eComputeShader }),
+            deformationCommandBuffer,
+            vku::unsafeProxy({ *scenePrepassDeformationFinishSema, *sceneRenderingDeformationFinishSema }),
+            &timelineSubmitInfo,
+        });
+
+        scenePrepassWaitSemas.push_back(*scenePrepassDeformationFinishSema);
+        scenePrepassWaitStages.push_back(vk::PipelineStageFlagBits::eVertexShader);
+        sceneRenderingWaitSemas.push_back(*sceneRenderingDeformationFinishSema);
+        sceneRenderingWaitStages.push_back(vk::PipelineStageFlagBits::eVertexShader);
+    }
+
+    gpu.queues.graphicsPresent.submit(vk::SubmitInfo {
+        scenePrepassWaitSemas,
+        scenePrepassWaitStages,
+        scenePrepassCommandBuffer,
+        *scenePrepassFinishSema,
+    });
+
+    // TODO: If there are multiple compute queues, distribute the tasks to avoid the compute pipeline stalling.
+    gpu.queues.compute.submit(vk::SubmitInfo {
+        *scenePrepassFinishSema,
+        vku::unsafeProxy(vk::Flags { vk::PipelineStageFlagBits::eComputeShader }),
+        jumpFloodCommandBuffer,
+        *jumpFloodFinishSema,
+    });
+
+    // Binary semaphore ignores the signal value.
+    const std::array sceneRenderingSignalValues { std::uint64_t { 0 }, sharedData.sceneRenderingTimelineValue + 1 };
+    const vk::TimelineSemaphoreSubmitInfo sceneRenderingTimelineSubmitInfo { {}, sceneRenderingSignalValues };
     gpu.queues.graphicsPresent.submit({
         vk::SubmitInfo {
-            *swapchainImageAcquireSema,
-            vku::unsafeProxy(vk::Flags { vk::PipelineStageFlagBits::eColorAttachmentOutput }),
+            sceneRenderingWaitSemas,
+            sceneRenderingWaitStages,
             sceneRenderingCommandBuffer,
-            *sceneRenderingFinishSema,
+            vku::unsafeProxy({ *sceneRenderingFinishSema, *sharedData.sceneRenderingTimelineSema }),
+            &sceneRenderingTimelineSubmitInfo,
         },
         vk::SubmitInfo {
             vku::unsafeProxy({ *sceneRenderingFinishSema, *jumpFloodFinishSema }),
@@ -437,6 +888,9 @@ void vk_gltf_viewer::vulkan::Frame::recordCommandsAndSubmit(std::uint32_t swapch
             *compositionFinishSema,
         },
     }, *inFlightFence);
+    opaqueSubpassStatisticsPending = opaqueSubpassStatisticsQueryPool.has_value();
+
+    return recordingDuration;
 }
 
 vk_gltf_viewer::vulkan::Frame::PassthruResources::JumpFloodResources::JumpFloodResources(
@@ -460,6 +914,29 @@ vk_gltf_viewer::vulkan::Frame::PassthruResources::JumpFloodResources::JumpFloodR
     pingImageView { gpu.device, image.getViewCreateInfo({ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 }) },
     pongImageView { gpu.device, image.getViewCreateInfo({ vk::ImageAspectFlagBits::eColor, 0, 1, 1, 1 }) } { }
 
+vk_gltf_viewer::vulkan::Frame::PassthruResources::DepthPyramidResources::DepthPyramidResources(
+    const Gpu &gpu,
+    const vk::Extent2D &extent
+) : image { gpu.allocator, vk::ImageCreateInfo {
+        {},
+        vk::ImageType::e2D,
+        vk::Format::eR32Sfloat,
+        vk::Extent3D { extent, 1 },
+        vku::Image::maxMipLevels(extent), 1,
+        vk::SampleCountFlagBits::e1,
+        vk::ImageTiling::eOptimal,
+        vk::ImageUsageFlagBits::eStorage /* written by DepthPyramidComputer */
+            | vk::ImageUsageFlagBits::eSampled /* read in CullingComputer */,
+    } },
+    imageView { gpu.device, image.getViewCreateInfo() },
+    mipImageViews { std::from_range, std::views::iota(0U, image.mipLevels) | std::views::transform([&](std::uint32_t level) {
+        return vk::raii::ImageView { gpu.device, image.getViewCreateInfo({ vk::ImageAspectFlagBits::eColor, level, 1, 0, 1 }) };
+    }) } {
+    if (image.mipLevels > DepthPyramidComputer::MAX_MIP_LEVELS) {
+        throw std::runtime_error { "Passthru extent is too large for the depth pyramid" };
+    }
+}
+
 vk_gltf_viewer::vulkan::Frame::PassthruResources::PassthruResources(
     const Gpu &gpu,
     const vk::Extent2D &extent,
@@ -467,9 +944,11 @@ vk_gltf_viewer::vulkan::Frame::PassthruResources::PassthruResources(
 ) : extent { extent },
     hoveringNodeOutlineJumpFloodResources { gpu, extent },
     selectedNodeOutlineJumpFloodResources { gpu, extent },
+    depthPyramidResources { gpu, extent },
     depthPrepassAttachmentGroup { gpu, extent },
     hoveringNodeJumpFloodSeedAttachmentGroup { gpu, hoveringNodeOutlineJumpFloodResources.image },
-    selectedNodeJumpFloodSeedAttachmentGroup { gpu, selectedNodeOutlineJumpFloodResources.image } {
+    selectedNodeJumpFloodSeedAttachmentGroup { gpu, selectedNodeOutlineJumpFloodResources.image },
+    mousePickingAttachmentGroup { gpu, vk::Extent2D { 1, 1 } } {
     recordInitialImageLayoutTransitionCommands(graphicsCommandBuffer);
 }
 
@@ -497,6 +976,9 @@ auto vk_gltf_viewer::vulkan::Frame::PassthruResources::recordInitialImageLayoutT
             layoutTransitionBarrier(vk::ImageLayout::eDepthAttachmentOptimal, hoveringNodeJumpFloodSeedAttachmentGroup.depthStencilAttachment->image, vku::fullSubresourceRange(vk::ImageAspectFlagBits::eDepth)),
             layoutTransitionBarrier(vk::ImageLayout::eGeneral, selectedNodeOutlineJumpFloodResources.image, { vk::ImageAspectFlagBits::eColor, 0, 1, 1, 1 } /* pong image */),
             layoutTransitionBarrier(vk::ImageLayout::eDepthAttachmentOptimal, selectedNodeJumpFloodSeedAttachmentGroup.depthStencilAttachment->image, vku::fullSubresourceRange(vk::ImageAspectFlagBits::eDepth)),
+            layoutTransitionBarrier(vk::ImageLayout::eDepthAttachmentOptimal, mousePickingAttachmentGroup.depthStencilAttachment->image, vku::fullSubresourceRange(vk::ImageAspectFlagBits::eDepth)),
+            // Depth pyramid is bound to CullingComputer even if it is not built yet.
+            layoutTransitionBarrier(vk::ImageLayout::eGeneral, depthPyramidResources.image),
         });
 }
 
@@ -526,17 +1008,31 @@ auto vk_gltf_viewer::vulkan::Frame::createFramebuffers() const -> std::vector<vk
 auto vk_gltf_viewer::vulkan::Frame::createDescriptorPool() const -> decltype(descriptorPool) {
     return {
         gpu.device,
-        (2 * getPoolSizes(sharedData.jumpFloodComputer.descriptorSetLayout, sharedData.outlineRenderer.descriptorSetLayout)
-            + sharedData.weightedBlendedCompositionRenderer.descriptorSetLayout.getPoolSize())
+        (2 * getPoolSizes(sharedData.jumpFloodComputer.descriptorSetLayout, sharedData.outlineRenderer.descriptorSetLayout, sharedData.sceneDescriptorSetLayout)
+            + sharedData.weightedBlendedCompositionRenderer.descriptorSetLayout.getPoolSize()
+            + getPoolSizes(sharedData.depthPyramidComputer.descriptorSetLayout, sharedData.cullingComputer.descriptorSetLayout))
             .getDescriptorPoolCreateInfo(),
     };
 }
 
+auto vk_gltf_viewer::vulkan::Frame::createOpaqueSubpassStatisticsQueryPool() const -> decltype(opaqueSubpassStatisticsQueryPool) {
+    if (!gpu.supportPipelineStatisticsQuery) {
+        return std::nullopt;
+    }
+
+    return decltype(opaqueSubpassStatisticsQueryPool) { std::in_place, gpu.device, vk::QueryPoolCreateInfo {
+        {},
+        vk::QueryType::ePipelineStatistics,
+        1,
+        vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations | vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations,
+    } };
+}
+
 auto vk_gltf_viewer::vulkan::Frame::recordScenePrepassCommands(vk::CommandBuffer cb) const -> void {
-    boost::container::static_vector<vk::ImageMemoryBarrier, 3> memoryBarriers;
+    boost::container::static_vector<vk::ImageMemoryBarrier, 4> memoryBarriers;
 
-    // If glTF Scene have to be rendered, prepare attachment layout transition for node index and depth rendering.
-    if (renderingNodes) {
+    // If glTF Scene have to be rendered with the occlusion culling, prepare attachment layout transition for depth rendering.
+    if (renderingNodes && renderingNodes->occlusionCulled) {
         memoryBarriers.push_back({
             {}, vk::AccessFlagBits::eColorAttachmentWrite,
             {}, vk::ImageLayout::eColorAttachmentOptimal,
@@ -545,6 +1041,16 @@ auto vk_gltf_viewer::vulkan::Frame::recordScenePrepassCommands(vk::CommandBuffer
         });
     }
 
+    // Same holds for the node index rendering of the mouse picking.
+    if (mousePickingNodes && !mousePickingNodes->indices.empty()) {
+        memoryBarriers.push_back({
+            {}, vk::AccessFlagBits::eColorAttachmentWrite,
+            {}, vk::ImageLayout::eColorAttachmentOptimal,
+            vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+            passthruResources->mousePickingAttachmentGroup.getColorAttachment(0).image, vku::fullSubresourceRange(),
+        });
+    }
+
     // If hovering node's outline have to be rendered, prepare attachment layout transition for jump flood seeding.
     const auto addJumpFloodSeedImageMemoryBarrier = [&](vk::Image image) {
         memoryBarriers.push_back({
@@ -573,13 +1079,15 @@ auto vk_gltf_viewer::vulkan::Frame::recordScenePrepassCommands(vk::CommandBuffer
         std::optional<vk::IndexType> indexBuffer;
 
         // (Mask){Depth|JumpFloodSeed}Renderer have compatible descriptor set layouts and push constant range,
-        // therefore they only need to be bound once.
-        bool descriptorSetBound = false;
+        // therefore they only need to be bound once (scene descriptor set is rebound if frustum culled draw
+        // indirections are used).
+        std::optional<vk::DescriptorSet> boundSceneDescriptorSet{};
         bool pushConstantBound = false;
     } resourceBindingState{};
 
     const auto drawPrimitives = [&](
-        const CriteriaSeparatedIndirectDrawCommands &indirectDrawCommandBuffers,
+        const auto &indirectDrawCommandBuffers,
+        vk::DescriptorSet sceneDescriptorSet,
         concepts::signature_of<vk::Pipeline, RenderingStrategy> auto const &pipelineGetter
     ) {
         for (const auto &[criteria, indirectDrawCommandBuffer] : indirectDrawCommandBuffers) {
@@ -587,10 +1095,9 @@ auto vk_gltf_viewer::vulkan::Frame::recordScenePrepassCommands(vk::CommandBuffer
                 cb.bindPipeline(vk::PipelineBindPoint::eGraphics, resourceBindingState.boundPipeline.emplace(pipeline));
             }
 
-            if (!resourceBindingState.descriptorSetBound) {
+            if (resourceBindingState.boundSceneDescriptorSet != sceneDescriptorSet) {
                 cb.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *sharedData.primitiveNoShadingPipelineLayout,
-                    0, { sharedData.assetDescriptorSet, sharedData.sceneDescriptorSet }, {});
-                resourceBindingState.descriptorSetBound = true;
+                    0, { sharedData.assetDescriptorSet, resourceBindingState.boundSceneDescriptorSet.emplace(sceneDescriptorSet) }, {});
             }
 
             if (!resourceBindingState.pushConstantBound) {
@@ -609,24 +1116,114 @@ auto vk_gltf_viewer::vulkan::Frame::recordScenePrepassCommands(vk::CommandBuffer
         }
     };
 
-    if (renderingNodes && cursorPosFromPassthruRectTopLeft) {
+    const auto getDepthPipeline = [this](RenderingStrategy strategy) {
+        if (ranges::one_of(strategy, RenderingStrategy::Mask, RenderingStrategy::MaskUnlit, RenderingStrategy::MaskFaceted)) {
+            return *sharedData.maskDepthRenderer;
+        }
+        return *sharedData.depthRenderer;
+    };
+
+    if (renderingNodes && renderingNodes->occlusionCulled) {
+        // Phase 1: render the depth of the opaque instances visible in the last occlusion test, and build the depth
+        // pyramid from it.
+        sharedData.cullingComputer.compute(cb, cullingSet, previouslyVisibleCullingPushConstants);
+
         cb.beginRenderingKHR(passthruResources->depthPrepassAttachmentGroup.getRenderingInfo(
+            vku::AttachmentGroup::ColorAttachmentInfo { vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare },
+            vku::AttachmentGroup::DepthStencilAttachmentInfo { vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore, { 0.f, 0U } }));
+
+        cb.setViewport(0, vku::toViewport(passthruResources->extent, true));
+        cb.setScissor(0, vk::Rect2D{ { 0, 0 }, passthruResources->extent });
+
+        // Translucent primitives must not occlude the others.
+        drawPrimitives(
+            std::ranges::subrange(
+                renderingNodes->previouslyVisibleIndirectDrawCommandBuffers.lower_bound(RenderingStrategy::Opaque),
+                renderingNodes->previouslyVisibleIndirectDrawCommandBuffers.end()),
+            previouslyVisibleSceneDescriptorSet,
+            getDepthPipeline);
+
+        cb.endRenderingKHR();
+
+        cb.pipelineBarrier(
+            // Phase 1 culling reads the instance visibilities that would be written by phase 2.
+            vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+            {}, {}, {},
+            {
+                vk::ImageMemoryBarrier {
+                    vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::AccessFlagBits::eShaderRead,
+                    vk::ImageLayout::eDepthAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+                    vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+                    passthruResources->depthPrepassAttachmentGroup.depthStencilAttachment->image, vku::fullSubresourceRange(vk::ImageAspectFlagBits::eDepth),
+                },
+                // Previous pyramid is not needed.
+                vk::ImageMemoryBarrier {
+                    {}, vk::AccessFlagBits::eShaderWrite,
+                    {}, vk::ImageLayout::eGeneral,
+                    vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+                    passthruResources->depthPyramidResources.image, vku::fullSubresourceRange(),
+                },
+            });
+
+        sharedData.depthPyramidComputer.compute(cb, depthPyramidSet, passthruResources->extent, passthruResources->depthPyramidResources.image.mipLevels);
+
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eEarlyFragmentTests,
+            {},
+            // Depth pyramid is sampled by phase 2.
+            vk::MemoryBarrier { vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead },
+            {},
+            // Depth image is rendered again by phase 1 of the next execution.
+            vk::ImageMemoryBarrier {
+                vk::AccessFlagBits::eShaderRead, vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eDepthAttachmentOptimal,
+                vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+                passthruResources->depthPrepassAttachmentGroup.depthStencilAttachment->image, vku::fullSubresourceRange(vk::ImageAspectFlagBits::eDepth),
+            });
+
+        // Phase 2: test all instances against the depth pyramid. Culled draw commands are used by both scene prepass
+        // and scene rendering, which are submitted to the same queue later.
+        sharedData.cullingComputer.compute(cb, cullingSet, cullingPushConstants);
+
+        // Statistics have to be available to the host.
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost,
+            {}, {},
+            vk::BufferMemoryBarrier {
+                vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eHostRead,
+                vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
+                occlusionCullingStatisticsBuffer, 0, vk::WholeSize,
+            },
+            {});
+    }
+    else if (!cullingPushConstants.empty()) {
+        // Culled draw commands are used by both scene prepass and scene rendering, which are submitted to the same queue later.
+        sharedData.cullingComputer.compute(cb, cullingSet, cullingPushConstants);
+    }
+
+    if (mousePickingNodes && !mousePickingNodes->indices.empty()) {
+        cb.beginRenderingKHR(passthruResources->mousePickingAttachmentGroup.getRenderingInfo(
             vku::AttachmentGroup::ColorAttachmentInfo {
                 vk::AttachmentLoadOp::eClear,
                 vk::AttachmentStoreOp::eStore,
-                { static_cast<std::uint32_t>(NO_INDEX), 0U, 0U, 0U },
+                { NO_INDEX, 0U, 0U, 0U },
             },
             vku::AttachmentGroup::DepthStencilAttachmentInfo { vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eDontCare, { 0.f, 0U } }));
 
-        cb.setViewport(0, vku::toViewport(passthruResources->extent, true));
-        cb.setScissor(0, vk::Rect2D{ *cursorPosFromPassthruRectTopLeft, { 1, 1 } });
-
-        drawPrimitives(renderingNodes->indirectDrawCommandBuffers, [this](RenderingStrategy strategy) {
-            if (ranges::one_of(strategy, RenderingStrategy::Mask, RenderingStrategy::MaskUnlit, RenderingStrategy::MaskFaceted)) {
-                return *sharedData.maskDepthRenderer;
-            }
-            return *sharedData.depthRenderer;
+        // Offset the passthru rect sized (negative) viewport so that the pixel under the cursor is at the origin of
+        // the 1x1 attachments. Rasterization outside it is discarded, and its result is the same as the full extent
+        // rendering's.
+        cb.setViewport(0, vk::Viewport {
+            -static_cast<float>(cursorPosFromPassthruRectTopLeft->x),
+            static_cast<float>(passthruResources->extent.height - cursorPosFromPassthruRectTopLeft->y),
+            static_cast<float>(passthruResources->extent.width),
+            -static_cast<float>(passthruResources->extent.height),
+            0.f, 1.f,
         });
+        cb.setScissor(0, vk::Rect2D{ { 0, 0 }, { 1, 1 } });
+
+        drawPrimitives(mousePickingNodes->indirectDrawCommandBuffers, sharedData.sceneDescriptorSet, getDepthPipeline);
 
         cb.endRenderingKHR();
     }
@@ -640,7 +1237,7 @@ auto vk_gltf_viewer::vulkan::Frame::recordScenePrepassCommands(vk::CommandBuffer
         cb.setViewport(0, vku::toViewport(passthruResources->extent, true));
         cb.setScissor(0, vk::Rect2D{ { 0, 0 }, passthruResources->extent });
 
-        drawPrimitives(hoveringNode->indirectDrawCommandBuffers, [this](RenderingStrategy strategy) {
+        drawPrimitives(hoveringNode->indirectDrawCommandBuffers, sharedData.sceneDescriptorSet, [this](RenderingStrategy strategy) {
             if (ranges::one_of(strategy, RenderingStrategy::Mask, RenderingStrategy::MaskUnlit, RenderingStrategy::MaskFaceted)) {
                 return *sharedData.maskJumpFloodSeedRenderer;
             }
@@ -659,7 +1256,7 @@ auto vk_gltf_viewer::vulkan::Frame::recordScenePrepassCommands(vk::CommandBuffer
         cb.setViewport(0, vku::toViewport(passthruResources->extent, true));
         cb.setScissor(0, vk::Rect2D{ { 0, 0 }, passthruResources->extent });
 
-        drawPrimitives(selectedNodes->indirectDrawCommandBuffers, [this](RenderingStrategy strategy) {
+        drawPrimitives(selectedNodes->indirectDrawCommandBuffers, sharedData.sceneDescriptorSet, [this](RenderingStrategy strategy) {
             if (ranges::one_of(strategy, RenderingStrategy::Mask, RenderingStrategy::MaskUnlit, RenderingStrategy::MaskFaceted)) {
                 return *sharedData.maskJumpFloodSeedRenderer;
             }
@@ -669,8 +1266,8 @@ auto vk_gltf_viewer::vulkan::Frame::recordScenePrepassCommands(vk::CommandBuffer
         cb.endRenderingKHR();
     }
 
-    // If there are rendered nodes and the cursor is inside the passthru rect, do mouse picking.
-    if (renderingNodes && cursorPosFromPassthruRectTopLeft) {
+    // If there are nodes under the cursor, read the mouse picking result.
+    if (mousePickingNodes && !mousePickingNodes->indices.empty()) {
         cb.pipelineBarrier(
             vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer,
             {}, {}, {},
@@ -679,16 +1276,16 @@ auto vk_gltf_viewer::vulkan::Frame::recordScenePrepassCommands(vk::CommandBuffer
                 vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferRead,
                 vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal,
                 vk::QueueFamilyIgnored, vk::QueueFamilyIgnored,
-                passthruResources->depthPrepassAttachmentGroup.getColorAttachment(0).image, vku::fullSubresourceRange(),
+                passthruResources->mousePickingAttachmentGroup.getColorAttachment(0).image, vku::fullSubresourceRange(),
             });
 
         cb.copyImageToBuffer(
-            passthruResources->depthPrepassAttachmentGroup.getColorAttachment(0).image, vk::ImageLayout::eTransferSrcOptimal,
+            passthruResources->mousePickingAttachmentGroup.getColorAttachment(0).image, vk::ImageLayout::eTransferSrcOptimal,
             hoveringNodeIndexBuffer,
             vk::BufferImageCopy {
                 0, {}, {},
                 { vk::ImageAspectFlagBits::eColor, 0, 0, 1 },
-                vk::Offset3D { *cursorPosFromPassthruRectTopLeft, 0 },
+                { 0, 0, 0 },
                 { 1, 1, 1 },
             });
 
@@ -736,6 +1333,11 @@ auto vk_gltf_viewer::vulkan::Frame::recordJumpFloodComputeCommands(
     return sharedData.jumpFloodComputer.compute(cb, descriptorSet, initialSampleOffset, vku::toExtent2D(image.extent));
 }
 
+auto vk_gltf_viewer::vulkan::Frame::getRenderingNodesSceneDescriptorSet() const noexcept -> vk::DescriptorSet {
+    assert(renderingNodes && "No nodes have to be rendered.");
+    return renderingNodes->frustumCulled ? culledSceneDescriptorSet : sharedData.sceneDescriptorSet;
+}
+
 auto vk_gltf_viewer::vulkan::Frame::recordSceneOpaqueMeshDrawCommands(vk::CommandBuffer cb) const -> void {
     assert(renderingNodes && "No nodes have to be rendered.");
 
@@ -744,12 +1346,31 @@ auto vk_gltf_viewer::vulkan::Frame::recordSceneOpaqueMeshDrawCommands(vk::Comman
         std::optional<vk::CullModeFlagBits> cullMode{};
         std::optional<vk::IndexType> indexBuffer{};
 
-        // (Mask)(Faceted)PrimitiveRenderer have compatible descriptor set layouts and push constant range,
+        // (Mask)(Faceted)Primitive(Depth)Renderer have compatible descriptor set layouts and push constant range,
         // therefore they only need to be bound once.
         bool descriptorBound = false;
         bool pushConstantBound = false;
     } resourceBindingState{};
 
+    const auto getDepthPrepassPipeline = [this](RenderingStrategy strategy) {
+        switch (strategy) {
+        case RenderingStrategy::Opaque:
+            return *sharedData.primitiveDepthRenderer;
+        case RenderingStrategy::OpaqueUnlit:
+            return *sharedData.unlitPrimitiveDepthRenderer;
+        case RenderingStrategy::OpaqueFaceted:
+            return *sharedData.facetedPrimitiveDepthRenderer;
+        case RenderingStrategy::Mask:
+            return *sharedData.maskPrimitiveDepthRenderer;
+        case RenderingStrategy::MaskUnlit:
+            return *sharedData.maskUnlitPrimitiveDepthRenderer;
+        case RenderingStrategy::MaskFaceted:
+            return *sharedData.maskFacetedPrimitiveDepthRenderer;
+        default:
+            throw std::invalid_argument { "Invalid rendering strategy for this function" };
+        }
+    };
+
     const auto getPipeline = [this](RenderingStrategy strategy) {
         switch (strategy) {
         case RenderingStrategy::Opaque:
@@ -771,31 +1392,48 @@ auto vk_gltf_viewer::vulkan::Frame::recordSceneOpaqueMeshDrawCommands(vk::Comman
 
     // Render alphaMode=Opaque | Mask meshes.
     const auto drawCommandBuffers = std::ranges::subrange(
-        renderingNodes->indirectDrawCommandBuffers.lower_bound(RenderingStrategy::Opaque),
-        renderingNodes->indirectDrawCommandBuffers.end());
-    for (const auto &[criteria, indirectDrawCommandBuffer] : drawCommandBuffers) {
-        if (vk::Pipeline pipeline = getPipeline(criteria.strategy); resourceBindingState.boundPipeline != pipeline) {
-            cb.bindPipeline(vk::PipelineBindPoint::eGraphics, resourceBindingState.boundPipeline.emplace(pipeline));
-        }
-        if (!resourceBindingState.descriptorBound) {
-            cb.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *sharedData.primitivePipelineLayout, 0,
-                { sharedData.imageBasedLightingDescriptorSet, sharedData.assetDescriptorSet, sharedData.sceneDescriptorSet }, {});
-            resourceBindingState.descriptorBound = true;
-        }
-        if (!resourceBindingState.pushConstantBound) {
-            sharedData.primitivePipelineLayout.pushConstants(cb, { projectionViewMatrix, viewPosition });
-            resourceBindingState.pushConstantBound = true;
-        }
+        renderingNodes->getDrawnIndirectDrawCommandBuffers().lower_bound(RenderingStrategy::Opaque),
+        renderingNodes->getDrawnIndirectDrawCommandBuffers().end());
+    const auto recordDrawCommands = [&](const auto &getPipeline) {
+        for (const auto &[criteria, indirectDrawCommandBuffer] : drawCommandBuffers) {
+            if (vk::Pipeline pipeline = getPipeline(criteria.strategy); resourceBindingState.boundPipeline != pipeline) {
+                cb.bindPipeline(vk::PipelineBindPoint::eGraphics, resourceBindingState.boundPipeline.emplace(pipeline));
+            }
+            if (!resourceBindingState.descriptorBound) {
+                cb.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *sharedData.primitivePipelineLayout, 0,
+                    { sharedData.imageBasedLightingDescriptorSet, sharedData.assetDescriptorSet, getRenderingNodesSceneDescriptorSet() }, {});
+                resourceBindingState.descriptorBound = true;
+            }
+            if (!resourceBindingState.pushConstantBound) {
+                sharedData.primitivePipelineLayout.pushConstants(cb, { gpu.device.getBufferAddress({ cameraBuffer }) });
+                resourceBindingState.pushConstantBound = true;
+            }
 
-        if (auto cullMode = criteria.doubleSided ? vk::CullModeFlagBits::eNone : vk::CullModeFlagBits::eBack; resourceBindingState.cullMode != cullMode) {
-            cb.setCullMode(resourceBindingState.cullMode.emplace(cullMode));
-        }
+            if (auto cullMode = criteria.doubleSided ? vk::CullModeFlagBits::eNone : vk::CullModeFlagBits::eBack; resourceBindingState.cullMode != cullMode) {
+                cb.setCullMode(resourceBindingState.cullMode.emplace(cullMode));
+            }
 
-        if (const auto &indexType = criteria.indexType; indexType && resourceBindingState.indexBuffer != *indexType) {
-            cb.bindIndexBuffer(indexBuffers.at(*indexType), 0, resourceBindingState.indexBuffer.emplace(*indexType));
+            if (const auto &indexType = criteria.indexType; indexType && resourceBindingState.indexBuffer != *indexType) {
+                cb.bindIndexBuffer(indexBuffers.at(*indexType), 0, resourceBindingState.indexBuffer.emplace(*indexType));
+            }
+            visit([&](const auto &x) { x.recordDrawCommand(cb, gpu.supportDrawIndirectCount); }, indirectDrawCommandBuffer);
         }
-        visit([&](const auto &x) { x.recordDrawCommand(cb, gpu.supportDrawIndirectCount); }, indirectDrawCommandBuffer);
+    };
+
+    if (useFullDepthPrepass) {
+        // Lay down the depth of all opaque meshes first, then shade only the fragments whose depth exactly matches, so
+        // that each pixel is shaded once regardless of the draw order. Depth prepass pipelines use the same vertex
+        // shaders (with invariant gl_Position) as the shading pipelines, therefore the depths are bitwise identical.
+        recordDrawCommands(getDepthPrepassPipeline);
+
+        cb.setDepthCompareOp(vk::CompareOp::eEqual);
+        cb.setDepthWriteEnable(false);
     }
+    else {
+        cb.setDepthCompareOp(vk::CompareOp::eGreater); // Use reverse Z.
+        cb.setDepthWriteEnable(true);
+    }
+    recordDrawCommands(getPipeline);
 }
 
 auto vk_gltf_viewer::vulkan::Frame::recordSceneBlendMeshDrawCommands(vk::CommandBuffer cb) const -> bool {
@@ -827,8 +1465,8 @@ auto vk_gltf_viewer::vulkan::Frame::recordSceneBlendMeshDrawCommands(vk::Command
     // Render alphaMode=Blend meshes.
     bool hasBlendMesh = false;
     const auto drawCommandBuffers = std::ranges::subrange(
-        renderingNodes->indirectDrawCommandBuffers.begin(),
-        renderingNodes->indirectDrawCommandBuffers.upper_bound(RenderingStrategy::BlendFaceted));
+        renderingNodes->getDrawnIndirectDrawCommandBuffers().begin(),
+        renderingNodes->getDrawnIndirectDrawCommandBuffers().upper_bound(RenderingStrategy::BlendFaceted));
     for (const auto &[criteria, indirectDrawCommandBuffer] : drawCommandBuffers) {
         if (vk::Pipeline pipeline = getPipeline(criteria.strategy); resourceBindingState.boundPipeline != pipeline) {
             resourceBindingState.boundPipeline = pipeline;
@@ -836,11 +1474,11 @@ auto vk_gltf_viewer::vulkan::Frame::recordSceneBlendMeshDrawCommands(vk::Command
         }
         if (!resourceBindingState.descriptorBound) {
             cb.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *sharedData.primitivePipelineLayout, 0,
-                { sharedData.imageBasedLightingDescriptorSet, sharedData.assetDescriptorSet, sharedData.sceneDescriptorSet }, {});
+                { sharedData.imageBasedLightingDescriptorSet, sharedData.assetDescriptorSet, getRenderingNodesSceneDescriptorSet() }, {});
             resourceBindingState.descriptorBound = true;
         }
         if (!resourceBindingState.pushConstantBound) {
-            sharedData.primitivePipelineLayout.pushConstants(cb, { projectionViewMatrix, viewPosition });
+            sharedData.primitivePipelineLayout.pushConstants(cb, { gpu.device.getBufferAddress({ cameraBuffer }) });
             resourceBindingState.pushConstantBound = true;
         }
 
@@ -856,7 +1494,51 @@ auto vk_gltf_viewer::vulkan::Frame::recordSceneBlendMeshDrawCommands(vk::Command
 
 auto vk_gltf_viewer::vulkan::Frame::recordSkyboxDrawCommands(vk::CommandBuffer cb) const -> void {
     assert(holds_alternative<vku::DescriptorSet<dsl::Skybox>>(background) && "recordSkyboxDrawCommand called, but background is not set to the proper skybox descriptor set.");
-    sharedData.skyboxRenderer.draw(cb, get<vku::DescriptorSet<dsl::Skybox>>(background), { translationlessProjectionViewMatrix });
+    sharedData.skyboxRenderer.draw(cb, get<vku::DescriptorSet<dsl::Skybox>>(background), { gpu.device.getBufferAddress({ skyboxProjectionViewBuffer }) });
+}
+
+auto vk_gltf_viewer::vulkan::Frame::recordSceneSubpassCommands() const -> bool {
+    const vk::Viewport passthruViewport {
+        // Use negative viewport.
+        static_cast<float>(passthruRect.offset.x), static_cast<float>(passthruRect.offset.y + passthruRect.extent.height),
+        static_cast<float>(passthruRect.extent.width), -static_cast<float>(passthruRect.extent.height),
+        0.f, 1.f,
+    };
+
+    // Framebuffer is not specified in the inheritance info, so that the commands can be executed for any swapchain
+    // image. Secondary command buffers don't inherit the dynamic states, therefore each of them sets its own.
+    const auto beginSubpassCommandBuffer = [&](vk::CommandBuffer cb, std::uint32_t subpass) {
+        cb.begin({
+            vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+            vku::unsafeAddress(vk::CommandBufferInheritanceInfo { *sharedData.sceneRenderPass, subpass }),
+        });
+        cb.setViewport(0, passthruViewport);
+        cb.setScissor(0, passthruRect);
+    };
+
+    beginSubpassCommandBuffer(sceneOpaqueSubpassCommandBuffer, 0);
+    if (opaqueSubpassStatisticsQueryPool) {
+        sceneOpaqueSubpassCommandBuffer.beginQuery(**opaqueSubpassStatisticsQueryPool, 0, {});
+    }
+    if (renderingNodes) {
+        recordSceneOpaqueMeshDrawCommands(sceneOpaqueSubpassCommandBuffer);
+    }
+    if (holds_alternative<vku::DescriptorSet<dsl::Skybox>>(background)) {
+        recordSkyboxDrawCommands(sceneOpaqueSubpassCommandBuffer);
+    }
+    if (opaqueSubpassStatisticsQueryPool) {
+        sceneOpaqueSubpassCommandBuffer.endQuery(**opaqueSubpassStatisticsQueryPool, 0);
+    }
+    sceneOpaqueSubpassCommandBuffer.end();
+
+    beginSubpassCommandBuffer(sceneBlendSubpassCommandBuffer, 1);
+    bool hasBlendMesh = false;
+    if (renderingNodes) {
+        hasBlendMesh = recordSceneBlendMeshDrawCommands(sceneBlendSubpassCommandBuffer);
+    }
+    sceneBlendSubpassCommandBuffer.end();
+
+    return hasBlendMesh;
 }
 
 auto vk_gltf_viewer::vulkan::Frame::recordNodeOutlineCompositionCommands(
@@ -180,6 +180,7 @@ auto vk_gltf_viewer::vulkan::Gpu::createDevice() -> vk::raii::Device {
 
     supportDrawIndirectCount = availableFeatures.template get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount;
     supportUint8Index = availableFeatures.template get<vk::PhysicalDeviceIndexTypeUint8FeaturesKHR>().indexTypeUint8;
+    supportPipelineStatisticsQuery = availableFeatures.template get<vk::PhysicalDeviceFeatures2>().features.pipelineStatisticsQuery;
 
 	const vku::RefHolder queueCreateInfos = Queues::getCreateInfos(physicalDevice, queueFamilies);
     vk::StructureChain createInfo {
@@ -195,7 +196,8 @@ auto vk_gltf_viewer::vulkan::Gpu::createDevice() -> vk::raii::Device {
                 .setShaderInt64(true)
                 .setMultiDrawIndirect(true)
                 .setShaderStorageImageWriteWithoutFormat(true)
-                .setIndependentBlend(true),
+                .setIndependentBlend(true)
+                .setPipelineStatisticsQuery(supportPipelineStatisticsQuery),
         },
         vk::PhysicalDeviceVulkan11Features{}
             .setShaderDrawParameters(true)
@@ -18,6 +18,22 @@ namespace vk_gltf_viewer {
             glm::vec4 color;
         };
 
+        struct OcclusionCullingStatistics {
+            std::uint32_t testedInstanceCount;
+            std::uint32_t occludedInstanceCount;
+        };
+
+        struct VertexAttributeCompressionError {
+            float maxNormalAngle;   // In radian.
+            float maxTangentAngle;  // In radian.
+            float maxTexcoordError; // Absolute error in UV space.
+        };
+
+        struct OpaqueSubpassStatistics {
+            std::uint64_t vertexShaderInvocationCount;
+            std::uint64_t fragmentShaderInvocationCount;
+        };
+
         struct ImageBasedLighting {
             struct EquirectangularMap {
                 std::filesystem::path path;
@@ -41,15 +57,28 @@ namespace vk_gltf_viewer {
 
         class GltfAsset {
         public:
+            struct AnimationPlayback {
+                std::size_t animationIndex = 0;
+                float time = 0.f; // in seconds.
+                bool playing = false;
+                bool loop = true;
+            };
+
             fastgltf::Asset &asset;
             std::variant<std::vector<std::optional<bool>>, std::vector<bool>> nodeVisibilities { std::in_place_index<0>, asset.nodes.size(), true };
             std::optional<std::size_t> assetInspectorMaterialIndex = value_if(!asset.materials.empty(), std::size_t { 0 });
 
-            std::unordered_set<std::uint16_t> selectedNodeIndices;
-            std::optional<std::uint16_t> hoveringNodeIndex;
+            std::unordered_set<std::uint32_t> selectedNodeIndices;
+            std::optional<std::uint32_t> hoveringNodeIndex;
+            std::optional<AnimationPlayback> animationPlayback; // nullopt if the asset has no animation.
+            std::optional<VertexAttributeCompressionError> vertexAttributeCompressionError; // nullopt if the vertex attributes are not compressed.
 
             explicit GltfAsset(fastgltf::Asset &asset) noexcept
-                : asset { asset } { }
+                : asset { asset } {
+                if (!asset.animations.empty()) {
+                    animationPlayback.emplace();
+                }
+            }
 
             [[nodiscard]] auto getSceneIndex() const noexcept -> std::size_t { return sceneIndex; }
             [[nodiscard]] auto getScene() const noexcept -> fastgltf::Scene& { return asset.scenes[sceneIndex]; }
@@ -58,6 +87,8 @@ namespace vk_gltf_viewer {
                 visit([](auto &visibilities) {
                     std::ranges::fill(visibilities, true);
                 }, nodeVisibilities);
+                sceneVersion = ++versionCounter;
+                notifyNodeVisibilitiesChanged();
                 selectedNodeIndices.clear();
                 hoveringNodeIndex.reset();
             }
@@ -70,13 +101,55 @@ namespace vk_gltf_viewer {
              */
             void switchNodeVisibilityType();
 
+            /**
+             * @brief Version of the current scene, which is changed whenever the scene is changed.
+             *
+             * Like <tt>getNodeVisibilityVersion()</tt>, versions are unique across the <tt>GltfAsset</tt> instances.
+             */
+            [[nodiscard]] auto getSceneVersion() const noexcept -> std::uint64_t { return sceneVersion; }
+
+            /**
+             * @brief Version of <tt>nodeVisibilities</tt>, which is changed whenever the visibilities are changed.
+             *
+             * Versions are unique across the <tt>GltfAsset</tt> instances, therefore it can be used as a cache key of the
+             * data derived from the visibilities, even if the asset is reloaded.
+             */
+            [[nodiscard]] auto getNodeVisibilityVersion() const noexcept -> std::uint64_t { return nodeVisibilityVersion; }
+
+            /**
+             * @brief Update the version of <tt>nodeVisibilities</tt>. Must be called after modifying it.
+             */
+            void notifyNodeVisibilitiesChanged() noexcept { nodeVisibilityVersion = ++versionCounter; }
+
             /**
              * From <tt>nodeVisibilities</tt>, get the unique indices of the visible nodes.
+             *
+             * The result is cached and rebuilt only if the visibility version is changed since the last call.
+             *
              * @return <tt>std::unordered_set</tt> of the visible node indices.
              * @note Since the result only contains node which is visible, nodes without mesh are excluded regardless of
              * its corresponding <tt>nodeVisibilities</tt> is <tt>true</tt>.
              */
-            [[nodiscard]] auto getVisibleNodeIndices() const noexcept -> std::unordered_set<std::uint16_t> {
+            [[nodiscard]] auto getVisibleNodeIndices() const -> const std::unordered_set<std::uint32_t>& {
+                if (visibleNodeIndicesVersion != nodeVisibilityVersion) {
+                    visibleNodeIndices = createVisibleNodeIndices();
+                    visibleNodeIndicesVersion = nodeVisibilityVersion;
+                }
+                return visibleNodeIndices;
+            }
+
+        private:
+            static inline std::uint64_t versionCounter = 0;
+
+            std::size_t sceneIndex = asset.defaultScene.value_or(0);
+            std::uint64_t sceneVersion = ++versionCounter;
+            std::uint64_t nodeVisibilityVersion = ++versionCounter;
+
+            // Cache of getVisibleNodeIndices(). Version 0 is never used, therefore the cache is initially invalid.
+            mutable std::unordered_set<std::uint32_t> visibleNodeIndices;
+            mutable std::uint64_t visibleNodeIndicesVersion = 0;
+
+            [[nodiscard]] auto createVisibleNodeIndices() const -> std::unordered_set<std::uint32_t> {
                 return visit(multilambda {
                     [this](std::span<const std::optional<bool>> tristateVisibilities) {
                         return tristateVisibilities
@@ -85,8 +158,8 @@ namespace vk_gltf_viewer {
                                 return visibility.value_or(false) && asset.nodes[nodeIndex].meshIndex.has_value();
                             }))
                             | std::views::keys
-                            // Explicit value type must be specified, because std::views::enumerate's index type is range_difference_t<R> (!= std::uint16_t).
-                            | std::ranges::to<std::unordered_set<std::uint16_t>>();
+                            // Explicit value type must be specified, because std::views::enumerate's index type is range_difference_t<R> (!= std::uint32_t).
+                            | std::ranges::to<std::unordered_set<std::uint32_t>>();
                     },
                     [this](const std::vector<bool> &visibilities) {
                         return visibilities
@@ -95,20 +168,27 @@ namespace vk_gltf_viewer {
                                 return visibility && asset.nodes[nodeIndex].meshIndex.has_value();
                             }))
                             | std::views::keys
-                            // Explicit value type must be specified, because std::views::enumerate's index type is range_difference_t<R> (!= std::uint16_t).
-                            | std::ranges::to<std::unordered_set<std::uint16_t>>();
+                            // Explicit value type must be specified, because std::views::enumerate's index type is range_difference_t<R> (!= std::uint32_t).
+                            | std::ranges::to<std::unordered_set<std::uint32_t>>();
                     }
                 }, nodeVisibilities);
             }
-
-        private:
-            std::size_t sceneIndex = asset.defaultScene.value_or(0);
         };
 
         control::Camera camera;
         bool automaticNearFarPlaneAdjustment = true;
         bool useFrustumCulling = false;
+        bool useOcclusionCulling = false; // Only effective when useFrustumCulling is true.
+        std::optional<OcclusionCullingStatistics> occlusionCullingStatistics; // Feedback from the frame, nullopt if occlusion culling is not performed.
+        bool useGpuNodeTransformPropagation = false;
+        bool useMultithreadedCommandRecording = true;
+        std::chrono::nanoseconds commandRecordingDuration{}; // Feedback from the last frame.
+        bool useFullDepthPrepass = false;
+        std::optional<OpaqueSubpassStatistics> opaqueSubpassStatistics; // Feedback from the frame, nullopt if pipeline statistics query is not supported.
+        bool interleaveVertexAttributes = false; // Applied at the next glTF loading.
+        bool compressVertexAttributes = false; // Applied at the next glTF loading.
         std::optional<glm::vec2> hoveringMousePosition;
+        bool useCpuPicking = false; // Pick the hovering node by ray casting in the host, instead of the GPU node index prepass.
         full_optional<Outline> hoveringNodeOutline { std::in_place, 2.f, glm::vec4 { 1.f, 0.5f, 0.2f, 1.f } };
         full_optional<Outline> selectedNodeOutline { std::in_place, 2.f, glm::vec4 { 0.f, 1.f, 0.2f, 1.f } };
         bool canSelectSkyboxBackground = false; // TODO: bad design... this and background should be handled in a single field.
@@ -3,12 +3,17 @@ export module vk_gltf_viewer:MainApp;
 import std;
 import :control.AppWindow;
 import :gltf.algorithm.miniball;
+import :gltf.AssetAnimation;
 import :gltf.AssetExternalBuffers;
 import :gltf.AssetGpuBuffers;
 import :gltf.AssetGpuTextures;
 import :gltf.AssetGpuFallbackTexture;
+import :gltf.AssetPrimitiveTriangles;
+import :gltf.AssetSceneBvh;
 import :gltf.AssetSceneGpuBuffers;
 import :gltf.AssetSceneHierarchy;
+import :gltf.AssetSceneMorphTargets;
+import :gltf.AssetSceneSkinning;
 import :vulkan.dsl.Asset;
 import :vulkan.dsl.ImageBasedLighting;
 import :vulkan.dsl.Scene;
@@ -47,21 +52,51 @@ namespace vk_gltf_viewer {
             const vulkan::Gpu &gpu;
 
         public:
+            /**
+             * @brief Thread pool that is used for the asset processing and animation evaluation.
+             */
+            BS::thread_pool threadPool;
+
             /**
 			 * @brief External buffers that are not embedded in the glTF file, such like .bin files.
              * 
              * If you specified <tt>fastgltf::Options::LoadExternalBuffers</tt>, this should be omitted.
              */
-            gltf::AssetExternalBuffers assetExternalBuffers{ asset, directory };
+            gltf::AssetExternalBuffers assetExternalBuffers;
 
             gltf::AssetGpuBuffers assetGpuBuffers;
             gltf::AssetGpuTextures assetGpuTextures;
 
+            /**
+             * @brief Evaluators of the asset animations. <tt>animations[i]</tt> = (evaluator of <tt>asset.animations[i]</tt>).
+             */
+            std::vector<gltf::AssetAnimation> animations;
+
+            /**
+             * @brief Host side triangles of the asset primitives, for the CPU ray-cast picking.
+             *
+             * It is only needed while the CPU picking is enabled, therefore built in background by
+             * <tt>updatePrimitiveTriangles()</tt> when it is enabled, and released when disabled. <tt>std::nullopt</tt>
+             * until the build is done.
+             */
+            std::optional<gltf::AssetPrimitiveTriangles> primitiveTriangles;
+
+        private:
+            /**
+             * @brief Pending background build of <tt>primitiveTriangles</tt>, or invalid if there is no build in progress.
+             *
+             * It is from <tt>std::async</tt>, whose destructor waits for the build, therefore it MUST be declared after
+             * the asset resources that the build reads.
+             */
+            std::future<gltf::AssetPrimitiveTriangles> primitiveTrianglesBuild;
+
+        public:
+
             /**
              * @brief The glTF scene that is currently used by.
              *
              * This could be changed, but direct assignment is forbidden (because changing this field requires the additional
-             * modification of <tt>sceneGpuBuffers</tt> and <tt>sceneMiniball</tt>). Use <tt>setScene</tt> for the purpose.
+             * modification of <tt>sceneGpuBuffers</tt> and <tt>sceneBvh</tt>). Use <tt>setScene</tt> for the purpose.
              */
             fastgltf::Scene &scene { asset.scenes[asset.defaultScene.value_or(0)] };
 
@@ -75,20 +110,94 @@ namespace vk_gltf_viewer {
 			 */
             gltf::AssetSceneGpuBuffers sceneGpuBuffers;
 
-			/**
-			 * @brief Smallest enclosing sphere of all meshes (a.k.a. miniball) in the scene.
-             * 
-			 * The first of the pair is the center, and the second is the radius of the miniball.
-			 */
-            std::pair<fastgltf::math::dvec3, double> sceneMiniball;
+            /**
+             * @brief Joint matrices of the skinned meshes in the current scene.
+             */
+            gltf::AssetSceneSkinning sceneSkinning;
+
+            /**
+             * @brief Target weights of the morphed meshes in the current scene.
+             */
+            gltf::AssetSceneMorphTargets sceneMorphTargets;
+
+            /**
+             * @brief Bounding volume hierarchy of the mesh node instances, which is refitted when a node transform is changed.
+             */
+            gltf::AssetSceneBvh sceneBvh;
 
             Gltf(
                 fastgltf::Parser &parser,
                 const std::filesystem::path &path,
                 const vulkan::Gpu &gpu [[clang::lifetimebound]],
-                BS::thread_pool threadPool = {});
+                bool interleaveVertexAttributes,
+                bool compressVertexAttributes);
 
             void setScene(std::size_t sceneIndex);
+
+            /**
+             * @brief Get smallest enclosing sphere of all meshes (a.k.a. miniball) in the scene.
+             *
+             * It is calculated at the first call after the scene change or node transform change, and cached until then.
+             *
+             * @return The pair of the miniball's center and radius.
+             */
+            [[nodiscard]] const std::pair<fastgltf::math::dvec3, double> &getSceneMiniball();
+
+            /**
+             * @brief Refit the scene BVH after \p nodeIndex-th node world transform is changed, and invalidate the cached miniball.
+             * @param nodeIndex Index of the node whose transform is changed. <tt>sceneHierarchy</tt> must be already updated.
+             */
+            void refitSceneBounds(std::size_t nodeIndex);
+
+            /**
+             * @brief Start building <tt>primitiveTriangles</tt> in background if \p enabled, or release them if not.
+             *
+             * The finished build is taken into <tt>primitiveTriangles</tt> by this function, therefore it should be
+             * called every frame.
+             *
+             * @param enabled Whether the CPU picking is enabled.
+             */
+            void updatePrimitiveTriangles(bool enabled);
+
+            /**
+             * @brief Get the index of the closest visible node that is intersected by the ray.
+             *
+             * For the alpha masked materials, only the base color factor is considered.
+             *
+             * @param rayOrigin Ray origin in the world space, on the near plane.
+             * @param rayDirection Displacement from \p rayOrigin to the far plane in the world space. Intersections beyond it are ignored.
+             * @param visibleNodeIndices Indices of the nodes to be considered.
+             * @return Index of the intersected node, or <tt>std::nullopt</tt> if there is no such node or <tt>primitiveTriangles</tt> is not built.
+             */
+            [[nodiscard]] std::optional<std::uint32_t> pickNode(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection, const std::unordered_set<std::uint32_t> &visibleNodeIndices) const;
+
+            /**
+             * @brief Collect the indices of the visible nodes that may be intersected by the ray, i.e. whose bounding
+             * boxes are intersected by it, or whose meshes are deformed.
+             *
+             * @param rayOrigin Ray origin in the world space.
+             * @param rayDirection Ray direction in the world space. It does not have to be normalized.
+             * @param visibleNodeIndices Indices of the nodes to be considered.
+             * @param result Vector that is cleared and filled with the sorted unique indices of the candidate nodes. Its storage is reused.
+             */
+            void collectRayCandidateNodeIndices(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection, const std::unordered_set<std::uint32_t> &visibleNodeIndices, std::vector<std::uint32_t> &result) const;
+
+        private:
+			/**
+			 * @brief Smallest enclosing sphere of all meshes (a.k.a. miniball) in the scene. <tt>std::nullopt</tt> if it is not calculated yet or invalidated.
+             *
+			 * The first of the pair is the center, and the second is the radius of the miniball.
+			 */
+            std::optional<std::pair<fastgltf::math::dvec3, double>> sceneMiniball;
+
+            /**
+             * @brief Indices of the mesh nodes in the current scene that have any skinned or morphed primitive. Their
+             * bounding boxes in <tt>sceneBvh</tt> are from the undeformed positions, therefore not reliable.
+             */
+            std::vector<std::uint32_t> deformedMeshNodeIndices = createDeformedMeshNodeIndices();
+
+            [[nodiscard]] std::vector<std::uint32_t> createDeformedMeshNodeIndices() const;
+            [[nodiscard]] fastgltf::math::dmat4x4 getMeshNodeWorldTransform(std::size_t nodeIndex, std::size_t instanceIndex) const noexcept;
         };
         
         struct SkyboxResources {
@@ -124,10 +233,17 @@ namespace vk_gltf_viewer {
         // glTF resources.
         // --------------------
 
-        fastgltf::Parser parser { fastgltf::Extensions::KHR_materials_unlit | fastgltf::Extensions::KHR_texture_basisu | fastgltf::Extensions::EXT_mesh_gpu_instancing };
+        fastgltf::Parser parser { fastgltf::Extensions::KHR_materials_unlit | fastgltf::Extensions::KHR_texture_basisu | fastgltf::Extensions::EXT_mesh_gpu_instancing | fastgltf::Extensions::EXT_meshopt_compression };
         fastgltf::GltfDataBuffer dataBuffer;
         std::optional<Gltf> gltf;
 
+        /**
+         * @brief Sorted indices of the nodes that may be under the cursor, which are drawn in the GPU mouse picking pass.
+         *
+         * It is refilled every frame, and kept as a member so that its storage is reused.
+         */
+        std::vector<std::uint32_t> mousePickingNodeIndices;
+
         // Buffers, images, image views and samplers.
         ImageBasedLightingResources imageBasedLightingResources = createDefaultImageBasedLightingResources();
         std::optional<SkyboxResources> skyboxResources{};
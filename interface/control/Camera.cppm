@@ -49,16 +49,23 @@ namespace vk_gltf_viewer::control {
             // Get projection of the displacement vector (from camera position to bounding sphere center) on the direction vector.
             const glm::vec3 displacement = boundingSphereCenter - position;
             const float displacementProjectionLength = dot(displacement, direction);
-            const float displacementNearProjectionLength = displacementProjectionLength - boundingSphereRadius;
-            const float displacementFarProjectionLength = displacementProjectionLength + boundingSphereRadius;
-            if (displacementFarProjectionLength <= 0.f) {
-                // The bounding sphere is behind the camera.
+            tightenNearFar(displacementProjectionLength - boundingSphereRadius, displacementProjectionLength + boundingSphereRadius);
+        }
+
+        /**
+         * @brief Tighten near/far plane to the given range of the depth along the view direction.
+         * @param nearestDepth Nearest depth of the scene. Clamped to be at least 0.01.
+         * @param farthestDepth Farthest depth of the scene. If it is not positive, the scene is behind the camera.
+         */
+        void tightenNearFar(float nearestDepth, float farthestDepth) noexcept {
+            if (farthestDepth <= 0.f) {
+                // The scene is behind the camera.
                 zMin = 1e-2f;
                 zMax = 1e2f;
             }
             else {
-                zMin = std::max(1e-2f, displacementNearProjectionLength);
-                zMax = displacementFarProjectionLength;
+                zMin = std::max(1e-2f, nearestDepth);
+                zMax = farthestDepth;
             }
         }
 
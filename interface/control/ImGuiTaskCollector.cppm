@@ -15,14 +15,16 @@ namespace vk_gltf_viewer::control {
         ImGuiTaskCollector(std::vector<Task> &tasks, const ImVec2 &framebufferSize, const vk::Rect2D &oldPassthruRect);
         ~ImGuiTaskCollector();
 
-        void menuBar(const std::list<std::filesystem::path> &recentGltfs, const std::list<std::filesystem::path> &recentSkyboxes);
+        void menuBar(const std::list<std::filesystem::path> &recentGltfs, const std::list<std::filesystem::path> &recentSkyboxes, bool &interleaveVertexAttributes, bool &compressVertexAttributes, const std::optional<AppState::VertexAttributeCompressionError> &vertexAttributeCompressionError);
         void assetInspector(fastgltf::Asset &asset, const std::filesystem::path &assetDir);
         void materialEditor(fastgltf::Asset &asset, std::optional<std::size_t> &selectedMaterialIndex, std::span<const vk::DescriptorSet> assetTextureImGuiDescriptorSets);
-        void sceneHierarchy(fastgltf::Asset &asset, std::size_t sceneIndex, const std::variant<std::vector<std::optional<bool>>, std::vector<bool>> &visibilities, const std::optional<std::uint16_t> &hoveringNodeIndex, const std::unordered_set<std::uint16_t> &selectedNodeIndices);
-        void nodeInspector(fastgltf::Asset &asset, const std::unordered_set<std::uint16_t> &selectedNodeIndices);
+        void sceneHierarchy(fastgltf::Asset &asset, std::size_t sceneIndex, const std::variant<std::vector<std::optional<bool>>, std::vector<bool>> &visibilities, const std::optional<std::uint32_t> &hoveringNodeIndex, const std::unordered_set<std::uint32_t> &selectedNodeIndices);
+        void nodeInspector(fastgltf::Asset &asset, const std::unordered_set<std::uint32_t> &selectedNodeIndices);
+        void animation(const fastgltf::Asset &asset, AppState::GltfAsset::AnimationPlayback &playback, float duration);
         void background(bool canSelectSkyboxBackground, full_optional<glm::vec3> &solidBackground);
         void imageBasedLighting(const AppState::ImageBasedLighting &info, vk::DescriptorSet eqmapTextureImGuiDescriptorSet);
-        void inputControl(Camera &camera, bool& automaticNearFarPlaneAdjustment, bool &useFrustumCulling, full_optional<AppState::Outline> &hoveringNodeOutline, full_optional<AppState::Outline> &selectedNodeOutline);
+        void inputControl(Camera &camera, bool& automaticNearFarPlaneAdjustment, bool &useFrustumCulling, bool &useOcclusionCulling, bool &useGpuNodeTransformPropagation, bool &useMultithreadedCommandRecording, std::chrono::nanoseconds commandRecordingDuration, bool &useFullDepthPrepass, const std::optional<AppState::OpaqueSubpassStatistics> &opaqueSubpassStatistics, bool &useCpuPicking, full_optional<AppState::Outline> &hoveringNodeOutline, full_optional<AppState::Outline> &selectedNodeOutline);
+        void occlusionCullingStatistics(const AppState::OcclusionCullingStatistics &statistics);
         void imguizmo(Camera &camera);
         void imguizmo(Camera &camera, fastgltf::math::fmat4x4 &selectedNodeWorldTransform, ImGuizmo::OPERATION operation);
 
@@ -34,6 +36,7 @@ namespace vk_gltf_viewer::control {
         bool materialEditorCalled = false;
         bool sceneHierarchyCalled = false;
         bool nodeInspectorCalled = false;
+        bool animationCalled = false;
         bool imageBasedLightingCalled = false;
     };
 }
\ No newline at end of file
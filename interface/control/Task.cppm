@@ -12,11 +12,13 @@ namespace vk_gltf_viewer::control {
         struct LoadEqmap { std::filesystem::path path; };
         struct ChangeScene { std::size_t newSceneIndex; };
         struct ChangeNodeVisibilityType { };
-        struct ChangeNodeVisibility { std::uint16_t nodeIndex; };
-        struct SelectNodeFromSceneHierarchy { std::uint16_t nodeIndex; bool combine; };
-        struct HoverNodeFromSceneHierarchy { std::uint16_t nodeIndex; };
-        struct ChangeNodeLocalTransform { std::uint16_t nodeIndex; };
+        struct ChangeNodeVisibility { std::uint32_t nodeIndex; };
+        struct SelectNodeFromSceneHierarchy { std::uint32_t nodeIndex; bool combine; };
+        struct HoverNodeFromSceneHierarchy { std::uint32_t nodeIndex; };
+        struct ChangeNodeLocalTransform { std::uint32_t nodeIndex; };
+        struct ChangeNodeMorphTargetWeights { std::uint32_t nodeIndex; };
         struct ChangeSelectedNodeWorldTransform{};
+        struct ChangeAnimationTime { };
         struct TightenNearFarPlane { };
         struct ChangeCameraView { };
         struct InvalidateDrawCommandSeparation { };
@@ -33,7 +35,9 @@ namespace vk_gltf_viewer::control {
         task::SelectNodeFromSceneHierarchy,
         task::HoverNodeFromSceneHierarchy,
         task::ChangeNodeLocalTransform,
+        task::ChangeNodeMorphTargetWeights,
         task::ChangeSelectedNodeWorldTransform,
+        task::ChangeAnimationTime,
         task::TightenNearFarPlane,
         task::ChangeCameraView,
         task::InvalidateDrawCommandSeparation>;
@@ -0,0 +1,336 @@
+export module vk_gltf_viewer:gltf.AssetAnimation;
+
+import std;
+export import fastgltf;
+export import thread_pool;
+export import :gltf.AssetProcessError;
+
+namespace vk_gltf_viewer::gltf {
+    /**
+     * @brief Evaluator of a glTF animation, which writes the sampled values into the node local transforms and morph target weights.
+     *
+     * Keyframes of each sampler are converted into the tightly packed float arrays at construction (normalized integer
+     * outputs are dequantized, cubic spline tangents are kept interleaved with their values), so that the evaluation
+     * doesn't have to access the accessor data. Each sampler remembers the keyframe interval of the last evaluation
+     * (cursor), and the next evaluation advances it forward from there. As the playback time monotonically increases in
+     * most cases, keyframe lookup is amortized constant time without binary search.
+     */
+    export class AssetAnimation {
+    public:
+        /**
+         * @brief Duration of the animation in seconds, which is the maximum input value of all samplers.
+         */
+        float duration = 0.f;
+
+        template <typename BufferDataAdapter = fastgltf::DefaultBufferDataAdapter>
+        AssetAnimation(const fastgltf::Asset &asset, const fastgltf::Animation &animation, const BufferDataAdapter &adapter = {}) {
+            samplers.reserve(animation.samplers.size());
+            for (const fastgltf::AnimationSampler &sampler : animation.samplers) {
+                // Sampler's output type is determined by the channel that references it.
+                const std::size_t samplerIndex = &sampler - animation.samplers.data();
+                const auto it = std::ranges::find(animation.channels, samplerIndex, &fastgltf::AnimationChannel::samplerIndex);
+                samplers.push_back(createSampler(asset, sampler, it == animation.channels.end() ? fastgltf::AnimationPath::Translation : it->path, adapter));
+                if (!samplers.back().inputs.empty()) {
+                    duration = std::max(duration, samplers.back().inputs.back());
+                }
+            }
+
+            for (const fastgltf::AnimationChannel &channel : animation.channels) {
+                // Channels without target node or keyframes have no effect.
+                if (!channel.nodeIndex || samplers[channel.samplerIndex].inputs.empty()) continue;
+
+                // Skip the malformed channel whose sampler output doesn't match to the target path.
+                const std::size_t requiredComponentCount = [&]() -> std::size_t {
+                    switch (channel.path) {
+                        case fastgltf::AnimationPath::Translation: case fastgltf::AnimationPath::Scale: return 3;
+                        case fastgltf::AnimationPath::Rotation: return 4;
+                        case fastgltf::AnimationPath::Weights: return 1;
+                    }
+                    std::unreachable();
+                }();
+                if (samplers[channel.samplerIndex].componentCount < requiredComponentCount) continue;
+
+                channels.emplace_back(channel.samplerIndex, *channel.nodeIndex, channel.path);
+                if (channel.path == fastgltf::AnimationPath::Weights) {
+                    morphedNodeIndices.push_back(*channel.nodeIndex);
+                }
+                else {
+                    transformedNodeIndices.push_back(*channel.nodeIndex);
+                }
+            }
+
+            for (std::vector<std::size_t> *nodeIndices : { &transformedNodeIndices, &morphedNodeIndices }) {
+                std::ranges::sort(*nodeIndices);
+                const auto [begin, end] = std::ranges::unique(*nodeIndices);
+                nodeIndices->erase(begin, end);
+            }
+        }
+
+        /**
+         * @brief Get indices of the nodes whose local transform is animated, in ascending order.
+         * @return Span of the node indices.
+         */
+        [[nodiscard]] std::span<const std::size_t> getTransformedNodeIndices() const noexcept {
+            return transformedNodeIndices;
+        }
+
+        /**
+         * @brief Get indices of the nodes whose morph target weights are animated, in ascending order.
+         * @return Span of the node indices.
+         */
+        [[nodiscard]] std::span<const std::size_t> getMorphedNodeIndices() const noexcept {
+            return morphedNodeIndices;
+        }
+
+        /**
+         * @brief Sample the animation at \p time, and write the results into the target nodes of \p asset.
+         *
+         * Samplers are evaluated in parallel if there are many, and the results are written into the nodes serially. If
+         * an animated node's local transform is represented by matrix, it is decomposed into TRS.
+         *
+         * @param time Time in seconds. Values outside <tt>[0, duration]</tt> are clamped to the first/last keyframes.
+         * @param asset Asset to be written. Its nodes must be the ones used at the construction.
+         * @param threadPool Thread pool for the sampler evaluation.
+         */
+        void update(float time, fastgltf::Asset &asset, BS::thread_pool &threadPool) {
+            if (samplers.size() >= PARALLEL_SAMPLER_THRESHOLD) {
+                threadPool.submit_loop(std::size_t { 0 }, samplers.size(), [&](std::size_t i) {
+                    samplers[i].sample(time);
+                }).get();
+            }
+            else {
+                for (Sampler &sampler : samplers) {
+                    sampler.sample(time);
+                }
+            }
+
+            for (const Channel &channel : channels) {
+                const std::span<const float> value = samplers[channel.samplerIndex].value;
+                fastgltf::Node &node = asset.nodes[channel.nodeIndex];
+
+                if (channel.path == fastgltf::AnimationPath::Weights) {
+                    node.weights.assign(value.begin(), value.end());
+                    continue;
+                }
+
+                fastgltf::TRS *trs = get_if<fastgltf::TRS>(&node.transform);
+                if (!trs) {
+                    fastgltf::TRS decomposed;
+                    decomposeTransformMatrix(get<fastgltf::math::fmat4x4>(node.transform), decomposed.scale, decomposed.rotation, decomposed.translation);
+                    trs = &node.transform.emplace<fastgltf::TRS>(decomposed);
+                }
+
+                switch (channel.path) {
+                    case fastgltf::AnimationPath::Translation:
+                        trs->translation = fastgltf::math::fvec3 { value[0], value[1], value[2] };
+                        break;
+                    case fastgltf::AnimationPath::Rotation:
+                        trs->rotation = fastgltf::math::fquat { value[0], value[1], value[2], value[3] };
+                        break;
+                    case fastgltf::AnimationPath::Scale:
+                        trs->scale = fastgltf::math::fvec3 { value[0], value[1], value[2] };
+                        break;
+                    default:
+                        std::unreachable();
+                }
+            }
+        }
+
+    private:
+        /**
+         * @brief Minimum sampler count to evaluate the samplers in parallel. Sampling a single keyframe is too cheap to be worth the task submission.
+         */
+        static constexpr std::size_t PARALLEL_SAMPLER_THRESHOLD = 256;
+
+        struct Sampler {
+            std::vector<float> inputs;
+
+            /**
+             * @brief Flattened keyframe values. For CUBICSPLINE interpolation, each keyframe consists of (in-tangent, value, out-tangent).
+             */
+            std::vector<float> outputs;
+
+            /**
+             * @brief Number of floats per keyframe value, e.g. 3 for translation and 4 for rotation.
+             */
+            std::size_t componentCount;
+
+            fastgltf::AnimationInterpolation interpolation;
+            bool isRotation;
+
+            /**
+             * @brief Index of the keyframe that starts the last evaluated interval.
+             */
+            std::size_t cursor = 0;
+
+            /**
+             * @brief Last sampled value, whose size is <tt>componentCount</tt>.
+             */
+            std::vector<float> value;
+
+            void sample(float time) noexcept {
+                if (inputs.empty()) return;
+
+                if (inputs.size() == 1 || time <= inputs.front()) {
+                    std::ranges::copy(getKeyframeValue(0), value.begin());
+                    return;
+                }
+                if (time >= inputs.back()) {
+                    std::ranges::copy(getKeyframeValue(inputs.size() - 1), value.begin());
+                    return;
+                }
+
+                // Rewind the cursor only if the time goes backward (e.g. loop or scrub).
+                if (time < inputs[cursor]) {
+                    cursor = 0;
+                }
+                // inputs.front() < time < inputs.back(), therefore the loop never exceeds the last keyframe.
+                while (inputs[cursor + 1] <= time) {
+                    ++cursor;
+                }
+
+                const float delta = inputs[cursor + 1] - inputs[cursor];
+                const float t = (time - inputs[cursor]) / delta;
+                const std::span v0 = getKeyframeValue(cursor);
+                const std::span v1 = getKeyframeValue(cursor + 1);
+
+                switch (interpolation) {
+                    case fastgltf::AnimationInterpolation::Step:
+                        std::ranges::copy(v0, value.begin());
+                        break;
+                    case fastgltf::AnimationInterpolation::Linear:
+                        if (isRotation) {
+                            slerp(v0, v1, t);
+                        }
+                        else {
+                            for (std::size_t i = 0; i < componentCount; ++i) {
+                                value[i] = std::lerp(v0[i], v1[i], t);
+                            }
+                        }
+                        break;
+                    case fastgltf::AnimationInterpolation::CubicSpline: {
+                        // glTF specification, Appendix C: Interpolation, Cubic Spline Interpolation.
+                        const std::span b0 = std::span { outputs }.subspan((3 * cursor + 2) * componentCount, componentCount);
+                        const std::span a1 = std::span { outputs }.subspan((3 * cursor + 3) * componentCount, componentCount);
+                        const float t2 = t * t, t3 = t2 * t;
+                        const float h00 = 2.f * t3 - 3.f * t2 + 1.f;
+                        const float h10 = delta * (t3 - 2.f * t2 + t);
+                        const float h01 = -2.f * t3 + 3.f * t2;
+                        const float h11 = delta * (t3 - t2);
+                        for (std::size_t i = 0; i < componentCount; ++i) {
+                            value[i] = h00 * v0[i] + h10 * b0[i] + h01 * v1[i] + h11 * a1[i];
+                        }
+                        if (isRotation) {
+                            normalizeValue();
+                        }
+                        break;
+                    }
+                }
+            }
+
+            [[nodiscard]] std::span<const float> getKeyframeValue(std::size_t keyframeIndex) const noexcept {
+                const std::size_t elementIndex = interpolation == fastgltf::AnimationInterpolation::CubicSpline ? 3 * keyframeIndex + 1 : keyframeIndex;
+                return std::span { outputs }.subspan(elementIndex * componentCount, componentCount);
+            }
+
+            void slerp(std::span<const float> q0, std::span<const float> q1, float t) noexcept {
+                float cosTheta = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+
+                // Take the shortest path.
+                const float sign = cosTheta < 0.f ? -1.f : 1.f;
+                cosTheta *= sign;
+
+                float w0 = 1.f - t, w1 = t;
+                // If two quaternions are too close, fallback to the normalized linear interpolation.
+                if (cosTheta < 0.9995f) {
+                    const float theta = std::acos(cosTheta);
+                    const float sinTheta = std::sin(theta);
+                    w0 = std::sin((1.f - t) * theta) / sinTheta;
+                    w1 = std::sin(t * theta) / sinTheta;
+                }
+                for (std::size_t i = 0; i < 4; ++i) {
+                    value[i] = w0 * q0[i] + sign * w1 * q1[i];
+                }
+                normalizeValue();
+            }
+
+            void normalizeValue() noexcept {
+                const float length = std::sqrt(value[0] * value[0] + value[1] * value[1] + value[2] * value[2] + value[3] * value[3]);
+                if (length > 0.f) {
+                    for (float &component : value) {
+                        component /= length;
+                    }
+                }
+            }
+        };
+
+        struct Channel {
+            std::size_t samplerIndex;
+            std::size_t nodeIndex;
+            fastgltf::AnimationPath path;
+        };
+
+        std::vector<Sampler> samplers;
+        std::vector<Channel> channels;
+        std::vector<std::size_t> transformedNodeIndices;
+        std::vector<std::size_t> morphedNodeIndices;
+
+        template <typename BufferDataAdapter>
+        [[nodiscard]] static Sampler createSampler(
+            const fastgltf::Asset &asset,
+            const fastgltf::AnimationSampler &sampler,
+            fastgltf::AnimationPath path,
+            const BufferDataAdapter &adapter
+        ) {
+            const fastgltf::Accessor &inputAccessor = asset.accessors[sampler.inputAccessor];
+            const fastgltf::Accessor &outputAccessor = asset.accessors[sampler.outputAccessor];
+
+            Sampler result {
+                .inputs = std::vector<float>(inputAccessor.count),
+                .outputs = std::vector<float>(outputAccessor.count * getNumComponents(outputAccessor.type)),
+                .componentCount = 0,
+                .interpolation = sampler.interpolation,
+                .isRotation = path == fastgltf::AnimationPath::Rotation,
+            };
+            if (result.inputs.empty()) return result;
+
+            fastgltf::copyFromAccessor<float>(asset, inputAccessor, result.inputs.data(), adapter);
+            switch (outputAccessor.type) {
+                case fastgltf::AccessorType::Scalar:
+                    fastgltf::copyFromAccessor<float>(asset, outputAccessor, result.outputs.data(), adapter);
+                    break;
+                case fastgltf::AccessorType::Vec3:
+                    fastgltf::copyFromAccessor<fastgltf::math::fvec3>(asset, outputAccessor, result.outputs.data(), adapter);
+                    break;
+                case fastgltf::AccessorType::Vec4:
+                    fastgltf::copyFromAccessor<fastgltf::math::fvec4>(asset, outputAccessor, result.outputs.data(), adapter);
+                    break;
+                default:
+                    // glTF specification restricts the animation sampler output type to SCALAR, VEC3 and VEC4.
+                    throw AssetProcessError::InvalidAnimationSamplerOutputType;
+            }
+
+            // Dequantize the normalized integer outputs (rotation and weights can be quantized).
+            if (outputAccessor.normalized) {
+                const float divisor = [&]() {
+                    switch (outputAccessor.componentType) {
+                        case fastgltf::ComponentType::Byte: return 127.f;
+                        case fastgltf::ComponentType::UnsignedByte: return 255.f;
+                        case fastgltf::ComponentType::Short: return 32767.f;
+                        case fastgltf::ComponentType::UnsignedShort: return 65535.f;
+                        default: return 1.f;
+                    }
+                }();
+                for (float &component : result.outputs) {
+                    component = std::max(component / divisor, -1.f);
+                }
+            }
+
+            // Weights output has (morph target count) scalars per keyframe.
+            const std::size_t elementCount = result.interpolation == fastgltf::AnimationInterpolation::CubicSpline ? 3 * result.inputs.size() : result.inputs.size();
+            result.componentCount = result.outputs.size() / elementCount;
+            result.value.resize(result.componentCount);
+            return result;
+        }
+    };
+}
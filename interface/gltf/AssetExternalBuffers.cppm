@@ -2,11 +2,13 @@ module;
 
 #include <cerrno>
 #include <cstring>
+#include <meshoptimizer.h>
 
 export module vk_gltf_viewer:gltf.AssetExternalBuffers;
 
 import std;
 export import fastgltf;
+export import thread_pool;
 export import :gltf.AssetProcessError;
 
 namespace vk_gltf_viewer::gltf {
@@ -15,15 +17,21 @@ namespace vk_gltf_viewer::gltf {
      *
      * This loads the external and GLB buffers at construction, and organize them into <tt>std::span<const std::byte></tt> by their indices. Since this operation done in the initialization, you don't have to make branches for <tt>fastgltf::DataSource</tt> variant type.
      *
+     * Buffer views that are compressed by <tt>EXT_meshopt_compression</tt> are decoded at the construction in parallel, and
+     * their decoded bytes are returned instead of the (fallback) buffer data. Therefore, the consumers don't have to care
+     * about whether the buffer view is compressed or not.
+     *
      * Also, this class implements <tt>const std::byte* operator(const fastgltf::Asset&, std::size_t) const</tt> for compatibility with <tt>fastgltf::DefaultBufferDataAdapter</tt>. You can directly pass the class instance as the fastgltf's buffer data adapter, such like <tt>fastgltf::iterateAccessor</tt>.
      */
     export class AssetExternalBuffers {
         std::vector<std::unique_ptr<std::byte[]>> cache;
         std::vector<std::span<const std::byte>> bytes;
+        std::vector<std::span<const std::byte>> bufferViewBytes;
 
     public:
-        AssetExternalBuffers(const fastgltf::Asset &asset, const std::filesystem::path &directory)
-            : bytes { createBufferBytes(asset, directory) } { }
+        AssetExternalBuffers(const fastgltf::Asset &asset, const std::filesystem::path &directory, BS::thread_pool &threadPool)
+            : bytes { createBufferBytes(asset, directory) }
+            , bufferViewBytes { createBufferViewBytes(asset, threadPool) } { }
 
         /**
          * Interface for <tt>fastgltf::BufferDataAdapter</tt>.
@@ -32,8 +40,7 @@ namespace vk_gltf_viewer::gltf {
          * @return First byte address of the buffer.
          */
         [[nodiscard]] std::span<const std::byte> operator()(const fastgltf::Asset &asset, std::size_t bufferViewIndex) const {
-            const fastgltf::BufferView &bufferView = asset.bufferViews[bufferViewIndex];
-            return bytes[bufferView.bufferIndex].subspan(bufferView.byteOffset, bufferView.byteLength);
+            return bufferViewBytes[bufferViewIndex];
         }
 
     private:
@@ -69,6 +76,10 @@ namespace vk_gltf_viewer::gltf {
 
                             return { data.get(), dataSize };
                         },
+                        // Buffer that is only referenced by EXT_meshopt_compression buffer views and has no data.
+                        [](const fastgltf::sources::Fallback&) -> std::span<const std::byte> {
+                            return {};
+                        },
                         // Note: fastgltf::source::{BufferView,Vector} should not be handled since they are not used
                         // for fastgltf::Buffer::data.
                         [](const auto&) -> std::span<const std::byte> {
@@ -78,5 +89,74 @@ namespace vk_gltf_viewer::gltf {
                 })
                 | std::ranges::to<std::vector>();
         }
+
+        [[nodiscard]] std::vector<std::span<const std::byte>> createBufferViewBytes(
+            const fastgltf::Asset &asset,
+            BS::thread_pool &threadPool
+        ) {
+            std::vector<std::span<const std::byte>> result;
+            result.reserve(asset.bufferViews.size());
+
+            std::vector<std::size_t> compressedBufferViewIndices;
+            for (const auto &[bufferViewIndex, bufferView] : asset.bufferViews | std::views::enumerate) {
+                if (bufferView.meshoptCompression) {
+                    // Decoded data will be written to the cache, and the span will be assigned after the decoding.
+                    compressedBufferViewIndices.push_back(bufferViewIndex);
+                    result.emplace_back();
+                }
+                else {
+                    result.push_back(bytes[bufferView.bufferIndex].subspan(bufferView.byteOffset, bufferView.byteLength));
+                }
+            }
+
+            if (compressedBufferViewIndices.empty()) {
+                return result;
+            }
+
+            // Allocate the decoding destinations in the main thread, since cache is not thread-safe.
+            const std::size_t decodedCacheOffset = cache.size();
+            for (std::size_t bufferViewIndex : compressedBufferViewIndices) {
+                const fastgltf::CompressedBufferView &compression = *asset.bufferViews[bufferViewIndex].meshoptCompression;
+                const std::size_t decodedSize = compression.count * compression.byteStride;
+                result[bufferViewIndex] = { cache.emplace_back(std::make_unique<std::byte[]>(decodedSize)).get(), decodedSize };
+            }
+
+            threadPool.submit_loop(std::size_t { 0 }, compressedBufferViewIndices.size(), [&](std::size_t i) {
+                const fastgltf::CompressedBufferView &compression = *asset.bufferViews[compressedBufferViewIndices[i]].meshoptCompression;
+                const std::span source = bytes[compression.bufferIndex].subspan(compression.byteOffset, compression.byteLength);
+                const auto* const sourceData = reinterpret_cast<const unsigned char*>(source.data());
+                std::byte* const destination = cache[decodedCacheOffset + i].get();
+
+                const int decodeResult = [&]() {
+                    switch (compression.mode) {
+                        case fastgltf::MeshoptCompressionMode::Attributes:
+                            return meshopt_decodeVertexBuffer(destination, compression.count, compression.byteStride, sourceData, source.size());
+                        case fastgltf::MeshoptCompressionMode::Triangles:
+                            return meshopt_decodeIndexBuffer(destination, compression.count, compression.byteStride, sourceData, source.size());
+                        case fastgltf::MeshoptCompressionMode::Indices:
+                            return meshopt_decodeIndexSequence(destination, compression.count, compression.byteStride, sourceData, source.size());
+                    }
+                    std::unreachable();
+                }();
+                if (decodeResult != 0) throw AssetProcessError::MeshoptDecompressionFailure;
+
+                // Filters are only applicable to the attributes mode, and applied in-place to the decoded data.
+                switch (compression.filter) {
+                    case fastgltf::MeshoptCompressionFilter::None:
+                        break;
+                    case fastgltf::MeshoptCompressionFilter::Octahedral:
+                        meshopt_decodeFilterOct(destination, compression.count, compression.byteStride);
+                        break;
+                    case fastgltf::MeshoptCompressionFilter::Quaternion:
+                        meshopt_decodeFilterQuat(destination, compression.count, compression.byteStride);
+                        break;
+                    case fastgltf::MeshoptCompressionFilter::Exponential:
+                        meshopt_decodeFilterExp(destination, compression.count, compression.byteStride);
+                        break;
+                }
+            }).get();
+
+            return result;
+        }
     };
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 module;
 
 #include <cassert>
+#include <cstring>
 #include <mikktspace.h>
 
 export module vk_gltf_viewer:gltf.AssetGpuBuffers;
@@ -14,6 +15,7 @@ export import :gltf.AssetProcessError;
 import :helpers.functional;
 import :helpers.ranges;
 import :helpers.type_map;
+import :math.octahedral;
 export import :vulkan.Gpu;
 
 /**
@@ -42,6 +44,7 @@ template <std::integral T>
  * @param allocator VMA allocator to allocate the staging buffer.
  * @param segments Range of data segments. Each segment will be converted to <tt>std::span<const std::byte></tt>, therefore segment's elements must be trivially copyable.
  * @param usage Usage flags of the result buffer.
+ * @param segmentAlignment Alignment of each segments' start offset, which must be power of 2. Padding bytes are left uninitialized.
  * @return Pair of staging buffer and each segments' start offsets vector.
  */
 template <std::ranges::random_access_range R>
@@ -49,21 +52,21 @@ template <std::ranges::random_access_range R>
 [[nodiscard]] std::pair<vku::AllocatedBuffer, std::vector<vk::DeviceSize>> createCombinedStagingBuffer(
     vma::Allocator allocator,
     R &&segments,
-    vk::BufferUsageFlags usage
+    vk::BufferUsageFlags usage,
+    vk::DeviceSize segmentAlignment = 1
 ) {
     if constexpr (std::convertible_to<std::ranges::range_value_t<R>, std::span<const std::byte>>) {
         assert(!segments.empty() && "Empty segments not allowed (Vulkan requires non-zero buffer size)");
 
         // Calculate each segments' copy destination offsets.
-        std::vector copyOffsets
-            = segments
-            | std::views::transform([](std::span<const std::byte> segment) -> vk::DeviceSize {
-                return segment.size_bytes();
-            })
-            | std::ranges::to<std::vector>();
-        vk::DeviceSize sizeTotal = copyOffsets.back();
-        std::exclusive_scan(copyOffsets.begin(), copyOffsets.end(), copyOffsets.begin(), vk::DeviceSize { 0 });
-        sizeTotal += copyOffsets.back();
+        std::vector<vk::DeviceSize> copyOffsets;
+        copyOffsets.reserve(segments.size());
+        vk::DeviceSize sizeTotal = 0;
+        for (std::span<const std::byte> segment : segments) {
+            sizeTotal = (sizeTotal + segmentAlignment - 1) & ~(segmentAlignment - 1);
+            copyOffsets.push_back(sizeTotal);
+            sizeTotal += segment.size_bytes();
+        }
 
         // Create staging buffer and copy segments into it.
         vku::MappedBuffer stagingBuffer { allocator, vk::BufferCreateInfo { {}, sizeTotal, usage } };
@@ -77,7 +80,7 @@ template <std::ranges::random_access_range R>
     else {
         // Retry with converting each segments into the std::span<const std::byte>.
         const auto byteSegments = segments | std::views::transform([](const auto &segment) { return as_bytes(std::span { segment }); });
-        return createCombinedStagingBuffer(allocator, byteSegments, usage);
+        return createCombinedStagingBuffer(allocator, byteSegments, usage, segmentAlignment);
     }
 }
 
@@ -91,6 +94,21 @@ namespace vk_gltf_viewer::gltf {
         const fastgltf::Asset &asset;
         const vulkan::Gpu &gpu;
 
+        /**
+         * @brief Whether the primitive attributes are repacked into a single interleaved vertex stream per primitive.
+         */
+        bool interleaveAttributes;
+
+        /**
+         * @brief Whether the float normals/tangents are encoded to 32-bit octahedral and texcoords to half floats.
+         */
+        bool compressAttributes;
+
+        struct CompressedAccessor {
+            std::vector<std::byte> bytes;
+            AssetPrimitiveInfo::ComponentType componentType;
+        };
+
         /**
          * @brief Ordered asset primitives.
          *
@@ -113,6 +131,13 @@ namespace vk_gltf_viewer::gltf {
          */
         std::vector<std::tuple<vku::AllocatedBuffer, vk::Buffer, vk::BufferCopy>> stagingInfos;
 
+        /**
+         * @brief Offsets of each node's deformed primitives in <tt>deformedPrimitives</tt> (total <tt>asset.nodes.size() + 1</tt>).
+         *
+         * Deformed primitives of the <tt>i</tt>-th node are in <tt>[offsets[i], offsets[i + 1])</tt>.
+         */
+        std::vector<std::uint32_t> nodeDeformedPrimitiveOffsets;
+
     public:
         struct GpuMaterial {
             std::uint8_t baseColorTexcoordIndex;
@@ -144,12 +169,72 @@ namespace vk_gltf_viewer::gltf {
             std::uint8_t positionByteStride;
             std::uint8_t normalByteStride;
             std::uint8_t tangentByteStride;
-            char padding[1];
+            std::uint8_t attributeEncodingFlags; // Bit 0: octahedral encoded normal, bit 1: octahedral encoded tangent.
             std::uint32_t materialIndex;
         };
 
+        /**
+         * @brief A set of four joint influences of a vertex (from a <tt>JOINTS_n</tt>/<tt>WEIGHTS_n</tt> pair).
+         */
+        struct GpuSkinInfluence {
+            glm::vec4 weights;
+            glm::u16vec4 joints;
+            char padding0[8];
+        };
+
+        /**
+         * @brief Non-zero deltas of a morph target for a vertex.
+         */
+        struct GpuMorphTargetDelta {
+            glm::vec3 position;
+            std::uint32_t targetIndex;
+            glm::vec3 normal;
+            char padding0[4];
+            glm::vec3 tangent;
+            char padding1[4];
+        };
+
+        /**
+         * @brief Maximum errors of the compressed attributes compared to the original float data.
+         */
+        struct AttributeCompressionError {
+            float maxNormalAngle;   /// In radian.
+            float maxTangentAngle;  /// In radian.
+            float maxTexcoordError; /// Absolute error in UV space.
+        };
+
         std::unordered_map<const fastgltf::Primitive*, AssetPrimitiveInfo> primitiveInfos = createPrimitiveInfos();
 
+        /**
+         * @brief Attribute compression error, or <tt>std::nullopt</tt> if attributes are not compressed.
+         */
+        std::optional<AttributeCompressionError> attributeCompressionError;
+
+        /**
+         * @brief Primitive of a node whose vertices are deformed (skinned or morphed) by the node.
+         *
+         * Nodes that share a mesh may have different skins, poses and morph target weights, therefore the deformed
+         * outputs are allocated for each (node, primitive) pair.
+         */
+        struct DeformedPrimitive {
+            std::size_t nodeIndex;
+            const fastgltf::Primitive *pPrimitive;
+
+            /**
+             * @brief Index of the node specific <tt>GpuPrimitive</tt> in <tt>primitiveBuffer</tt>, which reads the deformed attributes.
+             */
+            std::uint32_t index;
+
+            AssetPrimitiveInfo::DeformedAttributeBufferInfo attributeBufferInfo;
+        };
+
+        /**
+         * @brief Deformed primitives of all nodes, ordered by node index and then by primitive index in the mesh.
+         *
+         * A primitive is deformed by a node if it has morph targets, or it has joint influences and the node has a skin.
+         */
+        std::vector<DeformedPrimitive> deformedPrimitives;
+
         /**
          * @brief Buffer that contains <tt>GpuMaterial</tt>s, with fallback material at the index 0 (total <tt>asset.materials.size() + 1</tt>).
          */
@@ -166,24 +251,38 @@ namespace vk_gltf_viewer::gltf {
 
         /**
          * @brief Buffer that contains <tt>GpuPrimitive</tt>s.
+         *
+         * First <tt>orderedPrimitives.size()</tt> entries are the asset primitives (with their original attributes),
+         * and they are followed by the node specific entries of <tt>deformedPrimitives</tt>.
          */
         vku::AllocatedBuffer primitiveBuffer = createPrimitiveBuffer();
 
+        /**
+         * @brief Buffer that contains the local space bounding sphere (center, radius) of the primitives, with the same order of <tt>primitiveBuffer</tt>.
+         *
+         * Radius is negative for the entries of <tt>deformedPrimitives</tt>, as their bounds are not known.
+         */
+        vku::AllocatedBuffer primitiveBoundingSphereBuffer = createPrimitiveBoundingSphereBuffer();
+
         template <typename BufferDataAdapter = fastgltf::DefaultBufferDataAdapter>
         AssetGpuBuffers(
             const fastgltf::Asset &asset,
             const vulkan::Gpu &gpu,
             BS::thread_pool &threadPool,
-            const BufferDataAdapter &adapter = {}
+            const BufferDataAdapter &adapter = {},
+            bool interleaveAttributes = false,
+            bool compressAttributes = false
         ) : asset { asset },
             gpu { gpu },
+            interleaveAttributes { interleaveAttributes },
+            compressAttributes { compressAttributes },
             // Ensure the order of function execution:
             // Primitive attribute buffers MUST be created before index buffer creation (because fill the AssetPrimitiveInfo
             // and determine the drawCount if primitive is non-indexed, and createIndexBuffers() will use it).
-            indexBuffers { (createPrimitiveAttributeBuffers(adapter), createPrimitiveIndexBuffers(adapter)) },
+            indexBuffers { (createPrimitiveAttributeBuffers(threadPool, adapter), createPrimitiveIndexBuffers(adapter)) },
             // Remaining buffers MUST be created before the primitive buffer creation (because they fill the
             // AssetPrimitiveInfo and createPrimitiveBuffer() will stage it).
-            primitiveBuffer { (createPrimitiveIndexedAttributeMappingBuffers(), createPrimitiveTangentBuffers(threadPool, adapter), createPrimitiveBuffer()) } {
+            primitiveBuffer { (createPrimitiveIndexedAttributeMappingBuffers(), createPrimitiveTangentBuffers(threadPool, adapter), createPrimitiveSkinningBuffers(threadPool, adapter), createPrimitiveMorphTargetBuffers(threadPool, adapter), createPrimitiveDeformedAttributeBuffers(), createPrimitiveBuffer()) } {
             if (!stagingInfos.empty()) {
                 // Transfer the asset resources into the GPU using transfer queue.
                 const vk::raii::CommandPool transferCommandPool { gpu.device, vk::CommandPoolCreateInfo { {}, gpu.queueFamilies.transfer } };
@@ -203,12 +302,39 @@ namespace vk_gltf_viewer::gltf {
          * @param index The order of the primitive.
          * @return The primitive.
          */
-        [[nodiscard]] const fastgltf::Primitive &getPrimitiveByOrder(std::uint16_t index) const { return *orderedPrimitives[index]; }
+        [[nodiscard]] const fastgltf::Primitive &getPrimitiveByOrder(std::uint32_t index) const { return *orderedPrimitives[index]; }
+
+        /**
+         * @brief Get the deformed primitives of the node.
+         * @param nodeIndex Index of the node.
+         * @return Span of the deformed primitives, empty if the node is not deformed.
+         */
+        [[nodiscard]] std::span<const DeformedPrimitive> getDeformedPrimitives(std::size_t nodeIndex) const noexcept {
+            return std::span { deformedPrimitives }.subspan(
+                nodeDeformedPrimitiveOffsets[nodeIndex],
+                nodeDeformedPrimitiveOffsets[nodeIndex + 1] - nodeDeformedPrimitiveOffsets[nodeIndex]);
+        }
+
+        /**
+         * @brief Get the index of the <tt>GpuPrimitive</tt> in <tt>primitiveBuffer</tt> that has to be used when rendering \p primitive of the \p nodeIndex-th node.
+         * @param nodeIndex Index of the node.
+         * @param primitive Primitive of the node's mesh.
+         * @return Index of the node specific entry if the primitive is deformed by the node, otherwise <tt>AssetPrimitiveInfo::index</tt>.
+         */
+        [[nodiscard]] std::uint32_t getPrimitiveIndex(std::size_t nodeIndex, const fastgltf::Primitive &primitive) const {
+            for (const DeformedPrimitive &deformedPrimitive : getDeformedPrimitives(nodeIndex)) {
+                if (deformedPrimitive.pPrimitive == &primitive) {
+                    return deformedPrimitive.index;
+                }
+            }
+            return primitiveInfos.at(&primitive).index;
+        }
 
     private:
         [[nodiscard]] std::vector<const fastgltf::Primitive*> createOrderedPrimitives() const;
         [[nodiscard]] std::unordered_map<const fastgltf::Primitive*, AssetPrimitiveInfo> createPrimitiveInfos() const;
         [[nodiscard]] vku::AllocatedBuffer createMaterialBuffer();
+        [[nodiscard]] vku::AllocatedBuffer createPrimitiveBoundingSphereBuffer();
 
         template <typename BufferDataAdapter>
         [[nodiscard]] std::unordered_map<vk::IndexType, vku::AllocatedBuffer> createPrimitiveIndexBuffers(const BufferDataAdapter &adapter) {
@@ -330,27 +456,87 @@ namespace vk_gltf_viewer::gltf {
 
         [[nodiscard]] vku::AllocatedBuffer createPrimitiveBuffer();
 
-        template <typename DataBufferAdapter>
-        void createPrimitiveAttributeBuffers(const DataBufferAdapter &adapter) {
+        /**
+         * @brief Parse the index of the indexed attribute (e.g. 2 for <tt>TEXCOORD_2</tt>).
+         * @param attributeName Attribute name.
+         * @param prefix Prefix of the attribute name, including the trailing underscore.
+         * @return Index of the attribute.
+         * @throw fastgltf::Error::InvalidOrMissingAssetField If the string after the prefix is not a number.
+         */
+        [[nodiscard]] static std::size_t parseAttributeIndex(std::string_view attributeName, std::string_view prefix) {
+            if (auto result = parse<std::size_t>(attributeName.substr(prefix.size()))) {
+                return *result;
+            }
+
+            // Attribute name starting with the prefix, but the following string is not a number.
+            // TODO: would it be filtered by the glTF validation?
+            throw fastgltf::Error::InvalidOrMissingAssetField;
+        }
+
+        /**
+         * @brief Check if the attribute is only consumed by the skinning (<tt>JOINTS_n</tt> or <tt>WEIGHTS_n</tt>).
+         *
+         * These attributes are not staged as is, but packed by createPrimitiveSkinningBuffers().
+         *
+         * @param attributeName Attribute name.
+         * @return <tt>true</tt> if the attribute is a skinning attribute, <tt>false</tt> otherwise.
+         */
+        [[nodiscard]] static bool isSkinningAttribute(std::string_view attributeName) noexcept {
+            using namespace std::string_view_literals;
+            return attributeName.starts_with("JOINTS_"sv) || attributeName.starts_with("WEIGHTS_"sv);
+        }
+
+        template <typename BufferDataAdapter>
+        void createPrimitiveAttributeBuffers(BS::thread_pool &threadPool, const BufferDataAdapter &adapter) {
             const auto primitives = asset.meshes | std::views::transform(&fastgltf::Mesh::primitives) | std::views::join;
 
-            // Get buffer view indices that are used in primitive attributes.
-            const std::unordered_set attributeBufferViewIndices
+            // Get accessor indices that are used in primitive attributes.
+            const std::unordered_set attributeAccessorIndices
                 = primitives
-                | std::views::transform([](const fastgltf::Primitive &primitive) {
-                    return primitive.attributes | std::views::transform(&fastgltf::Attribute::accessorIndex);
+                | std::views::transform([&](const fastgltf::Primitive &primitive) {
+                    return primitive.attributes
+                        | std::views::filter([](const fastgltf::Attribute &attribute) { return !isSkinningAttribute(attribute.name); })
+                        | std::views::transform([&](const fastgltf::Attribute &attribute) {
+                        // Check accessor validity.
+                        // glTF Specification:
+                        // COLOR_n accessor could be unsigned byte/short normalized, and it would be handled in the shader.
+                        using namespace std::string_view_literals;
+                        if (!attribute.name.starts_with("COLOR_"sv) && asset.accessors[attribute.accessorIndex].normalized) {
+                            throw AssetProcessError::NormalizedAttributeBufferAccessor;
+                        }
+
+                        return attribute.accessorIndex;
+                    });
                 })
                 | std::views::join
-                | std::views::transform([&](std::size_t accessorIndex) {
-                    const fastgltf::Accessor &accessor = asset.accessors[accessorIndex];
+                | std::ranges::to<std::unordered_set>();
 
-                    // Check accessor validity.
-                    if (accessor.sparse) throw AssetProcessError::SparseAttributeBufferAccessor;
-                    if (accessor.normalized) throw AssetProcessError::NormalizedAttributeBufferAccessor;
+            // Compressed accessors are staged from their encoded data instead of the buffer view.
+            const std::unordered_map compressedAccessors = compressAttributes
+                ? compressAttributeAccessors(threadPool, adapter)
+                : std::unordered_map<std::size_t, CompressedAccessor>{};
 
-                    return *accessor.bufferViewIndex;
-                })
-                | std::ranges::to<std::unordered_set>();
+            if (interleaveAttributes) {
+                createInterleavedPrimitiveAttributeBuffers(threadPool, adapter, compressedAccessors);
+                return;
+            }
+
+            // Non-sparse accessors directly use their buffer view data, therefore only buffer view indices are collected.
+            // Sparse accessors cannot be represented by a single buffer view region, and have to be densified.
+            std::unordered_set<std::size_t> attributeBufferViewIndices;
+            std::vector<std::size_t> sparseAccessorIndices;
+            for (std::size_t accessorIndex : attributeAccessorIndices) {
+                const fastgltf::Accessor &accessor = asset.accessors[accessorIndex];
+                if (compressedAccessors.contains(accessorIndex)) {
+                    continue;
+                }
+                else if (accessor.sparse) {
+                    sparseAccessorIndices.push_back(accessorIndex);
+                }
+                else {
+                    attributeBufferViewIndices.emplace(*accessor.bufferViewIndex);
+                }
+            }
 
             // Make an ordered sequence of (bufferViewIndex, bufferViewBytes) pairs.
             const std::vector attributeBufferViewBytes
@@ -360,12 +546,27 @@ namespace vk_gltf_viewer::gltf {
                 })
                 | std::ranges::to<std::vector>();
 
+            // Densify the sparse accessors into the tightly packed data (in parallel).
+            std::vector<std::vector<std::byte>> densifiedSparseAccessorBytes(sparseAccessorIndices.size());
+            threadPool.submit_loop(std::size_t { 0 }, sparseAccessorIndices.size(), [&](std::size_t i) {
+                densifiedSparseAccessorBytes[i] = densifySparseAccessor(asset.accessors[sparseAccessorIndices[i]], adapter);
+            }).get();
+
             auto [buffer, copyOffsets] = createCombinedStagingBuffer(
                 gpu.allocator,
-                attributeBufferViewBytes | std::views::values,
+                ranges::views::concat(
+                    attributeBufferViewBytes | std::views::values,
+                    densifiedSparseAccessorBytes | std::views::transform([](std::span<const std::byte> bytes) { return bytes; }),
+                    compressedAccessors | std::views::transform([](const auto &pair) { return std::span<const std::byte> { pair.second.bytes }; }))
+                    | std::ranges::to<std::vector>(),
                 gpu.isUmaDevice
                     ? vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress
-                    : vk::BufferUsageFlagBits::eTransferSrc);
+                    : vk::BufferUsageFlagBits::eTransferSrc,
+                // glTF Specification:
+                // For performance and compatibility reasons, each element of a vertex attribute MUST be aligned to
+                // 4-byte boundaries inside a bufferView.
+                // Densified and compressed segments must keep the same alignment for the buffer device address access.
+                4);
 
             if (!gpu.isUmaDevice && !vku::contains(gpu.allocator.getAllocationMemoryProperties(buffer.allocation), vk::MemoryPropertyFlagBits::eDeviceLocal)) {
                 vku::AllocatedBuffer dstBuffer { gpu.allocator, vk::BufferCreateInfo {
@@ -380,28 +581,308 @@ namespace vk_gltf_viewer::gltf {
                 buffer = std::move(dstBuffer);
             }
 
+            const auto deviceAddresses = copyOffsets | std::views::transform([baseAddress = gpu.device.getBufferAddress({ buffer })](vk::DeviceSize offset) {
+                return baseAddress + offset;
+            });
+
             // Hashmap that can get buffer device address by corresponding buffer view index.
             const std::unordered_map bufferDeviceAddressMappings
+                = std::views::zip(attributeBufferViewBytes | std::views::keys, deviceAddresses)
+                | std::ranges::to<std::unordered_map>();
+
+            // Hashmap that can get buffer device address by corresponding sparse accessor index.
+            const std::unordered_map sparseAccessorDeviceAddressMappings
+                = std::views::zip(sparseAccessorIndices, deviceAddresses | std::views::drop(attributeBufferViewBytes.size()))
+                | std::ranges::to<std::unordered_map>();
+
+            // Hashmap that can get buffer device address by corresponding compressed accessor index.
+            const std::unordered_map compressedAccessorDeviceAddressMappings
                 = std::views::zip(
-                    attributeBufferViewBytes | std::views::keys,
-                    copyOffsets | std::views::transform([baseAddress = gpu.device.getBufferAddress({ buffer })](vk::DeviceSize offset) {
-                        return baseAddress + offset;
-                    }))
+                    compressedAccessors | std::views::keys,
+                    deviceAddresses | std::views::drop(attributeBufferViewBytes.size() + sparseAccessorIndices.size()))
+                | std::ranges::to<std::unordered_map>();
+
+            setPrimitiveAttributeInfos([&](const fastgltf::Primitive*, std::size_t accessorIndex) -> AssetPrimitiveInfo::AttributeBufferInfo {
+                const fastgltf::Accessor &accessor = asset.accessors[accessorIndex];
+                if (auto it = compressedAccessors.find(accessorIndex); it != compressedAccessors.end()) {
+                    // Encoded data is tightly packed 32-bit integers.
+                    return {
+                        .address = compressedAccessorDeviceAddressMappings.at(accessorIndex),
+                        .byteStride = 4,
+                        .componentType = it->second.componentType,
+                    };
+                }
+                if (accessor.sparse) {
+                    // Densified data is tightly packed.
+                    return {
+                        .address = sparseAccessorDeviceAddressMappings.at(accessorIndex),
+                        .byteStride = static_cast<std::uint8_t>(getElementByteSize(accessor.type, accessor.componentType)),
+                    };
+                }
+
+                const std::size_t byteStride
+                    = asset.bufferViews[*accessor.bufferViewIndex].byteStride
+                    .value_or(getElementByteSize(accessor.type, accessor.componentType));
+                if (!std::in_range<std::uint8_t>(byteStride)) throw AssetProcessError::TooLargeAccessorByteStride;
+                return {
+                    .address = bufferDeviceAddressMappings.at(*accessor.bufferViewIndex) + accessor.byteOffset,
+                    .byteStride = static_cast<std::uint8_t>(byteStride),
+                };
+            });
+
+            internalBuffers.emplace_back(std::move(buffer));
+        }
+
+        /**
+         * @brief Encode the float <tt>NORMAL</tt>, <tt>TANGENT</tt> (into 32-bit octahedral) and <tt>TEXCOORD_<i></tt>
+         * (into two 16-bit floats) accessors that are used by the primitives (in parallel), and record the maximum
+         * encoding error into <tt>attributeCompressionError</tt>.
+         *
+         * Accessor that is used by the attributes of different semantics, or by any other attribute (e.g.
+         * <tt>POSITION</tt>, <tt>COLOR_<i></tt> or application specific one), is not encoded.
+         *
+         * @param threadPool Thread pool that is used for the parallel encoding.
+         * @param adapter Buffer data adapter.
+         * @return Hashmap of (accessor index, encoded accessor) pairs.
+         */
+        template <typename BufferDataAdapter>
+        [[nodiscard]] std::unordered_map<std::size_t, CompressedAccessor> compressAttributeAccessors(BS::thread_pool &threadPool, const BufferDataAdapter &adapter) {
+            enum class Semantic : std::uint8_t { Normal, Tangent, Texcoord, Mixed };
+
+            std::unordered_map<std::size_t, Semantic> accessorSemantics;
+            for (const fastgltf::Primitive *pPrimitive : orderedPrimitives) {
+                for (const auto &[attributeName, accessorIndex] : pPrimitive->attributes) {
+                    if (asset.accessors[accessorIndex].componentType != fastgltf::ComponentType::Float) continue;
+
+                    using namespace std::string_view_literals;
+                    Semantic semantic;
+                    if (attributeName == "NORMAL"sv) semantic = Semantic::Normal;
+                    else if (attributeName == "TANGENT"sv) semantic = Semantic::Tangent;
+                    else if (attributeName.starts_with("TEXCOORD_"sv)) semantic = Semantic::Texcoord;
+                    // The other attributes read the accessor data as is, therefore it must not be encoded.
+                    else semantic = Semantic::Mixed;
+
+                    if (auto [it, inserted] = accessorSemantics.try_emplace(accessorIndex, semantic); !inserted && it->second != semantic) {
+                        it->second = Semantic::Mixed;
+                    }
+                }
+            }
+            std::erase_if(accessorSemantics, [](const auto &pair) { return pair.second == Semantic::Mixed; });
+
+            const std::vector targets = accessorSemantics | std::ranges::to<std::vector>();
+            std::vector<std::pair<CompressedAccessor, float /* max error */>> results(targets.size());
+            threadPool.submit_loop(std::size_t { 0 }, targets.size(), [&](std::size_t i) {
+                const auto [accessorIndex, semantic] = targets[i];
+                const fastgltf::Accessor &accessor = asset.accessors[accessorIndex];
+
+                auto &[compressed, maxError] = results[i];
+                compressed.bytes.resize(sizeof(std::uint32_t) * accessor.count);
+                const auto write = [&](std::size_t index, std::uint32_t encoded) {
+                    std::memcpy(compressed.bytes.data() + sizeof(std::uint32_t) * index, &encoded, sizeof(std::uint32_t));
+                };
+
+                // Degenerate (zero length) vectors exist in real assets, and normalizing them makes NaN, which would
+                // be encoded into garbage. They are encoded as +Z instead.
+                const auto safeNormalize = [](const glm::vec3 &v) {
+                    const float length = glm::length(v);
+                    return length > 1e-20f ? v / length : glm::vec3 { 0.f, 0.f, 1.f };
+                };
+
+                switch (semantic) {
+                    case Semantic::Normal:
+                        compressed.componentType = AssetPrimitiveInfo::ComponentType::Octahedral;
+                        fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(asset, accessor, [&](const fastgltf::math::fvec3 &v, std::size_t index) {
+                            const glm::vec3 normal = safeNormalize(glm::make_vec3(v.data()));
+                            const std::uint32_t encoded = math::encodeOctahedralNormal(normal);
+                            write(index, encoded);
+
+                            // Angle error (in radian).
+                            maxError = std::max(maxError, std::acos(std::clamp(glm::dot(normal, math::decodeOctahedralNormal(encoded)), -1.f, 1.f)));
+                        }, adapter);
+                        break;
+                    case Semantic::Tangent:
+                        compressed.componentType = AssetPrimitiveInfo::ComponentType::Octahedral;
+                        fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec4>(asset, accessor, [&](const fastgltf::math::fvec4 &v, std::size_t index) {
+                            const glm::vec4 tangent { safeNormalize(glm::make_vec3(v.data())), v.w() };
+                            const std::uint32_t encoded = math::encodeOctahedralTangent(tangent);
+                            write(index, encoded);
+
+                            // Angle error (in radian).
+                            maxError = std::max(maxError, std::acos(std::clamp(glm::dot(glm::vec3 { tangent }, glm::vec3 { math::decodeOctahedralTangent(encoded) }), -1.f, 1.f)));
+                        }, adapter);
+                        break;
+                    case Semantic::Texcoord:
+                        compressed.componentType = AssetPrimitiveInfo::ComponentType::HalfFloat;
+                        fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec2>(asset, accessor, [&](const fastgltf::math::fvec2 &v, std::size_t index) {
+                            const glm::vec2 texcoord = glm::make_vec2(v.data());
+                            const std::uint32_t encoded = glm::packHalf2x16(texcoord);
+                            write(index, encoded);
+
+                            // Absolute error (in UV space).
+                            const glm::vec2 error = glm::abs(glm::unpackHalf2x16(encoded) - texcoord);
+                            maxError = std::max({ maxError, error.x, error.y });
+                        }, adapter);
+                        break;
+                    case Semantic::Mixed:
+                        std::unreachable();
+                }
+            }).get();
+
+            AttributeCompressionError &error = attributeCompressionError.emplace();
+            for (const auto &[target, result] : std::views::zip(targets, results)) {
+                switch (target.second) {
+                    case Semantic::Normal:
+                        error.maxNormalAngle = std::max(error.maxNormalAngle, result.second);
+                        break;
+                    case Semantic::Tangent:
+                        error.maxTangentAngle = std::max(error.maxTangentAngle, result.second);
+                        break;
+                    case Semantic::Texcoord:
+                        error.maxTexcoordError = std::max(error.maxTexcoordError, result.second);
+                        break;
+                    case Semantic::Mixed:
+                        std::unreachable();
+                }
+            }
+
+            return std::views::zip(targets | std::views::keys, results | std::views::keys | std::views::as_rvalue)
                 | std::ranges::to<std::unordered_map>();
+        }
+
+        /**
+         * @brief Repack all attributes of each primitive into a single interleaved vertex stream, and stage them.
+         *
+         * Each attribute element is placed at 4-byte aligned offset inside the vertex (as glTF vertex attribute
+         * alignment rule), therefore the resulting stream can be fetched with the same vertex pulling code.
+         *
+         * @param threadPool Thread pool that is used for the parallel repacking.
+         * @param adapter Buffer data adapter.
+         * @param compressedAccessors Encoded accessors, whose data is used instead of the original accessor data.
+         * @throw AssetProcessError::TooLargeAccessorByteStride If the interleaved vertex size cannot be represented in 8-bit unsigned integer.
+         */
+        template <typename BufferDataAdapter>
+        void createInterleavedPrimitiveAttributeBuffers(
+            BS::thread_pool &threadPool,
+            const BufferDataAdapter &adapter,
+            const std::unordered_map<std::size_t, CompressedAccessor> &compressedAccessors
+        ) {
+            struct InterleavedLayout {
+                /**
+                 * @brief Byte offset of the attribute inside a vertex, keyed by its accessor index.
+                 */
+                std::unordered_map<std::size_t, std::uint8_t> attributeOffsets;
+                std::uint8_t byteStride;
+            };
+
+            // Layout of each primitive, ordered by orderedPrimitives.
+            const std::vector layouts
+                = orderedPrimitives
+                | std::views::transform([&](const fastgltf::Primitive *pPrimitive) {
+                    InterleavedLayout layout{};
+                    std::size_t byteStride = 0;
+                    for (const fastgltf::Attribute &attribute : pPrimitive->attributes) {
+                        if (isSkinningAttribute(attribute.name) || layout.attributeOffsets.contains(attribute.accessorIndex)) continue;
+
+                        const fastgltf::Accessor &accessor = asset.accessors[attribute.accessorIndex];
+                        const std::size_t elementByteSize = compressedAccessors.contains(attribute.accessorIndex)
+                            ? 4 : getElementByteSize(accessor.type, accessor.componentType);
+                        layout.attributeOffsets.emplace(attribute.accessorIndex, static_cast<std::uint8_t>(byteStride));
+                        byteStride += (elementByteSize + 3) & ~std::size_t { 3 };
+                        if (!std::in_range<std::uint8_t>(byteStride)) throw AssetProcessError::TooLargeAccessorByteStride;
+                    }
+                    layout.byteStride = static_cast<std::uint8_t>(byteStride);
+                    return layout;
+                })
+                | std::ranges::to<std::vector>();
+
+            // Repack the attributes (in parallel).
+            std::vector<std::vector<std::byte>> interleavedBytes(orderedPrimitives.size());
+            threadPool.submit_loop(std::size_t { 0 }, orderedPrimitives.size(), [&](std::size_t primitiveIndex) {
+                const InterleavedLayout &layout = layouts[primitiveIndex];
+
+                // glTF Specification:
+                // All attribute accessors for a given primitive MUST have the same count.
+                // POSITION is not used, because it may be omitted with some extensions.
+                if (layout.attributeOffsets.empty()) return;
+                const std::size_t vertexCount = asset.accessors[layout.attributeOffsets.begin()->first].count;
+                std::vector<std::byte> &dst = interleavedBytes[primitiveIndex];
+                dst.resize(layout.byteStride * vertexCount);
+
+                for (const auto &[accessorIndex, attributeOffset] : layout.attributeOffsets) {
+                    const fastgltf::Accessor &accessor = asset.accessors[accessorIndex];
+                    std::size_t elementByteSize = getElementByteSize(accessor.type, accessor.componentType);
+
+                    std::vector<std::byte> densifiedBytes;
+                    std::span<const std::byte> srcBytes;
+                    std::size_t srcByteStride;
+                    if (auto it = compressedAccessors.find(accessorIndex); it != compressedAccessors.end()) {
+                        srcBytes = it->second.bytes;
+                        elementByteSize = srcByteStride = 4;
+                    }
+                    else if (accessor.sparse) {
+                        densifiedBytes = densifySparseAccessor(accessor, adapter);
+                        srcBytes = densifiedBytes;
+                        srcByteStride = elementByteSize;
+                    }
+                    else {
+                        srcBytes = adapter(asset, *accessor.bufferViewIndex).subspan(accessor.byteOffset);
+                        srcByteStride = asset.bufferViews[*accessor.bufferViewIndex].byteStride.value_or(elementByteSize);
+                    }
+
+                    for (std::size_t i = 0; i < vertexCount; ++i) {
+                        std::ranges::copy(
+                            srcBytes.subspan(srcByteStride * i, elementByteSize),
+                            dst.data() + layout.byteStride * i + attributeOffset);
+                    }
+                }
+            }).get();
+
+            auto [buffer, copyOffsets] = createCombinedStagingBuffer(
+                gpu.allocator,
+                interleavedBytes,
+                gpu.isUmaDevice
+                    ? vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress
+                    : vk::BufferUsageFlagBits::eTransferSrc);
+
+            if (!gpu.isUmaDevice && !vku::contains(gpu.allocator.getAllocationMemoryProperties(buffer.allocation), vk::MemoryPropertyFlagBits::eDeviceLocal)) {
+                vku::AllocatedBuffer dstBuffer { gpu.allocator, vk::BufferCreateInfo {
+                    {},
+                    buffer.size,
+                    vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                } };
+                stagingInfos.emplace_back(
+                    std::move(buffer),
+                    dstBuffer,
+                    vk::BufferCopy { 0, 0, dstBuffer.size });
+                buffer = std::move(dstBuffer);
+            }
 
-            // Iterate over the primitives and set their attribute infos.
+            setPrimitiveAttributeInfos([&, baseAddress = gpu.device.getBufferAddress({ buffer })](const fastgltf::Primitive *pPrimitive, std::size_t accessorIndex) -> AssetPrimitiveInfo::AttributeBufferInfo {
+                const std::uint32_t primitiveIndex = primitiveInfos[pPrimitive].index;
+                const InterleavedLayout &layout = layouts[primitiveIndex];
+                return {
+                    .address = baseAddress + copyOffsets[primitiveIndex] + layout.attributeOffsets.at(accessorIndex),
+                    .byteStride = layout.byteStride,
+                    .componentType = compressedAccessors.contains(accessorIndex)
+                        ? compressedAccessors.at(accessorIndex).componentType
+                        : AssetPrimitiveInfo::ComponentType::Float,
+                };
+            });
+
+            internalBuffers.emplace_back(std::move(buffer));
+        }
+
+        /**
+         * @brief Set the attribute infos (position, normal, tangent, texcoords and colors) of every primitive.
+         * @param attributeBufferInfoGetter Function that returns the buffer info of an attribute, with given primitive and its attribute accessor index.
+         */
+        template <std::invocable<const fastgltf::Primitive*, std::size_t> F>
+        void setPrimitiveAttributeInfos(const F &attributeBufferInfoGetter) {
             for (auto &[pPrimitive, primitiveInfo] : primitiveInfos) {
                 for (const auto &[attributeName, accessorIndex] : pPrimitive->attributes) {
                     const fastgltf::Accessor &accessor = asset.accessors[accessorIndex];
                     const auto getAttributeBufferInfo = [&]() -> AssetPrimitiveInfo::AttributeBufferInfo {
-                        const std::size_t byteStride
-                            = asset.bufferViews[*accessor.bufferViewIndex].byteStride
-                            .value_or(getElementByteSize(accessor.type, accessor.componentType));
-                        if (!std::in_range<std::uint8_t>(byteStride)) throw AssetProcessError::TooLargeAccessorByteStride;
-                        return {
-                            .address = bufferDeviceAddressMappings.at(*accessor.bufferViewIndex) + accessor.byteOffset,
-                            .byteStride = static_cast<std::uint8_t>(byteStride),
-                        };
+                        return attributeBufferInfoGetter(pPrimitive, accessorIndex);
                     };
 
                     using namespace std::string_view_literals;
@@ -419,26 +900,192 @@ namespace vk_gltf_viewer::gltf {
                         primitiveInfo.tangentInfo.emplace(getAttributeBufferInfo());
                     }
                     else if (constexpr auto prefix = "TEXCOORD_"sv; attributeName.starts_with(prefix)) {
-                        std::size_t index;
-                        if (auto result = parse<std::size_t>(std::string_view { attributeName }.substr(prefix.size()))) {
-                            index = *result;
-                        }
-                        else {
-                            // Attribute name starting with "TEXCOORD_", but the following string is not a number.
-                            // TODO: would it be filtered by the glTF validation?
-                            throw fastgltf::Error::InvalidOrMissingAssetField;
-                        }
-
+                        const std::size_t index = parseAttributeIndex(attributeName, prefix);
                         if (primitiveInfo.texcoordsInfo.attributeInfos.size() <= index) {
                             primitiveInfo.texcoordsInfo.attributeInfos.resize(index + 1);
                         }
                         primitiveInfo.texcoordsInfo.attributeInfos[index] = getAttributeBufferInfo();
                     }
-                    // TODO: COLOR_<i> attribute processing.
+                    else if (constexpr auto prefix = "COLOR_"sv; attributeName.starts_with(prefix)) {
+                        const std::size_t index = parseAttributeIndex(attributeName, prefix);
+                        if (primitiveInfo.colorsInfo.attributeInfos.size() <= index) {
+                            primitiveInfo.colorsInfo.attributeInfos.resize(index + 1);
+                        }
+
+                        AssetPrimitiveInfo::AttributeBufferInfo &attributeInfo = primitiveInfo.colorsInfo.attributeInfos[index];
+                        attributeInfo = getAttributeBufferInfo();
+                        attributeInfo.componentType = [&]() {
+                            switch (accessor.componentType) {
+                                case fastgltf::ComponentType::Float: return AssetPrimitiveInfo::ComponentType::Float;
+                                case fastgltf::ComponentType::UnsignedByte: return AssetPrimitiveInfo::ComponentType::UnsignedByteNormalized;
+                                case fastgltf::ComponentType::UnsignedShort: return AssetPrimitiveInfo::ComponentType::UnsignedShortNormalized;
+                                default:
+                                    // glTF Specification:
+                                    // COLOR_n accessor MUST be float, unsigned byte normalized or unsigned short normalized.
+                                    std::unreachable();
+                            }
+                        }();
+                        attributeInfo.componentCount = static_cast<std::uint8_t>(getNumComponents(accessor.type));
+                    }
                 }
             }
+        }
 
-            internalBuffers.emplace_back(std::move(buffer));
+        /**
+         * @brief Get tightly packed accessor data with its sparse substitution applied.
+         *
+         * If accessor has no buffer view, the base data is initialized with zeros (as the glTF specification says).
+         *
+         * @param accessor Sparse accessor.
+         * @param adapter Buffer data adapter.
+         * @return Densified accessor data, whose size is <tt>accessor.count * getElementByteSize(accessor.type, accessor.componentType)</tt>.
+         * @throw AssetProcessError::SparseAccessorIndexOutOfRange If any sparse index is not less than <tt>accessor.count</tt>.
+         */
+        template <typename BufferDataAdapter>
+        [[nodiscard]] std::vector<std::byte> densifySparseAccessor(const fastgltf::Accessor &accessor, const BufferDataAdapter &adapter) const {
+            const std::size_t elementByteSize = getElementByteSize(accessor.type, accessor.componentType);
+            std::vector<std::byte> result(elementByteSize * accessor.count);
+
+            // Copy the base data.
+            if (accessor.bufferViewIndex) {
+                const std::span baseBytes = adapter(asset, *accessor.bufferViewIndex).subspan(accessor.byteOffset);
+                if (const std::size_t byteStride = asset.bufferViews[*accessor.bufferViewIndex].byteStride.value_or(elementByteSize);
+                    byteStride == elementByteSize) {
+                    std::ranges::copy(baseBytes.first(result.size()), result.data());
+                }
+                else {
+                    for (std::size_t i = 0; i < accessor.count; ++i) {
+                        std::ranges::copy(baseBytes.subspan(byteStride * i, elementByteSize), result.data() + elementByteSize * i);
+                    }
+                }
+            }
+
+            // Substitute the elements at the sparse indices.
+            forEachSparseAccessorElement(accessor, [&](std::size_t index, std::span<const std::byte> valueBytes) {
+                std::ranges::copy(valueBytes, result.data() + elementByteSize * index);
+            }, adapter);
+
+            return result;
+        }
+
+        /**
+         * @brief Invoke \p f for each sparse substitution of \p accessor, in the order of the sparse indices.
+         *
+         * @param accessor Sparse accessor.
+         * @param f Function that is called with the substituted element index and its value bytes.
+         * @param adapter Buffer data adapter.
+         * @throw AssetProcessError::SparseAccessorIndexOutOfRange If any sparse index is not less than <tt>accessor.count</tt>.
+         */
+        template <typename F, typename BufferDataAdapter>
+        void forEachSparseAccessorElement(const fastgltf::Accessor &accessor, F &&f, const BufferDataAdapter &adapter) const {
+            const std::size_t elementByteSize = getElementByteSize(accessor.type, accessor.componentType);
+            const fastgltf::SparseAccessor &sparse = *accessor.sparse;
+            const std::span indicesBytes = adapter(asset, sparse.indicesBufferView).subspan(sparse.indicesByteOffset);
+            const std::span valuesBytes = adapter(asset, sparse.valuesBufferView).subspan(sparse.valuesByteOffset);
+            const auto visit = [&]<typename IndexType>(std::type_identity<IndexType>) {
+                for (std::size_t i = 0; i < sparse.count; ++i) {
+                    IndexType index;
+                    std::memcpy(&index, indicesBytes.data() + sizeof(IndexType) * i, sizeof(IndexType));
+                    if (index >= accessor.count) {
+                        throw AssetProcessError::SparseAccessorIndexOutOfRange;
+                    }
+                    f(static_cast<std::size_t>(index), valuesBytes.subspan(elementByteSize * i, elementByteSize));
+                }
+            };
+            switch (sparse.indexComponentType) {
+                case fastgltf::ComponentType::UnsignedByte:
+                    visit(std::type_identity<std::uint8_t>{});
+                    break;
+                case fastgltf::ComponentType::UnsignedShort:
+                    visit(std::type_identity<std::uint16_t>{});
+                    break;
+                case fastgltf::ComponentType::UnsignedInt:
+                    visit(std::type_identity<std::uint32_t>{});
+                    break;
+                default:
+                    // glTF Specification:
+                    // The indices component type MUST be one of the unsigned integer types.
+                    std::unreachable();
+            }
+        }
+
+        /**
+         * @brief Get the non-zero elements of a morph target attribute accessor, in the ascending order of the vertex index.
+         *
+         * Normalized integer components (allowed by <tt>KHR_mesh_quantization</tt>) are dequantized. If accessor has no
+         * buffer view, only its sparse substitutions are visited, therefore the cost is proportional to the non-zero
+         * elements, not the vertex count.
+         *
+         * @param accessor Morph target attribute accessor, whose type is <tt>VEC3</tt>.
+         * @param adapter Buffer data adapter.
+         * @return Pairs of (vertex index, delta).
+         * @throw AssetProcessError::SparseAccessorIndexOutOfRange If any sparse index is not less than <tt>accessor.count</tt>.
+         */
+        template <typename BufferDataAdapter>
+        [[nodiscard]] std::vector<std::pair<std::uint32_t, glm::vec3>> getNonZeroMorphTargetDeltas(const fastgltf::Accessor &accessor, const BufferDataAdapter &adapter) const {
+            const auto decode = [&](const std::byte *data) -> glm::vec3 {
+                const auto read = [&]<typename T>(std::type_identity<T>) {
+                    glm::vec<3, T> v;
+                    std::memcpy(&v, data, sizeof(v));
+                    if constexpr (std::floating_point<T>) {
+                        return v;
+                    }
+                    else if (!accessor.normalized) {
+                        return glm::vec3 { v };
+                    }
+                    else if constexpr (std::signed_integral<T>) {
+                        // glTF Specification: f = max(c / (2^(n-1) - 1), -1.0)
+                        return glm::max(glm::vec3 { v } / static_cast<float>(std::numeric_limits<T>::max()), glm::vec3 { -1.f });
+                    }
+                    else {
+                        return glm::vec3 { v } / static_cast<float>(std::numeric_limits<T>::max());
+                    }
+                };
+                switch (accessor.componentType) {
+                    case fastgltf::ComponentType::Byte: return read(std::type_identity<std::int8_t>{});
+                    case fastgltf::ComponentType::UnsignedByte: return read(std::type_identity<std::uint8_t>{});
+                    case fastgltf::ComponentType::Short: return read(std::type_identity<std::int16_t>{});
+                    case fastgltf::ComponentType::UnsignedShort: return read(std::type_identity<std::uint16_t>{});
+                    case fastgltf::ComponentType::Float: return read(std::type_identity<float>{});
+                    default: throw AssetProcessError::InvalidMorphTargetAccessorComponentType;
+                }
+            };
+
+            std::vector<std::pair<std::uint32_t, glm::vec3>> result;
+            const auto push = [&](std::size_t index, const std::byte *data) {
+                if (const glm::vec3 delta = decode(data); delta != glm::vec3 { 0.f }) {
+                    result.emplace_back(static_cast<std::uint32_t>(index), delta);
+                }
+            };
+
+            if (!accessor.bufferViewIndex) {
+                if (accessor.sparse) {
+                    // glTF Specification: The indices MUST strictly increase.
+                    forEachSparseAccessorElement(accessor, [&](std::size_t index, std::span<const std::byte> valueBytes) {
+                        push(index, valueBytes.data());
+                    }, adapter);
+                }
+                return result;
+            }
+
+            const std::size_t elementByteSize = getElementByteSize(accessor.type, accessor.componentType);
+            std::vector<std::byte> densifiedBytes;
+            std::span<const std::byte> bytes;
+            std::size_t byteStride;
+            if (accessor.sparse) {
+                densifiedBytes = densifySparseAccessor(accessor, adapter);
+                bytes = densifiedBytes;
+                byteStride = elementByteSize;
+            }
+            else {
+                bytes = adapter(asset, *accessor.bufferViewIndex).subspan(accessor.byteOffset);
+                byteStride = asset.bufferViews[*accessor.bufferViewIndex].byteStride.value_or(elementByteSize);
+            }
+
+            for (std::size_t i = 0; i < accessor.count; ++i) {
+                push(i, bytes.data() + byteStride * i);
+            }
+            return result;
         }
 
         void createPrimitiveIndexedAttributeMappingBuffers();
@@ -539,5 +1186,322 @@ namespace vk_gltf_viewer::gltf {
 
             internalBuffers.emplace_back(std::move(buffer));
         }
+
+        /**
+         * @brief Pack the joint influences of the skinned primitives, and stage them.
+         *
+         * Primitives of the meshes that are referenced by any skinned node, and have <tt>JOINTS_0</tt> and <tt>WEIGHTS_0</tt>
+         * attributes, are considered as skinned. Their influences are converted into <tt>GpuSkinInfluence</tt>s (in
+         * parallel), with the weights of each vertex renormalized to sum to 1.
+         *
+         * @param threadPool Thread pool that is used for the parallel packing.
+         * @param adapter Buffer data adapter.
+         */
+        template <typename BufferDataAdapter>
+        void createPrimitiveSkinningBuffers(BS::thread_pool &threadPool, const BufferDataAdapter &adapter) {
+            const std::unordered_set skinnedMeshIndices
+                = asset.nodes
+                | std::views::filter([](const fastgltf::Node &node) { return node.meshIndex && node.skinIndex; })
+                | std::views::transform([](const fastgltf::Node &node) { return *node.meshIndex; })
+                | std::ranges::to<std::unordered_set>();
+
+            struct SkinnedPrimitive {
+                AssetPrimitiveInfo *pPrimitiveInfo;
+                std::vector<std::pair<std::size_t /* JOINTS_n */, std::size_t /* WEIGHTS_n */>> influenceAccessorIndices;
+                std::size_t vertexCount;
+            };
+            std::vector<SkinnedPrimitive> skinnedPrimitives;
+            for (std::size_t meshIndex : skinnedMeshIndices) {
+                for (const fastgltf::Primitive &primitive : asset.meshes[meshIndex].primitives) {
+                    // Skinning deforms the positions, therefore the primitive without them is not skinned.
+                    const auto positionIt = primitive.findAttribute("POSITION");
+                    if (positionIt == primitive.attributes.end()) continue;
+
+                    SkinnedPrimitive skinnedPrimitive {
+                        .pPrimitiveInfo = &primitiveInfos[&primitive],
+                        .vertexCount = asset.accessors[positionIt->accessorIndex].count,
+                    };
+                    for (std::size_t i = 0; ; ++i) {
+                        const auto jointsIt = primitive.findAttribute(std::format("JOINTS_{}", i));
+                        const auto weightsIt = primitive.findAttribute(std::format("WEIGHTS_{}", i));
+                        if (jointsIt == primitive.attributes.end() || weightsIt == primitive.attributes.end()) break;
+
+                        skinnedPrimitive.influenceAccessorIndices.emplace_back(jointsIt->accessorIndex, weightsIt->accessorIndex);
+                    }
+
+                    if (!skinnedPrimitive.influenceAccessorIndices.empty()) {
+                        skinnedPrimitives.push_back(std::move(skinnedPrimitive));
+                    }
+                }
+            }
+
+            if (skinnedPrimitives.empty()) {
+                return;
+            }
+
+            std::vector<std::vector<GpuSkinInfluence>> influences(skinnedPrimitives.size());
+            threadPool.submit_loop(std::size_t { 0 }, skinnedPrimitives.size(), [&](std::size_t i) {
+                const SkinnedPrimitive &skinnedPrimitive = skinnedPrimitives[i];
+                const std::size_t vertexCount = skinnedPrimitive.vertexCount;
+                const std::size_t setCount = skinnedPrimitive.influenceAccessorIndices.size();
+
+                std::vector<GpuSkinInfluence> &dst = influences[i];
+                dst.resize(setCount * vertexCount);
+                for (const auto &[setIndex, accessorIndices] : skinnedPrimitive.influenceAccessorIndices | ranges::views::enumerate) {
+                    // Joint indices are read as float, which is exact for the unsigned byte/short values.
+                    fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec4>(asset, asset.accessors[accessorIndices.first], [&](const fastgltf::math::fvec4 &joints, std::size_t vertexIndex) {
+                        dst[setCount * vertexIndex + setIndex].joints = glm::u16vec4 { glm::make_vec4(joints.data()) };
+                    }, adapter);
+                    fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec4>(asset, asset.accessors[accessorIndices.second], [&](const fastgltf::math::fvec4 &weights, std::size_t vertexIndex) {
+                        dst[setCount * vertexIndex + setIndex].weights = glm::make_vec4(weights.data());
+                    }, adapter);
+                }
+
+                // glTF Specification:
+                // The joint weights for each vertex MUST NOT be negative and their sum SHOULD be 1. Quantized weights may
+                // violate it, therefore they're renormalized.
+                for (std::size_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex) {
+                    const std::span vertexInfluences { dst.data() + setCount * vertexIndex, setCount };
+                    float weightSum = 0.f;
+                    for (const GpuSkinInfluence &influence : vertexInfluences) {
+                        weightSum += glm::dot(influence.weights, glm::vec4 { 1.f });
+                    }
+                    if (weightSum > 0.f) {
+                        for (GpuSkinInfluence &influence : vertexInfluences) {
+                            influence.weights /= weightSum;
+                        }
+                    }
+                }
+            }).get();
+
+            auto [influenceBuffer, copyOffsets] = createCombinedStagingBuffer(
+                gpu.allocator,
+                influences,
+                gpu.isUmaDevice
+                    ? vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress
+                    : vk::BufferUsageFlagBits::eTransferSrc);
+
+            if (!gpu.isUmaDevice && !vku::contains(gpu.allocator.getAllocationMemoryProperties(influenceBuffer.allocation), vk::MemoryPropertyFlagBits::eDeviceLocal)) {
+                vku::AllocatedBuffer dstBuffer { gpu.allocator, vk::BufferCreateInfo {
+                    {},
+                    influenceBuffer.size,
+                    vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                } };
+                stagingInfos.emplace_back(
+                    std::move(influenceBuffer),
+                    dstBuffer,
+                    vk::BufferCopy { 0, 0, dstBuffer.size });
+                influenceBuffer = std::move(dstBuffer);
+            }
+
+            for (vk::DeviceAddress baseAddress = gpu.device.getBufferAddress({ influenceBuffer });
+                const auto &[skinnedPrimitive, copyOffset] : std::views::zip(skinnedPrimitives, copyOffsets)) {
+                skinnedPrimitive.pPrimitiveInfo->skinningInfo.emplace(
+                    baseAddress + copyOffset,
+                    static_cast<std::uint32_t>(skinnedPrimitive.influenceAccessorIndices.size()));
+            }
+
+            internalBuffers.emplace_back(std::move(influenceBuffer));
+        }
+
+        /**
+         * @brief Pack the morph target deltas of the primitives (in parallel), and stage them.
+         *
+         * Deltas are grouped by vertex (like CSR sparse matrix), and zero deltas are dropped. Therefore, sparse targets
+         * (e.g. facial expression that moves only a few vertices) only cost their non-zero elements, and the compute
+         * shader can blend all targets of a vertex in a single invocation.
+         *
+         * @param threadPool Thread pool that is used for the parallel packing.
+         * @param adapter Buffer data adapter.
+         * @throw AssetProcessError::InvalidMorphTargetAccessorComponentType If any target accessor component type is invalid.
+         * @throw AssetProcessError::SparseAccessorIndexOutOfRange If any target accessor has out of range sparse index.
+         */
+        template <typename BufferDataAdapter>
+        void createPrimitiveMorphTargetBuffers(BS::thread_pool &threadPool, const BufferDataAdapter &adapter) {
+            // Morph targets without base POSITION has nothing to deform.
+            const std::vector morphedPrimitives
+                = orderedPrimitives
+                | std::views::filter([](const fastgltf::Primitive *pPrimitive) {
+                    return !pPrimitive->targets.empty() && pPrimitive->findAttribute("POSITION") != pPrimitive->attributes.end();
+                })
+                | std::ranges::to<std::vector>();
+            if (morphedPrimitives.empty()) {
+                return;
+            }
+
+            std::vector<std::vector<GpuMorphTargetDelta>> deltas(morphedPrimitives.size());
+            std::vector<std::vector<std::uint32_t>> vertexDeltaOffsets(morphedPrimitives.size());
+            threadPool.submit_loop(std::size_t { 0 }, morphedPrimitives.size(), [&](std::size_t i) {
+                const fastgltf::Primitive &primitive = *morphedPrimitives[i];
+                const std::size_t vertexCount = asset.accessors[primitive.findAttribute("POSITION")->accessorIndex].count;
+                const std::size_t targetCount = primitive.targets.size();
+
+                // Merge the non-zero deltas of the target attributes by vertex, in the ascending order of the vertex index.
+                std::vector<std::vector<std::pair<std::uint32_t, GpuMorphTargetDelta>>> targetDeltas(targetCount);
+                for (std::size_t targetIndex = 0; targetIndex < targetCount; ++targetIndex) {
+                    using namespace std::string_view_literals;
+                    std::array<std::vector<std::pair<std::uint32_t, glm::vec3>>, 3> attributeDeltas;
+                    for (auto &&[elements, attributeName] : std::views::zip(attributeDeltas, std::array { "POSITION"sv, "NORMAL"sv, "TANGENT"sv })) {
+                        if (const auto it = primitive.findTargetAttribute(targetIndex, attributeName); it != primitive.targets[targetIndex].end()) {
+                            elements = getNonZeroMorphTargetDeltas(asset.accessors[it->accessorIndex], adapter);
+                        }
+                    }
+
+                    std::vector<std::pair<std::uint32_t, GpuMorphTargetDelta>> &mergedDeltas = targetDeltas[targetIndex];
+                    std::array<std::size_t, 3> cursors{};
+                    while (true) {
+                        // Find the smallest vertex index among the remaining deltas.
+                        std::uint32_t vertexIndex = std::numeric_limits<std::uint32_t>::max();
+                        for (const auto &[elements, cursor] : std::views::zip(attributeDeltas, cursors)) {
+                            if (cursor < elements.size()) {
+                                vertexIndex = std::min(vertexIndex, elements[cursor].first);
+                            }
+                        }
+                        if (vertexIndex >= vertexCount) break;
+
+                        GpuMorphTargetDelta delta{};
+                        delta.targetIndex = static_cast<std::uint32_t>(targetIndex);
+                        for (auto &&[elements, cursor, member] : std::views::zip(attributeDeltas, cursors, std::array { &GpuMorphTargetDelta::position, &GpuMorphTargetDelta::normal, &GpuMorphTargetDelta::tangent })) {
+                            if (cursor < elements.size() && elements[cursor].first == vertexIndex) {
+                                delta.*member = elements[cursor++].second;
+                            }
+                        }
+                        mergedDeltas.emplace_back(vertexIndex, delta);
+                    }
+                }
+
+                // Count the deltas of each vertex, and scatter them into their CSR position (ordered by target index in
+                // each vertex).
+                std::vector<std::uint32_t> &dstOffsets = vertexDeltaOffsets[i];
+                dstOffsets.resize(vertexCount + 1);
+                for (const auto &[vertexIndex, _] : targetDeltas | std::views::join) {
+                    ++dstOffsets[vertexIndex + 1];
+                }
+                std::partial_sum(dstOffsets.begin(), dstOffsets.end(), dstOffsets.begin());
+
+                std::vector<GpuMorphTargetDelta> &dstDeltas = deltas[i];
+                dstDeltas.resize(dstOffsets.back());
+                std::vector cursors = dstOffsets | std::views::take(vertexCount) | std::ranges::to<std::vector>();
+                for (const auto &[vertexIndex, delta] : targetDeltas | std::views::join) {
+                    dstDeltas[cursors[vertexIndex]++] = delta;
+                }
+
+                // Empty segment cannot be staged.
+                if (dstDeltas.empty()) {
+                    dstDeltas.emplace_back();
+                }
+            }).get();
+
+            // Stage the segments and return their device addresses.
+            const auto stage = [&](const auto &segments) {
+                auto [buffer, copyOffsets] = createCombinedStagingBuffer(
+                    gpu.allocator,
+                    segments,
+                    gpu.isUmaDevice
+                        ? vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress
+                        : vk::BufferUsageFlagBits::eTransferSrc);
+
+                if (!gpu.isUmaDevice && !vku::contains(gpu.allocator.getAllocationMemoryProperties(buffer.allocation), vk::MemoryPropertyFlagBits::eDeviceLocal)) {
+                    vku::AllocatedBuffer dstBuffer { gpu.allocator, vk::BufferCreateInfo {
+                        {},
+                        buffer.size,
+                        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                    } };
+                    stagingInfos.emplace_back(
+                        std::move(buffer),
+                        dstBuffer,
+                        vk::BufferCopy { 0, 0, dstBuffer.size });
+                    buffer = std::move(dstBuffer);
+                }
+
+                const vk::DeviceAddress baseAddress = gpu.device.getBufferAddress({ buffer });
+                internalBuffers.emplace_back(std::move(buffer));
+                return copyOffsets
+                    | std::views::transform([=](vk::DeviceSize offset) { return baseAddress + offset; })
+                    | std::ranges::to<std::vector>();
+            };
+            const std::vector deltaAddresses = stage(deltas);
+            const std::vector vertexDeltaOffsetAddresses = stage(vertexDeltaOffsets);
+
+            for (const auto &[pPrimitive, pDeltaBuffer, pVertexDeltaOffsetBuffer] : std::views::zip(morphedPrimitives, deltaAddresses, vertexDeltaOffsetAddresses)) {
+                primitiveInfos[pPrimitive].morphTargetInfo.emplace(
+                    pDeltaBuffer,
+                    pVertexDeltaOffsetBuffer,
+                    static_cast<std::uint32_t>(pPrimitive->targets.size()));
+            }
+        }
+
+        /**
+         * @brief Create the buffer that the compute vertex deformation writes into, for each (node, primitive) pair that is skinned or morphed.
+         *
+         * Deformed positions, normals and tangents of all deformed primitives are packed into a single buffer. It is
+         * written by the compute queue and read by the graphics queue.
+         */
+        void createPrimitiveDeformedAttributeBuffers() {
+            nodeDeformedPrimitiveOffsets.reserve(asset.nodes.size() + 1);
+            for (std::size_t nodeIndex : ranges::views::upto(asset.nodes.size())) {
+                nodeDeformedPrimitiveOffsets.push_back(static_cast<std::uint32_t>(deformedPrimitives.size()));
+
+                const fastgltf::Node &node = asset.nodes[nodeIndex];
+                if (!node.meshIndex) continue;
+
+                for (const fastgltf::Primitive &primitive : asset.meshes[*node.meshIndex].primitives) {
+                    const AssetPrimitiveInfo &primitiveInfo = primitiveInfos.at(&primitive);
+
+                    // Joint influences are ignored if the node has no skin.
+                    if ((node.skinIndex && primitiveInfo.skinningInfo) || primitiveInfo.morphTargetInfo) {
+                        deformedPrimitives.push_back({
+                            .nodeIndex = nodeIndex,
+                            .pPrimitive = &primitive,
+                            .index = static_cast<std::uint32_t>(orderedPrimitives.size() + deformedPrimitives.size()),
+                        });
+                    }
+                }
+            }
+            nodeDeformedPrimitiveOffsets.push_back(static_cast<std::uint32_t>(deformedPrimitives.size()));
+
+            if (deformedPrimitives.empty()) {
+                return;
+            }
+
+            // Skinned and morphed primitives always have POSITION attribute.
+            const auto getVertexCount = [&](const fastgltf::Primitive &primitive) {
+                return asset.accessors[primitive.findAttribute("POSITION")->accessorIndex].count;
+            };
+
+            vk::DeviceSize outputSize = 0;
+            for (const DeformedPrimitive &deformedPrimitive : deformedPrimitives) {
+                const AssetPrimitiveInfo &primitiveInfo = primitiveInfos.at(deformedPrimitive.pPrimitive);
+                const std::size_t attributeCount = 1 + primitiveInfo.normalInfo.has_value() + primitiveInfo.tangentInfo.has_value();
+                outputSize += sizeof(glm::vec4) * attributeCount * getVertexCount(*deformedPrimitive.pPrimitive);
+            }
+
+            vku::AllocatedBuffer outputBuffer { gpu.allocator, vk::BufferCreateInfo {
+                {},
+                outputSize,
+                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                gpu.queueFamilies.uniqueIndices.size() == 1 ? vk::SharingMode::eExclusive : vk::SharingMode::eConcurrent,
+                gpu.queueFamilies.uniqueIndices,
+            } };
+
+            vk::DeviceAddress address = gpu.device.getBufferAddress({ outputBuffer });
+            for (DeformedPrimitive &deformedPrimitive : deformedPrimitives) {
+                const AssetPrimitiveInfo &primitiveInfo = primitiveInfos.at(deformedPrimitive.pPrimitive);
+                const std::size_t vertexCount = getVertexCount(*deformedPrimitive.pPrimitive);
+                const vk::DeviceSize attributeSize = sizeof(glm::vec4) * vertexCount;
+
+                AssetPrimitiveInfo::DeformedAttributeBufferInfo &attributeBufferInfo = deformedPrimitive.attributeBufferInfo;
+                attributeBufferInfo.vertexCount = static_cast<std::uint32_t>(vertexCount);
+                attributeBufferInfo.pPositionBuffer = std::exchange(address, address + attributeSize);
+                if (primitiveInfo.normalInfo) {
+                    attributeBufferInfo.pNormalBuffer = std::exchange(address, address + attributeSize);
+                }
+                if (primitiveInfo.tangentInfo) {
+                    attributeBufferInfo.pTangentBuffer = std::exchange(address, address + attributeSize);
+                }
+            }
+
+            internalBuffers.emplace_back(std::move(outputBuffer));
+        }
     };
 }
\ No newline at end of file
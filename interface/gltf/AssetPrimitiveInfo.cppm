@@ -7,9 +7,76 @@ export import glm;
 namespace vk_gltf_viewer::gltf {
     struct AssetPrimitiveInfo {
         struct IndexBufferInfo { vk::DeviceSize offset; vk::IndexType type; };
-        struct AttributeBufferInfo { vk::DeviceAddress address; std::uint8_t byteStride; };
+
+        /**
+         * @brief Data type of the attribute components that are stored in the GPU buffer.
+         *
+         * The values MUST be matched to the <tt>COMPONENT_TYPE_*</tt> macros in <tt>shaders/types.glsl</tt>.
+         */
+        enum class ComponentType : std::uint8_t {
+            Float,
+            UnsignedByteNormalized,
+            UnsignedShortNormalized,
+            HalfFloat,  /// Two 16-bit floats packed into 32-bit (compressed TEXCOORD_<i>).
+            Octahedral, /// Octahedral encoded 32-bit unit vector (compressed NORMAL or TANGENT).
+        };
+
+        struct AttributeBufferInfo {
+            vk::DeviceAddress address;
+            std::uint8_t byteStride;
+
+            /**
+             * @brief Component type of the attribute.
+             *
+             * Only meaningful for the attribute whose component type could be varied (e.g. <tt>COLOR_<i></tt>, or
+             * attribute that is compressed at the loading time).
+             */
+            ComponentType componentType;
+
+            /**
+             * @brief Number of components of the attribute (e.g. 3 for <tt>VEC3</tt>).
+             *
+             * Only meaningful for the attribute whose component count could be varied (e.g. <tt>COLOR_<i></tt>).
+             */
+            std::uint8_t componentCount;
+        };
         struct IndexedAttributeBufferInfos { vk::DeviceAddress pMappingBuffer; std::vector<AttributeBufferInfo> attributeInfos; };
 
+        /**
+         * @brief Buffers that the compute vertex deformation (morph target blending and skinning) writes into.
+         *
+         * Deformed attributes are tightly packed <tt>vec4</tt>s (stride is 16). They are allocated for each (node,
+         * primitive) pair, and their addresses are used in the node specific <tt>GpuPrimitive</tt> instead of the
+         * original attribute buffers.
+         */
+        struct DeformedAttributeBufferInfo {
+            vk::DeviceAddress pPositionBuffer;
+            vk::DeviceAddress pNormalBuffer;  /// 0 if the primitive has no normal.
+            vk::DeviceAddress pTangentBuffer; /// 0 if the primitive has no tangent.
+            std::uint32_t vertexCount;
+        };
+
+        struct SkinningInfo {
+            /**
+             * @brief Address of the packed joint influences, <tt>influenceSetCount</tt> per vertex (JOINTS_n/WEIGHTS_n pairs).
+             */
+            vk::DeviceAddress pInfluenceBuffer;
+            std::uint32_t influenceSetCount;
+        };
+
+        struct MorphTargetInfo {
+            /**
+             * @brief Address of the non-zero target deltas, grouped by vertex.
+             */
+            vk::DeviceAddress pDeltaBuffer;
+
+            /**
+             * @brief Address of <tt>vertexCount + 1</tt> offsets, where the deltas of the <tt>i</tt>-th vertex are in <tt>[offsets[i], offsets[i + 1])</tt>.
+             */
+            vk::DeviceAddress pVertexDeltaOffsetBuffer;
+            std::uint32_t targetCount;
+        };
+
         std::uint32_t index;
         std::optional<std::size_t> materialIndex;
         std::uint32_t drawCount;
@@ -18,6 +85,9 @@ namespace vk_gltf_viewer::gltf {
         std::optional<AttributeBufferInfo> normalInfo;
         std::optional<AttributeBufferInfo> tangentInfo;
         IndexedAttributeBufferInfos texcoordsInfo;
+        IndexedAttributeBufferInfos colorsInfo;
+        std::optional<SkinningInfo> skinningInfo;
+        std::optional<MorphTargetInfo> morphTargetInfo;
         glm::dvec3 min;
         glm::dvec3 max;
     };
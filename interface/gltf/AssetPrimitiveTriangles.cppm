@@ -0,0 +1,286 @@
+export module vk_gltf_viewer:gltf.AssetPrimitiveTriangles;
+
+import std;
+export import fastgltf;
+export import glm;
+export import thread_pool;
+import :helpers.ranges;
+
+namespace vk_gltf_viewer::gltf {
+    /**
+     * @brief Host side copies of the triangle primitives' positions and indices, for the ray intersection test.
+     *
+     * Triangle strips and fans are converted into triangle lists, and non-indexed primitives get the sequential indices.
+     * Point and line primitives, and primitives without <tt>POSITION</tt> are not stored, therefore never intersected.
+     * Morph targets and skinning are not applied.
+     *
+     * Triangles of each primitive are organized in a bounding volume hierarchy (split at the median of the longest
+     * centroid axis, like <tt>AssetSceneBvh</tt>), so that the intersection test is logarithmic to the triangle count.
+     */
+    export class AssetPrimitiveTriangles {
+    public:
+        /**
+         * @brief Triangle BVH node.
+         *
+         * Nodes are stored in depth-first pre-order, therefore the first child of an internal node is the next node.
+         */
+        struct BvhNode {
+            glm::vec3 min;
+            std::uint32_t secondChildIndex;   /// Unused if leaf node.
+            glm::vec3 max;
+            std::uint32_t firstTriangleIndex; /// Range of the triangles in the subtree.
+            std::uint32_t triangleCount;
+            bool isLeaf;
+        };
+
+        struct Triangles {
+            std::vector<glm::vec3> positions;
+            std::vector<std::uint32_t> indices; /// Triangle list indices, whose size is a multiple of 3. Triangles are ordered by <tt>bvhNodes</tt>.
+            std::vector<BvhNode> bvhNodes;      /// Empty if there is no triangle.
+        };
+
+        template <typename BufferDataAdapter = fastgltf::DefaultBufferDataAdapter>
+        AssetPrimitiveTriangles(const fastgltf::Asset &asset, BS::thread_pool &threadPool, const BufferDataAdapter &adapter = {}) {
+            const std::vector trianglePrimitives
+                = asset.meshes
+                | std::views::transform(&fastgltf::Mesh::primitives)
+                | std::views::join
+                | std::views::filter([](const fastgltf::Primitive &primitive) {
+                    return ranges::one_of(primitive.type, fastgltf::PrimitiveType::Triangles, fastgltf::PrimitiveType::TriangleStrip, fastgltf::PrimitiveType::TriangleFan)
+                        && primitive.findAttribute("POSITION") != primitive.attributes.end();
+                })
+                | ranges::views::addressof
+                | std::ranges::to<std::vector>();
+
+            std::vector<Triangles> results(trianglePrimitives.size());
+            threadPool.submit_loop(std::size_t { 0 }, trianglePrimitives.size(), [&](std::size_t i) {
+                const fastgltf::Primitive &primitive = *trianglePrimitives[i];
+                Triangles &triangles = results[i];
+
+                const fastgltf::Accessor &positionAccessor = asset.accessors[primitive.findAttribute("POSITION")->accessorIndex];
+                triangles.positions.resize(positionAccessor.count);
+                fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(asset, positionAccessor, [&](const fastgltf::math::fvec3 &position, std::size_t index) {
+                    triangles.positions[index] = glm::make_vec3(position.data());
+                }, adapter);
+
+                std::vector<std::uint32_t> vertexIndices;
+                if (primitive.indicesAccessor) {
+                    const fastgltf::Accessor &indexAccessor = asset.accessors[*primitive.indicesAccessor];
+                    vertexIndices.resize(indexAccessor.count);
+                    fastgltf::copyFromAccessor<std::uint32_t>(asset, indexAccessor, vertexIndices.data(), adapter);
+                }
+                else {
+                    vertexIndices = ranges::views::upto(static_cast<std::uint32_t>(positionAccessor.count)) | std::ranges::to<std::vector>();
+                }
+
+                switch (primitive.type) {
+                    case fastgltf::PrimitiveType::Triangles:
+                        vertexIndices.resize(vertexIndices.size() / 3 * 3);
+                        triangles.indices = std::move(vertexIndices);
+                        break;
+                    case fastgltf::PrimitiveType::TriangleStrip:
+                        // glTF Specification:
+                        // p_i = {v_i, v_{i+(1+i%2)}, v_{i+(2-i%2)}}
+                        for (std::size_t j = 0; j + 2 < vertexIndices.size(); ++j) {
+                            triangles.indices.append_range(std::array { vertexIndices[j], vertexIndices[j + 1 + j % 2], vertexIndices[j + 2 - j % 2] });
+                        }
+                        break;
+                    case fastgltf::PrimitiveType::TriangleFan:
+                        // glTF Specification:
+                        // p_i = {v_{i+1}, v_{i+2}, v_0}
+                        for (std::size_t j = 0; j + 2 < vertexIndices.size(); ++j) {
+                            triangles.indices.append_range(std::array { vertexIndices[j + 1], vertexIndices[j + 2], vertexIndices[0] });
+                        }
+                        break;
+                    default:
+                        std::unreachable();
+                }
+
+                // Indices out of the POSITION accessor would make the intersection test read out of bounds.
+                if (std::ranges::any_of(triangles.indices, [&](std::uint32_t index) { return index >= triangles.positions.size(); })) {
+                    triangles.indices.clear();
+                }
+
+                buildBvh(triangles);
+            }).get();
+
+            for (auto &&[pPrimitive, triangles] : std::views::zip(trianglePrimitives, results)) {
+                primitiveTriangles.emplace(pPrimitive, std::move(triangles));
+            }
+        }
+
+        /**
+         * @brief Get the closest intersection of the ray and \p primitive's triangles.
+         *
+         * Only the triangles in the BVH leaf nodes that are hit by the ray are tested, with Möller–Trumbore ray-triangle
+         * intersection algorithm.
+         *
+         * @param primitive Primitive to be tested. It must be from the asset that is used for the construction.
+         * @param rayOrigin Ray origin, in the primitive's local space.
+         * @param rayDirection Ray direction, in the primitive's local space. It does not have to be normalized.
+         * @param maxDistance Intersections farther than this (in the unit of \p rayDirection length) are ignored.
+         * @param cullBackFace If <tt>false</tt>, both faces are intersected (for the double-sided material).
+         * @param flipWinding If <tt>true</tt>, the clockwise triangles are regarded as front facing. It is used when the
+         * primitive's world transform has negative determinant.
+         * @return The distance to the closest intersection (in the unit of \p rayDirection length), or <tt>std::nullopt</tt>
+         * if the ray does not intersect.
+         */
+        [[nodiscard]] std::optional<float> intersect(
+            const fastgltf::Primitive &primitive,
+            const glm::vec3 &rayOrigin,
+            const glm::vec3 &rayDirection,
+            float maxDistance,
+            bool cullBackFace,
+            bool flipWinding = false
+        ) const {
+            const auto it = primitiveTriangles.find(&primitive);
+            if (it == primitiveTriangles.end()) {
+                return std::nullopt;
+            }
+
+            const auto &[positions, indices, bvhNodes] = it->second;
+            if (bvhNodes.empty()) {
+                return std::nullopt;
+            }
+
+            const glm::vec3 inverseRayDirection = 1.f / rayDirection;
+            std::optional<float> result;
+            std::array<std::uint32_t, MAX_TRAVERSAL_STACK_SIZE> nodeIndexStack;
+            std::uint32_t nodeIndexStackSize = 0;
+            nodeIndexStack[nodeIndexStackSize++] = 0;
+            while (nodeIndexStackSize != 0) {
+                const std::uint32_t nodeIndex = nodeIndexStack[--nodeIndexStackSize];
+
+                const BvhNode &node = bvhNodes[nodeIndex];
+
+                // Slab test, with the closest intersection found so far.
+                const glm::vec3 t1 = (node.min - rayOrigin) * inverseRayDirection;
+                const glm::vec3 t2 = (node.max - rayOrigin) * inverseRayDirection;
+                const glm::vec3 tNear = min(t1, t2), tFar = max(t1, t2);
+                if (std::max({ tNear.x, tNear.y, tNear.z, 0.f }) > std::min({ tFar.x, tFar.y, tFar.z, maxDistance })) {
+                    continue;
+                }
+
+                if (!node.isLeaf) {
+                    nodeIndexStack[nodeIndexStackSize++] = node.secondChildIndex;
+                    nodeIndexStack[nodeIndexStackSize++] = nodeIndex + 1;
+                    continue;
+                }
+
+                for (std::size_t i = 3 * node.firstTriangleIndex; i < 3 * (node.firstTriangleIndex + node.triangleCount); i += 3) {
+                    const glm::vec3 &p0 = positions[indices[i]];
+                    const glm::vec3 edge1 = positions[indices[i + 1]] - p0;
+                    const glm::vec3 edge2 = positions[indices[i + 2]] - p0;
+
+                    const glm::vec3 pvec = cross(rayDirection, edge2);
+                    const float determinant = dot(edge1, pvec);
+
+                    // determinant > 0 if the triangle is counter-clockwise from the ray's view.
+                    if (cullBackFace ? (flipWinding ? determinant > -1e-12f : determinant < 1e-12f) : std::abs(determinant) < 1e-12f) {
+                        continue;
+                    }
+
+                    const float inverseDeterminant = 1.f / determinant;
+                    const glm::vec3 tvec = rayOrigin - p0;
+                    const float u = dot(tvec, pvec) * inverseDeterminant;
+                    if (u < 0.f || u > 1.f) continue;
+
+                    const glm::vec3 qvec = cross(tvec, edge1);
+                    const float v = dot(rayDirection, qvec) * inverseDeterminant;
+                    if (v < 0.f || u + v > 1.f) continue;
+
+                    const float distance = dot(edge2, qvec) * inverseDeterminant;
+                    if (distance > 0.f && distance < maxDistance) {
+                        result.emplace(maxDistance = distance);
+                    }
+                }
+            }
+            return result;
+        }
+
+    private:
+        /**
+         * @brief Maximum number of the triangles in a BVH leaf node.
+         */
+        static constexpr std::uint32_t MAX_LEAF_TRIANGLE_COUNT = 4;
+
+        /**
+         * @brief Upper bound of the depth-first traversal stack size, same as <tt>AssetSceneBvh</tt> as it is also built by median split.
+         */
+        static constexpr std::uint32_t MAX_TRAVERSAL_STACK_SIZE = std::numeric_limits<std::uint32_t>::digits + 2;
+
+        std::unordered_map<const fastgltf::Primitive*, Triangles> primitiveTriangles;
+
+        /**
+         * @brief Build <tt>triangles.bvhNodes</tt>, and reorder <tt>triangles.indices</tt> by it.
+         */
+        static void buildBvh(Triangles &triangles) {
+            const auto triangleCount = static_cast<std::uint32_t>(triangles.indices.size() / 3);
+            if (triangleCount == 0) {
+                return;
+            }
+
+            struct TriangleBounds {
+                glm::vec3 min;
+                glm::vec3 max;
+                std::uint32_t triangleIndex;
+            };
+            std::vector<TriangleBounds> triangleBounds
+                = ranges::views::upto(triangleCount)
+                | std::views::transform([&](std::uint32_t triangleIndex) {
+                    const glm::vec3 &p0 = triangles.positions[triangles.indices[3 * triangleIndex]];
+                    const glm::vec3 &p1 = triangles.positions[triangles.indices[3 * triangleIndex + 1]];
+                    const glm::vec3 &p2 = triangles.positions[triangles.indices[3 * triangleIndex + 2]];
+                    return TriangleBounds { min(min(p0, p1), p2), max(max(p0, p1), p2), triangleIndex };
+                })
+                | std::ranges::to<std::vector>();
+
+            const auto buildNodes = [&](this const auto &self, std::uint32_t firstTriangleIndex, std::uint32_t lastTriangleIndex) -> void {
+                const auto nodeIndex = static_cast<std::uint32_t>(triangles.bvhNodes.size());
+                BvhNode &node = triangles.bvhNodes.emplace_back(
+                    glm::vec3 { std::numeric_limits<float>::infinity() }, 0U,
+                    glm::vec3 { -std::numeric_limits<float>::infinity() }, firstTriangleIndex, lastTriangleIndex - firstTriangleIndex,
+                    false);
+
+                const std::span subtreeTriangleBounds = std::span { triangleBounds }.subspan(firstTriangleIndex, lastTriangleIndex - firstTriangleIndex);
+                glm::vec3 centroidMin { std::numeric_limits<float>::infinity() }, centroidMax { -std::numeric_limits<float>::infinity() };
+                for (const TriangleBounds &bounds : subtreeTriangleBounds) {
+                    node.min = min(node.min, bounds.min);
+                    node.max = max(node.max, bounds.max);
+                    const glm::vec3 centroid = (bounds.min + bounds.max) * 0.5f;
+                    centroidMin = min(centroidMin, centroid);
+                    centroidMax = max(centroidMax, centroid);
+                }
+
+                if (subtreeTriangleBounds.size() <= MAX_LEAF_TRIANGLE_COUNT) {
+                    node.isLeaf = true;
+                    return;
+                }
+
+                // Split at the median of the longest centroid axis.
+                const glm::vec3 centroidExtent = centroidMax - centroidMin;
+                const glm::length_t axis = centroidExtent.x > centroidExtent.y
+                    ? (centroidExtent.x > centroidExtent.z ? 0 : 2)
+                    : (centroidExtent.y > centroidExtent.z ? 1 : 2);
+                const std::uint32_t middleTriangleIndex = firstTriangleIndex + static_cast<std::uint32_t>(subtreeTriangleBounds.size() / 2);
+                std::ranges::nth_element(subtreeTriangleBounds, subtreeTriangleBounds.begin() + (middleTriangleIndex - firstTriangleIndex), {}, [axis](const TriangleBounds &bounds) {
+                    return bounds.min[axis] + bounds.max[axis];
+                });
+
+                // node reference may be invalidated by the children emplacement.
+                self(firstTriangleIndex, middleTriangleIndex);
+                triangles.bvhNodes[nodeIndex].secondChildIndex = static_cast<std::uint32_t>(triangles.bvhNodes.size());
+                self(middleTriangleIndex, lastTriangleIndex);
+            };
+            buildNodes(0, triangleCount);
+
+            // Reorder the triangles to be contiguous in each leaf node.
+            std::vector<std::uint32_t> reorderedIndices;
+            reorderedIndices.reserve(triangles.indices.size());
+            for (const TriangleBounds &bounds : triangleBounds) {
+                reorderedIndices.append_range(std::span { triangles.indices }.subspan(3 * bounds.triangleIndex, 3));
+            }
+            triangles.indices = std::move(reorderedIndices);
+        }
+    };
+}
\ No newline at end of file
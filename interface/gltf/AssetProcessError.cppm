@@ -5,17 +5,18 @@ export import cstring_view;
 
 namespace vk_gltf_viewer::gltf {
     export enum class AssetProcessError : std::uint8_t {
-        SparseAttributeBufferAccessor,     /// Attribute buffer accessor is sparse.
         NormalizedAttributeBufferAccessor, /// Attribute buffer accessor is normalized.
         TooLargeAccessorByteStride,        /// The byte stride of the accessor is too large that is cannot be represented in 8-byte unsigned integer.
         IndeterminateImageMimeType,        /// Image MIME type cannot be determined (neither provided nor inferred from the file extension).
         UnsupportedSourceDataType,         /// The source data type is not supported.
+        MeshoptDecompressionFailure,       /// Failed to decode the EXT_meshopt_compression compressed buffer view.
+        SparseAccessorIndexOutOfRange,     /// The sparse accessor index is not less than the accessor count.
+        InvalidAnimationSamplerOutputType, /// The animation sampler output accessor type is not SCALAR, VEC3 or VEC4.
+        InvalidMorphTargetAccessorComponentType, /// The morph target accessor component type is neither float nor (normalized) byte/short.
     };
 
     export cpp_util::cstring_view to_string(AssetProcessError error) noexcept {
         switch (error) {
-            case AssetProcessError::SparseAttributeBufferAccessor:
-                return "Attribute buffer accessor is sparse.";
             case AssetProcessError::NormalizedAttributeBufferAccessor:
                 return "Attribute buffer accessor is normalized.";
             case AssetProcessError::TooLargeAccessorByteStride:
@@ -24,6 +25,14 @@ namespace vk_gltf_viewer::gltf {
                 return "Image MIME type cannot be determined.";
             case AssetProcessError::UnsupportedSourceDataType:
                 return "The source data type is not supported.";
+            case AssetProcessError::MeshoptDecompressionFailure:
+                return "Failed to decode the meshopt compressed buffer view.";
+            case AssetProcessError::SparseAccessorIndexOutOfRange:
+                return "The sparse accessor index is out of range.";
+            case AssetProcessError::InvalidAnimationSamplerOutputType:
+                return "The animation sampler output accessor type is invalid.";
+            case AssetProcessError::InvalidMorphTargetAccessorComponentType:
+                return "The morph target accessor component type is invalid.";
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,459 @@
+export module vk_gltf_viewer:gltf.AssetSceneBvh;
+
+import std;
+export import fastgltf;
+export import glm;
+import :gltf.algorithm.bounding_box;
+export import :gltf.AssetSceneHierarchy;
+import :helpers.concepts;
+import :helpers.ranges;
+export import :math.Frustum;
+
+namespace vk_gltf_viewer::gltf {
+    /**
+     * @brief Bounding volume hierarchy over the world space axis aligned bounding boxes of the mesh node instances in a scene.
+     *
+     * Each mesh node instance (a mesh node without <tt>EXT_mesh_gpu_instancing</tt> has a single instance) is a leaf,
+     * and the hierarchy is built by splitting the leaves at the median of the longest centroid axis. When a node
+     * transform is changed, the leaf bounding boxes of its subtree are recalculated and only their ancestors in the
+     * hierarchy are refitted, i.e. the topology is preserved. The hierarchy serves as a single spatial acceleration
+     * structure for the scene bounds, the view depth range and the ray queries.
+     */
+    export class AssetSceneBvh {
+    public:
+        struct BoundingBox {
+            glm::vec3 min { std::numeric_limits<float>::infinity() };
+            glm::vec3 max { -std::numeric_limits<float>::infinity() };
+
+            [[nodiscard]] bool empty() const noexcept {
+                return min.x > max.x;
+            }
+
+            [[nodiscard]] glm::vec3 getCenter() const noexcept {
+                return (min + max) * 0.5f;
+            }
+
+            [[nodiscard]] glm::vec3 getHalfExtent() const noexcept {
+                return (max - min) * 0.5f;
+            }
+
+            void merge(const BoundingBox &other) noexcept {
+                min = glm::min(min, other.min);
+                max = glm::max(max, other.max);
+            }
+
+            /**
+             * @brief Determine if the box is on the positive side of all \p planes.
+             *
+             * Like <tt>math::Frustum::isOverlapApprox</tt>, this may be false-positive near the edges of the planes, but
+             * never be false-negative.
+             *
+             * @param planes Planes to be tested.
+             * @return <tt>true</tt> if the box is not entirely on the negative side of any plane, <tt>false</tt> otherwise.
+             */
+            [[nodiscard]] bool isOverlapApprox(std::span<const math::Plane> planes) const noexcept {
+                const glm::vec3 center = getCenter();
+                const glm::vec3 halfExtent = getHalfExtent();
+                for (const math::Plane &plane : planes) {
+                    // Signed distance of the box's most positive vertex along the plane normal.
+                    if (plane.getSignedDistance(center) + dot(abs(plane.normal), halfExtent) < 0.f) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        };
+
+        /**
+         * @brief An instance of a mesh node.
+         */
+        struct Leaf {
+            BoundingBox boundingBox;
+            std::uint32_t nodeIndex;
+            std::uint32_t instanceIndex;
+        };
+
+        template <concepts::compatible_signature_of<fastgltf::math::dmat4x4, std::size_t, std::size_t> MeshNodeTransformGetter>
+        AssetSceneBvh(
+            const fastgltf::Asset &asset [[clang::lifetimebound]],
+            const fastgltf::Scene &scene [[clang::lifetimebound]],
+            const AssetSceneHierarchy &sceneHierarchy [[clang::lifetimebound]],
+            const MeshNodeTransformGetter &transformGetter
+        ) : pAsset { &asset },
+            pSceneHierarchy { &sceneHierarchy },
+            meshLocalBoundingBoxes { createMeshLocalBoundingBoxes() } {
+            for (std::size_t rootNodeIndex : scene.nodeIndices) {
+                for (std::size_t nodeIndex : sceneHierarchy.getSubtreeNodeIndices(rootNodeIndex)) {
+                    const fastgltf::Node &node = asset.nodes[nodeIndex];
+                    if (!node.meshIndex) continue;
+
+                    const std::size_t instanceCount = node.instancingAttributes.empty() ? 1 : asset.accessors[node.instancingAttributes[0].accessorIndex].count;
+                    for (std::size_t instanceIndex : ranges::views::upto(instanceCount)) {
+                        leaves.push_back({
+                            transform(meshLocalBoundingBoxes[*node.meshIndex], transformGetter(nodeIndex, instanceIndex)),
+                            static_cast<std::uint32_t>(nodeIndex),
+                            static_cast<std::uint32_t>(instanceIndex),
+                        });
+                    }
+                }
+            }
+
+            if (!leaves.empty()) {
+                buildNodes(NO_INDEX, 0, static_cast<std::uint32_t>(leaves.size()));
+            }
+            dirtyNodeFlags.resize(nodes.size());
+
+            // Map each leaf to its BVH node, and each glTF node to its leaves.
+            leafNodeIndices.resize(leaves.size());
+            for (const auto &[bvhNodeIndex, bvhNode] : nodes | ranges::views::enumerate) {
+                if (!bvhNode.isLeaf) continue;
+                std::ranges::fill(std::span { leafNodeIndices }.subspan(bvhNode.firstLeafIndex, bvhNode.leafCount), static_cast<std::uint32_t>(bvhNodeIndex));
+            }
+
+            nodeLeafIndexOffsets.resize(asset.nodes.size() + 1);
+            for (const Leaf &leaf : leaves) {
+                ++nodeLeafIndexOffsets[leaf.nodeIndex + 1];
+            }
+            std::partial_sum(nodeLeafIndexOffsets.begin(), nodeLeafIndexOffsets.end(), nodeLeafIndexOffsets.begin());
+
+            nodeLeafIndices.resize(leaves.size());
+            std::vector<std::uint32_t> nodeLeafCounts(asset.nodes.size());
+            for (const auto &[leafIndex, leaf] : leaves | ranges::views::enumerate) {
+                nodeLeafIndices[nodeLeafIndexOffsets[leaf.nodeIndex] + nodeLeafCounts[leaf.nodeIndex]++] = static_cast<std::uint32_t>(leafIndex);
+            }
+        }
+
+        /**
+         * @brief Refit the hierarchy after the world transform of \p nodeIndex-th node (and therefore its descendants) is changed.
+         * @param nodeIndex Index of the node whose transform is changed.
+         * @param transformGetter A function that returns world transform matrix for an instance of a node. First parameter is the node index, and the second parameter is the instance index.
+         */
+        template <concepts::compatible_signature_of<fastgltf::math::dmat4x4, std::size_t, std::size_t> MeshNodeTransformGetter>
+        void refitFrom(std::size_t nodeIndex, const MeshNodeTransformGetter &transformGetter) {
+            std::vector<std::uint32_t> dirtyNodeIndices;
+            for (std::size_t subtreeNodeIndex : pSceneHierarchy->getSubtreeNodeIndices(nodeIndex)) {
+                for (std::uint32_t leafIndex : getNodeLeafIndices(subtreeNodeIndex)) {
+                    Leaf &leaf = leaves[leafIndex];
+                    leaf.boundingBox = transform(meshLocalBoundingBoxes[*pAsset->nodes[subtreeNodeIndex].meshIndex], transformGetter(leaf.nodeIndex, leaf.instanceIndex));
+
+                    // Mark the path to the root, until an already marked node is met.
+                    for (std::uint32_t bvhNodeIndex = leafNodeIndices[leafIndex]; bvhNodeIndex != NO_INDEX && !dirtyNodeFlags[bvhNodeIndex]; bvhNodeIndex = nodes[bvhNodeIndex].parentIndex) {
+                        dirtyNodeFlags[bvhNodeIndex] = true;
+                        dirtyNodeIndices.push_back(bvhNodeIndex);
+                    }
+                }
+            }
+
+            // Children are always placed after their parent, therefore refitting in the descending index order
+            // completes the children before their parent.
+            std::ranges::sort(dirtyNodeIndices, std::greater{});
+            for (std::uint32_t bvhNodeIndex : dirtyNodeIndices) {
+                refitNode(bvhNodeIndex);
+                dirtyNodeFlags[bvhNodeIndex] = false;
+            }
+        }
+
+        /**
+         * @brief Get bounding box of the whole scene.
+         * @return Bounding box that encloses all mesh nodes in the scene. It is empty if the scene has no mesh.
+         */
+        [[nodiscard]] BoundingBox getSceneBoundingBox() const noexcept {
+            if (nodes.empty()) {
+                return {};
+            }
+            return nodes[0].boundingBox;
+        }
+
+        /**
+         * @brief Get the range of the leaf bounding boxes' depth along the view direction, considering only the leaves that overlap with \p boundingPlanes.
+         *
+         * Subtrees that cannot extend the range found so far are not visited.
+         *
+         * @param viewPosition View position.
+         * @param viewDirection View direction. MUST be normalized.
+         * @param boundingPlanes Planes that bound the considered region, e.g. the side planes of the view frustum.
+         * @return The pair of the nearest and farthest depth, or <tt>std::nullopt</tt> if no leaf is in front of the view.
+         */
+        [[nodiscard]] std::optional<std::pair<float, float>> getDepthRange(
+            const glm::vec3 &viewPosition,
+            const glm::vec3 &viewDirection,
+            std::span<const math::Plane> boundingPlanes
+        ) const {
+            float nearest = std::numeric_limits<float>::infinity();
+            float farthest = 0.f;
+
+            const auto getBoxDepthRange = [&](const BoundingBox &boundingBox) {
+                const float centerDepth = dot(boundingBox.getCenter() - viewPosition, viewDirection);
+                const float halfDepthExtent = dot(boundingBox.getHalfExtent(), abs(viewDirection));
+                return std::pair { centerDepth - halfDepthExtent, centerDepth + halfDepthExtent };
+            };
+
+            traverse(
+                [&](const BoundingBox &boundingBox) {
+                    const auto [boxNearest, boxFarthest] = getBoxDepthRange(boundingBox);
+                    return boxFarthest > 0.f // Box that is entirely behind the view is ignored.
+                        && (boxNearest < nearest || boxFarthest > farthest)
+                        && boundingBox.isOverlapApprox(boundingPlanes);
+                },
+                [&](const Leaf &leaf) {
+                    // A BVH leaf node may contain leaves that are behind the view or outside the planes.
+                    const auto [leafNearest, leafFarthest] = getBoxDepthRange(leaf.boundingBox);
+                    if (leafFarthest <= 0.f || !leaf.boundingBox.isOverlapApprox(boundingPlanes)) return;
+
+                    nearest = std::min(nearest, leafNearest);
+                    farthest = std::max(farthest, leafFarthest);
+                });
+
+            if (farthest <= 0.f) {
+                return std::nullopt;
+            }
+            return std::pair { nearest, farthest };
+        }
+
+        /**
+         * @brief Invoke \p f for every leaf whose bounding box is intersected by the ray.
+         * @param rayOrigin Ray origin.
+         * @param rayDirection Ray direction. It does not have to be normalized.
+         * @param f Function that is invoked with <tt>const Leaf&</tt>.
+         */
+        void forEachLeafAlongRay(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection, std::invocable<const Leaf&> auto &&f) const {
+            const glm::vec3 inverseRayDirection = 1.f / rayDirection;
+            const auto isHit = [&](const BoundingBox &boundingBox) {
+                return isRayHit(boundingBox, rayOrigin, inverseRayDirection, std::numeric_limits<float>::infinity());
+            };
+
+            traverse(isHit, [&](const Leaf &leaf) {
+                if (isHit(leaf.boundingBox)) {
+                    f(leaf);
+                }
+            });
+        }
+
+        /**
+         * @brief Find the closest leaf intersection along the ray.
+         *
+         * Leaves are tested only if their bounding box is hit closer than the closest intersection found so far.
+         *
+         * @param rayOrigin Ray origin.
+         * @param rayDirection Ray direction. It does not have to be normalized.
+         * @param maxDistance Intersections farther than this (in the unit of \p rayDirection length) are ignored.
+         * @param leafIntersector Function that is invoked with <tt>(const Leaf&, float maxDistance)</tt>, and returns the
+         * distance to the intersection closer than <tt>maxDistance</tt> (in the unit of \p rayDirection length), or
+         * <tt>std::nullopt</tt> if there is no such intersection.
+         * @return The pair of the closest intersected leaf and the distance to it, or <tt>std::nullopt</tt> if the ray
+         * does not intersect any leaf.
+         */
+        [[nodiscard]] std::optional<std::pair<Leaf, float>> getClosestIntersection(
+            const glm::vec3 &rayOrigin,
+            const glm::vec3 &rayDirection,
+            float maxDistance,
+            concepts::compatible_signature_of<std::optional<float>, const Leaf&, float> auto const &leafIntersector
+        ) const {
+            const glm::vec3 inverseRayDirection = 1.f / rayDirection;
+            std::optional<std::pair<Leaf, float>> result;
+            float closestDistance = maxDistance;
+
+            const auto isHit = [&](const BoundingBox &boundingBox) {
+                return isRayHit(boundingBox, rayOrigin, inverseRayDirection, closestDistance);
+            };
+
+            traverse(isHit, [&](const Leaf &leaf) {
+                if (!isHit(leaf.boundingBox)) return;
+                if (std::optional<float> distance = leafIntersector(leaf, closestDistance)) {
+                    closestDistance = *distance;
+                    result.emplace(leaf, *distance);
+                }
+            });
+
+            return result;
+        }
+
+    private:
+        static constexpr std::uint32_t NO_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+        /**
+         * @brief Maximum number of the leaves in a BVH leaf node.
+         */
+        static constexpr std::uint32_t MAX_LEAF_COUNT = 4;
+
+        /**
+         * @brief Upper bound of the depth-first traversal stack size.
+         *
+         * Median split halves the leaves at each level, therefore the tree depth never exceeds the bit width of the
+         * leaf count. The stack holds at most one pending sibling per level, plus the two children just pushed.
+         */
+        static constexpr std::uint32_t MAX_TRAVERSAL_STACK_SIZE = std::numeric_limits<std::uint32_t>::digits + 2;
+
+        /**
+         * @brief BVH node.
+         *
+         * Nodes are stored in depth-first pre-order, therefore the first child of an internal node is the next node.
+         */
+        struct Node {
+            BoundingBox boundingBox;
+            std::uint32_t parentIndex;      /// <tt>NO_INDEX</tt> if root.
+            std::uint32_t secondChildIndex; /// Unused if leaf node.
+            std::uint32_t firstLeafIndex;   /// Range of the leaves in the subtree.
+            std::uint32_t leafCount;
+            bool isLeaf;
+        };
+
+        const fastgltf::Asset *pAsset;
+        const AssetSceneHierarchy *pSceneHierarchy;
+
+        /**
+         * @brief Bounding box of each mesh in its local space, which encloses all its primitives.
+         */
+        std::vector<BoundingBox> meshLocalBoundingBoxes;
+
+        std::vector<Leaf> leaves;
+        std::vector<Node> nodes;
+
+        /**
+         * @brief Index of the BVH leaf node that contains each leaf.
+         */
+        std::vector<std::uint32_t> leafNodeIndices;
+
+        /**
+         * @brief Indices of the leaves of each glTF node are <tt>nodeLeafIndices[nodeLeafIndexOffsets[i]:nodeLeafIndexOffsets[i + 1]]</tt>.
+         */
+        std::vector<std::uint32_t> nodeLeafIndexOffsets;
+        std::vector<std::uint32_t> nodeLeafIndices;
+
+        /**
+         * @brief Scratch flags for <tt>refitFrom</tt>, which are all <tt>false</tt> outside of it.
+         */
+        std::vector<bool> dirtyNodeFlags;
+
+        [[nodiscard]] std::vector<BoundingBox> createMeshLocalBoundingBoxes() const {
+            return pAsset->meshes | std::views::transform([&](const fastgltf::Mesh &mesh) {
+                BoundingBox result;
+                for (const fastgltf::Primitive &primitive : mesh.primitives) {
+                    const auto cornerPoints = algorithm::getBoundingBoxCornerPoints(*pAsset, primitive);
+                    result.merge({ glm::vec3 { glm::make_vec3(cornerPoints.front().data()) }, glm::vec3 { glm::make_vec3(cornerPoints.back().data()) } });
+                }
+                return result;
+            }) | std::ranges::to<std::vector>();
+        }
+
+        /**
+         * @brief Transform the bounding box by the affine transform matrix, and get the bounding box of the result.
+         *
+         * J. Arvo, "Transforming Axis-Aligned Bounding Boxes", Graphics Gems, 1990.
+         */
+        [[nodiscard]] static BoundingBox transform(const BoundingBox &boundingBox, const fastgltf::math::dmat4x4 &matrix) noexcept {
+            const glm::mat4 m { glm::make_mat4(matrix.data()) };
+            const glm::vec3 transformedCenter { m * glm::vec4 { boundingBox.getCenter(), 1.f } };
+            const glm::vec3 transformedHalfExtent = glm::mat3 { abs(glm::vec3 { m[0] }), abs(glm::vec3 { m[1] }), abs(glm::vec3 { m[2] }) } * boundingBox.getHalfExtent();
+            return { transformedCenter - transformedHalfExtent, transformedCenter + transformedHalfExtent };
+        }
+
+        /**
+         * @brief Determine if the ray hits the box before \p maxDistance, by the slab test.
+         * @param boundingBox Box to be tested.
+         * @param rayOrigin Ray origin.
+         * @param inverseRayDirection Component-wise reciprocal of the ray direction.
+         * @param maxDistance Hits farther than this (in the unit of the ray direction length) are ignored.
+         */
+        [[nodiscard]] static bool isRayHit(
+            const BoundingBox &boundingBox,
+            const glm::vec3 &rayOrigin,
+            const glm::vec3 &inverseRayDirection,
+            float maxDistance
+        ) noexcept {
+            const glm::vec3 t1 = (boundingBox.min - rayOrigin) * inverseRayDirection;
+            const glm::vec3 t2 = (boundingBox.max - rayOrigin) * inverseRayDirection;
+            const glm::vec3 tNear = min(t1, t2), tFar = max(t1, t2);
+            const float entry = std::max({ tNear.x, tNear.y, tNear.z, 0.f });
+            const float exit = std::min({ tFar.x, tFar.y, tFar.z, maxDistance });
+            return entry <= exit;
+        }
+
+        /**
+         * @brief Build the subtree of <tt>leaves[firstLeafIndex:lastLeafIndex]</tt>, which are reordered by the split.
+         */
+        void buildNodes(std::uint32_t parentIndex, std::uint32_t firstLeafIndex, std::uint32_t lastLeafIndex) {
+            const auto nodeIndex = static_cast<std::uint32_t>(nodes.size());
+            Node &node = nodes.emplace_back(BoundingBox{}, parentIndex, NO_INDEX, firstLeafIndex, lastLeafIndex - firstLeafIndex, false);
+
+            const std::span subtreeLeaves = std::span { leaves }.subspan(firstLeafIndex, lastLeafIndex - firstLeafIndex);
+            BoundingBox centroidBoundingBox;
+            for (const Leaf &leaf : subtreeLeaves) {
+                node.boundingBox.merge(leaf.boundingBox);
+                const glm::vec3 centroid = leaf.boundingBox.getCenter();
+                centroidBoundingBox.merge({ centroid, centroid });
+            }
+
+            if (subtreeLeaves.size() <= MAX_LEAF_COUNT) {
+                node.isLeaf = true;
+                return;
+            }
+
+            // Split at the median of the longest centroid axis.
+            const glm::vec3 centroidExtent = centroidBoundingBox.max - centroidBoundingBox.min;
+            const glm::length_t axis = centroidExtent.x > centroidExtent.y
+                ? (centroidExtent.x > centroidExtent.z ? 0 : 2)
+                : (centroidExtent.y > centroidExtent.z ? 1 : 2);
+            const std::uint32_t middleLeafIndex = firstLeafIndex + static_cast<std::uint32_t>(subtreeLeaves.size() / 2);
+            std::ranges::nth_element(subtreeLeaves, subtreeLeaves.begin() + (middleLeafIndex - firstLeafIndex), {}, [axis](const Leaf &leaf) {
+                return leaf.boundingBox.min[axis] + leaf.boundingBox.max[axis];
+            });
+
+            // node reference may be invalidated by the children emplacement.
+            buildNodes(nodeIndex, firstLeafIndex, middleLeafIndex);
+            nodes[nodeIndex].secondChildIndex = static_cast<std::uint32_t>(nodes.size());
+            buildNodes(nodeIndex, middleLeafIndex, lastLeafIndex);
+        }
+
+        void refitNode(std::uint32_t nodeIndex) noexcept {
+            Node &node = nodes[nodeIndex];
+            node.boundingBox = {};
+            if (node.isLeaf) {
+                for (const Leaf &leaf : std::span { leaves }.subspan(node.firstLeafIndex, node.leafCount)) {
+                    node.boundingBox.merge(leaf.boundingBox);
+                }
+            }
+            else {
+                node.boundingBox.merge(nodes[nodeIndex + 1].boundingBox);
+                node.boundingBox.merge(nodes[node.secondChildIndex].boundingBox);
+            }
+        }
+
+        [[nodiscard]] std::span<const std::uint32_t> getNodeLeafIndices(std::size_t nodeIndex) const noexcept {
+            return std::span { nodeLeafIndices }.subspan(nodeLeafIndexOffsets[nodeIndex], nodeLeafIndexOffsets[nodeIndex + 1] - nodeLeafIndexOffsets[nodeIndex]);
+        }
+
+        /**
+         * @brief Depth-first traversal of the nodes whose bounding box satisfies \p nodePredicate.
+         * @param nodePredicate Function that returns <tt>true</tt> if the subtree of the node with the given bounding box has to be visited.
+         * @param leafVisitor Function that is invoked for each leaf of the visited leaf nodes.
+         */
+        void traverse(
+            std::predicate<const BoundingBox&> auto &&nodePredicate,
+            std::invocable<const Leaf&> auto &&leafVisitor
+        ) const {
+            if (nodes.empty()) return;
+
+            // Traversal runs for every frame (getDepthRange()), therefore the stack is not heap allocated.
+            std::array<std::uint32_t, MAX_TRAVERSAL_STACK_SIZE> nodeIndexStack;
+            std::uint32_t nodeIndexStackSize = 0;
+            nodeIndexStack[nodeIndexStackSize++] = 0;
+            while (nodeIndexStackSize != 0) {
+                const std::uint32_t nodeIndex = nodeIndexStack[--nodeIndexStackSize];
+
+                const Node &node = nodes[nodeIndex];
+                if (!nodePredicate(node.boundingBox)) continue;
+
+                if (node.isLeaf) {
+                    for (const Leaf &leaf : std::span { leaves }.subspan(node.firstLeafIndex, node.leafCount)) {
+                        leafVisitor(leaf);
+                    }
+                }
+                else {
+                    nodeIndexStack[nodeIndexStackSize++] = node.secondChildIndex;
+                    nodeIndexStack[nodeIndexStackSize++] = nodeIndex + 1;
+                }
+            }
+        }
+    };
+}
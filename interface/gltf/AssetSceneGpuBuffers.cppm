@@ -2,7 +2,6 @@ export module vk_gltf_viewer:gltf.AssetSceneGpuBuffers;
 
 import std;
 export import fastgltf;
-import :gltf.algorithm.traversal;
 export import :gltf.AssetPrimitiveInfo;
 export import :gltf.AssetSceneHierarchy;
 import :helpers.concepts;
@@ -11,6 +10,7 @@ import :helpers.functional;
 import :helpers.ranges;
 export import :vulkan.Gpu;
 export import :vulkan.buffer.IndirectDrawCommands;
+export import thread_pool;
 
 namespace vk_gltf_viewer::gltf {
     /**
@@ -20,11 +20,82 @@ namespace vk_gltf_viewer::gltf {
      * (like materials, vertex/index buffers, primitives, etc.), see <tt>AssetGpuBuffers</tt> for that purpose.
      */
     export class AssetSceneGpuBuffers {
+    public:
+        /**
+         * @brief Node instance and primitive of a drawn instance, which is looked up by <tt>gl_InstanceIndex</tt>.
+         */
+        struct DrawIndirection {
+            std::uint32_t nodeIndex;
+            std::uint32_t instanceIndex;  /// Index of the EXT_mesh_gpu_instancing instance in the node, or 0 if not instanced.
+            /**
+             * @brief Index of the primitive in <tt>AssetGpuBuffers::primitiveBuffer</tt>.
+             *
+             * It is <tt>AssetPrimitiveInfo::index</tt>, or the node specific index if the primitive is deformed by the node.
+             */
+            std::uint32_t primitiveIndex;
+        };
+
+        /**
+         * @brief Host written data that has to be copied into the device buffer region.
+         */
+        struct BufferUpdate {
+            vk::Buffer dstBuffer;
+            vk::DeviceSize dstOffset;
+            std::span<const std::byte> data;
+        };
+
+    private:
         const fastgltf::Asset *pAsset;
 
         std::vector<std::uint32_t> instanceCounts;
         std::vector<std::uint32_t> instanceOffsets = createInstanceOffsets();
 
+        /**
+         * @brief Cached local transform matrices of EXT_mesh_gpu_instancing instances, with the same layout as <tt>meshNodeWorldTransformBuffer</tt>.
+         *
+         * Reading instancing attribute accessors is expensive, so they are read only once at the construction. Entries of the non-instanced mesh nodes are unused.
+         */
+        std::vector<fastgltf::math::fmat4x4> instanceLocalTransforms;
+
+        /**
+         * @brief Total instance count of the nodes that use each mesh in the scene, indexed by mesh index.
+         */
+        std::vector<std::uint32_t> meshInstanceCounts;
+
+        /**
+         * @brief Offset of each mesh node's first instance in the instances of its mesh (ordered by the scene pre-order traversal), indexed by node index.
+         */
+        std::vector<std::uint32_t> meshInstanceOffsets;
+
+        /**
+         * @brief Offset of each mesh's first entry in <tt>drawIndirections</tt>, indexed by mesh index. The last element is the total entry count.
+         */
+        std::vector<std::uint32_t> meshDrawIndirectionOffsets;
+
+        /**
+         * @brief Drawn instances of the scene, grouped by (mesh, primitive).
+         *
+         * For the <tt>p</tt>-th primitive of a mesh, all instances of the nodes that use the mesh are laid out
+         * contiguously from <tt>meshDrawIndirectionOffsets[meshIndex] + p * meshInstanceCounts[meshIndex]</tt>, in the
+         * scene pre-order traversal. Therefore, the nodes that share a mesh can be drawn by a single instanced draw
+         * whose <tt>firstInstance</tt> indicates the entry of the first instance.
+         *
+         * Merged draws are not culled as a whole: <tt>CullingComputer</tt> tests each entry of a draw and compacts the
+         * visible ones into the culled draw indirection buffer, so an off-screen instance is never drawn because of
+         * its visible neighbors.
+         */
+        std::vector<DrawIndirection> drawIndirections;
+
+        /**
+         * @brief Host copy of <tt>meshNodeWorldTransformBuffer</tt>. Not updated while the GPU node transform propagation is used.
+         */
+        std::vector<fastgltf::math::fmat4x4> meshNodeWorldTransforms;
+
+        /**
+         * @brief Ranges (offset, count) in <tt>meshNodeWorldTransforms</tt> that are written by host but not copied into <tt>meshNodeWorldTransformBuffer</tt> yet.
+         */
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> dirtyMeshNodeWorldTransformRanges;
+
     public:
         /**
          * @brief Buffer that stores the mesh nodes' transform matrices, with flattened instance matrices.
@@ -36,25 +107,102 @@ namespace vk_gltf_viewer::gltf {
          * [MA * M1, MA * M2, MB * M3, MB * M4, MB * M5, MD * M6]
          * @endcode
          * Be careful that there is no transform matrix related about node C, because it is meshless.
+         *
+         * As this buffer is read by the frames in flight, host never writes it directly. It is written by the buffer
+         * copy commands of the pending updates (see <tt>getPendingBufferUpdates()</tt>) or the GPU node transform
+         * propagation, both of which are recorded in the graphics queue.
          */
-        vku::MappedBuffer meshNodeWorldTransformBuffer;
+        vku::AllocatedBuffer meshNodeWorldTransformBuffer;
 
         /**
          * @brief Buffer that stores the start address of the flattened node world transform matrices buffer.
          */
         vku::AllocatedBuffer nodeBuffer;
 
+        /**
+         * @brief Device copy of the draw indirections, which is indexed by <tt>gl_InstanceIndex</tt> in the vertex shaders.
+         *
+         * Packing node and primitive index into <tt>firstInstance</tt> limits both of them to 16-bit, therefore
+         * <tt>firstInstance</tt> is used as an index of this buffer instead.
+         */
+        vku::AllocatedBuffer drawIndirectionBuffer;
+
+        /**
+         * @brief Device resources for calculating the mesh node world transforms by compute shader, instead of host.
+         *
+         * Node local transforms and the hierarchy tables are stored in the device visible buffers, and the world transforms
+         * are calculated level by level (nodes in the same depth are processed by a single dispatch), then expanded into
+         * <tt>meshNodeWorldTransformBuffer</tt>.
+         */
+        struct GpuNodeTransformPropagation {
+            /**
+             * @brief Node local transform matrices, indexed by node index. Only changed matrices are copied from <tt>nodeLocalTransforms</tt>.
+             */
+            vku::AllocatedBuffer nodeLocalTransformBuffer;
+
+            /**
+             * @brief Node world transform matrices, indexed by node index. Written by the device, and can be copied for the host readback.
+             */
+            vku::AllocatedBuffer nodeWorldTransformBuffer;
+
+            /**
+             * @brief Scene node indices sorted by their depth. Nodes in the level <tt>i</tt> are in the range [<tt>levelOffsets[i]</tt>, <tt>levelOffsets[i + 1]</tt>).
+             */
+            vku::MappedBuffer levelOrderedNodeIndexBuffer;
+
+            /**
+             * @brief Parent node index for each node. If the node is root node, the value is as same as the node index.
+             */
+            vku::MappedBuffer parentNodeIndexBuffer;
+
+            /**
+             * @brief Node index for each flattened mesh node instance, with the same layout as <tt>meshNodeWorldTransformBuffer</tt>.
+             */
+            vku::MappedBuffer instanceNodeIndexBuffer;
+
+            /**
+             * @brief Instance local transform matrices, with the same layout as <tt>meshNodeWorldTransformBuffer</tt>.
+             */
+            vku::MappedBuffer instanceLocalTransformBuffer;
+
+            std::vector<std::uint32_t> levelOffsets;
+
+            /**
+             * @brief Host copy of <tt>nodeLocalTransformBuffer</tt>.
+             */
+            std::vector<fastgltf::math::fmat4x4> nodeLocalTransforms;
+
+            /**
+             * @brief Indices of the nodes whose local transforms are written by host but not copied into <tt>nodeLocalTransformBuffer</tt> yet.
+             */
+            std::vector<std::uint32_t> dirtyNodeIndices;
+        };
+
+        /**
+         * @brief Resources for GPU node transform propagation. <tt>std::nullopt</tt> until <tt>createGpuNodeTransformPropagation()</tt> is called.
+         */
+        std::optional<GpuNodeTransformPropagation> gpuNodeTransformPropagation;
+
         template <typename BufferDataAdapter = fastgltf::DefaultBufferDataAdapter>
         AssetSceneGpuBuffers(
             const fastgltf::Asset &asset [[clang::lifetimebound]],
             const fastgltf::Scene &scene [[clang::lifetimebound]],
             const AssetSceneHierarchy &sceneHierarchy,
             const vulkan::Gpu &gpu [[clang::lifetimebound]],
+            BS::thread_pool &threadPool,
+            concepts::compatible_signature_of<std::uint32_t, std::size_t, const fastgltf::Primitive&> auto const &primitiveIndexGetter,
             const BufferDataAdapter &adapter = {}
         ) : pAsset { &asset },
-            instanceCounts { createInstanceCounts(scene) },
-            meshNodeWorldTransformBuffer { createMeshNodeWorldTransformBuffer(scene, sceneHierarchy, gpu.allocator, adapter) },
-            nodeBuffer { createNodeBuffer(gpu) } { }
+            instanceCounts { createInstanceCounts(sceneHierarchy) },
+            instanceLocalTransforms { createInstanceLocalTransforms(sceneHierarchy, threadPool, adapter) },
+            meshInstanceCounts { createMeshInstanceCounts(sceneHierarchy) },
+            meshInstanceOffsets { createMeshInstanceOffsets(sceneHierarchy) },
+            meshDrawIndirectionOffsets { createMeshDrawIndirectionOffsets() },
+            drawIndirections { createDrawIndirections(sceneHierarchy, primitiveIndexGetter) },
+            meshNodeWorldTransforms { createMeshNodeWorldTransforms(sceneHierarchy) },
+            meshNodeWorldTransformBuffer { createMeshNodeWorldTransformBuffer(gpu) },
+            nodeBuffer { createNodeBuffer(gpu) },
+            drawIndirectionBuffer { createDrawIndirectionBuffer(gpu) } { }
 
         /**
          * @brief Get world transform matrix of \p nodeIndex-th mesh node's \p instanceIndex-th instance in the scene.
@@ -66,35 +214,244 @@ namespace vk_gltf_viewer::gltf {
          * @return World transformation matrix of the mesh node's instance, calculated by post-multiply accumulated transformation matrices from scene root.
          * @warning \p nodeIndex-th node MUST have a mesh. No exception thrown for constraint violation.
          * @warning \p instanceIndex-th instance MUST be less than the instance count of the node. No exception thrown for constraint violation.
+         * @note The result is not updated while the GPU node transform propagation is used.
+         */
+        [[nodiscard]] const fastgltf::math::fmat4x4 &getMeshNodeWorldTransform(std::uint32_t nodeIndex, std::uint32_t instanceIndex = 0) const noexcept;
+
+        /**
+         * @brief Get the node instance and primitive of the drawn instance.
+         * @param instanceIndex Instance index (<tt>firstInstance + i</tt>) of the draw command created by <tt>createIndirectDrawCommandBuffers()</tt>.
+         * @return Draw indirection of the instance.
+         */
+        [[nodiscard]] const DrawIndirection &getDrawIndirection(std::uint32_t instanceIndex) const noexcept {
+            return drawIndirections[instanceIndex];
+        }
+
+        /**
+         * @brief Get local transform matrix of \p nodeIndex-th mesh node's \p instanceIndex-th instance.
+         * @param nodeIndex Index of the mesh node.
+         * @param instanceIndex Index of the instance in the node.
+         * @return Instance local transform matrix, or identity matrix if the node doesn't use EXT_mesh_gpu_instancing.
          */
-        [[nodiscard]] const fastgltf::math::fmat4x4 &getMeshNodeWorldTransform(std::uint16_t nodeIndex, std::uint32_t instanceIndex = 0) const noexcept;
+        [[nodiscard]] const fastgltf::math::fmat4x4 &getInstanceLocalTransform(std::size_t nodeIndex, std::uint32_t instanceIndex = 0) const noexcept {
+            return instanceLocalTransforms[instanceOffsets[nodeIndex] + instanceIndex];
+        }
 
         /**
          * @brief Update the mesh node world transforms from given \p nodeIndex, to its descendants.
-         * @tparam BufferDataAdapter A functor type that acquires the binary buffer data from a glTF buffer view. If you provided <tt>fastgltf::Options::LoadExternalBuffers</tt> to the <tt>fastgltf::Parser</tt> while loading the glTF, the parameter can be omitted.
-         * @param nodeIndex Node index to be started. The target node MUST have a mesh.
+         *
+         * Only the matrix multiplications with the cached instance local transforms are performed, and the written
+         * regions are recorded as the pending updates, which have to be copied into <tt>meshNodeWorldTransformBuffer</tt>
+         * by <tt>getPendingBufferUpdates()</tt>.
+         *
+         * @param nodeIndex Node index to be started.
          * @param sceneHierarchy Scene hierarchy that contains the world transform matrices of the nodes.
-         * @param adapter Buffer data adapter.
          */
+        void updateMeshNodeTransformsFrom(std::uint32_t nodeIndex, const AssetSceneHierarchy &sceneHierarchy);
+
+        /**
+         * @brief Get the host written transforms that are not copied into <tt>meshNodeWorldTransformBuffer</tt> and <tt>gpuNodeTransformPropagation->nodeLocalTransformBuffer</tt> yet.
+         *
+         * The buffers may be read by the other frame in flight, therefore the frame copies the result into its own
+         * upload buffer and records the buffer copy commands before its reads. Dirty ranges are sorted and coalesced.
+         *
+         * @return Pending updates, grouped by their destination buffer. Their data is valid until the transforms are updated again.
+         */
+        [[nodiscard]] std::vector<BufferUpdate> getPendingBufferUpdates() const;
+
+        /**
+         * @brief Clear the pending updates, after the result of <tt>getPendingBufferUpdates()</tt> is copied by the frame.
+         */
+        void clearPendingBufferUpdates() noexcept;
+
+        /**
+         * @brief Create the device resources for GPU node transform propagation, from the current node local transforms.
+         * @param gpu GPU that is used for the buffer creation.
+         * @param sceneHierarchy Scene hierarchy of the scene.
+         */
+        void createGpuNodeTransformPropagation(const vulkan::Gpu &gpu, const AssetSceneHierarchy &sceneHierarchy);
+
+        /**
+         * @brief Write the current local transform of \p nodeIndex-th node into <tt>gpuNodeTransformPropagation->nodeLocalTransforms</tt>.
+         *
+         * The transform is recorded as the pending update (see <tt>getPendingBufferUpdates()</tt>), and the world
+         * transforms will be updated when the propagation commands are executed.
+         *
+         * @param nodeIndex Index of the node whose local transform is changed.
+         * @pre <tt>gpuNodeTransformPropagation</tt> is not <tt>std::nullopt</tt>.
+         */
+        void updateGpuNodeLocalTransform(std::size_t nodeIndex);
+
+        template <
+            std::invocable<const AssetPrimitiveInfo&> CriteriaGetter,
+            typename Compare = std::less<CriteriaGetter>,
+            typename Criteria = std::invoke_result_t<CriteriaGetter, const AssetPrimitiveInfo&>>
+        requires
+            requires(const Criteria &criteria) {
+                // Draw commands with same criteria must have same kind of index type, or no index type (multi draw
+                // indirect requires the same index type).
+                { criteria.indexType } -> std::convertible_to<std::optional<vk::IndexType>>;
+            }
+        [[nodiscard]] auto createIndirectDrawCommandBuffers(
+            vma::Allocator allocator,
+            const CriteriaGetter &criteriaGetter,
+            const std::unordered_set<std::uint32_t> &nodeIndices,
+            concepts::compatible_signature_of<const AssetPrimitiveInfo&, const fastgltf::Primitive&> auto const &primitiveInfoGetter
+        ) const -> std::map<Criteria, std::variant<vulkan::buffer::IndirectDrawCommands<false>, vulkan::buffer::IndirectDrawCommands<true>>, Compare> {
+            // Sort the mesh nodes by their mesh and their instance offset in the mesh, so that the nodes whose instances are
+            // adjacent in drawIndirections can be merged into a single instanced draw.
+            std::vector<std::uint32_t> meshNodeIndices { std::from_range, nodeIndices | std::views::filter([this](std::uint32_t nodeIndex) {
+                return pAsset->nodes[nodeIndex].meshIndex.has_value();
+            }) };
+            std::ranges::sort(meshNodeIndices, {}, [this](std::uint32_t nodeIndex) {
+                return std::pair { *pAsset->nodes[nodeIndex].meshIndex, meshInstanceOffsets[nodeIndex] };
+            });
+
+            return createIndirectDrawCommandBuffers<CriteriaGetter, Compare>(allocator, criteriaGetter, meshNodeIndices, primitiveInfoGetter, true);
+        }
+
+        /**
+         * @brief Create indirect draw command buffers that have a persistent slot for every (mesh node, primitive) pair in the scene.
+         *
+         * Slots are not merged, and each slot draws all instances of its node. Visibility changes only have to rewrite
+         * the slots by <tt>updateIndirectDrawCommandVisibilities()</tt>, without reallocating the buffers.
+         */
+        template <
+            std::invocable<const AssetPrimitiveInfo&> CriteriaGetter,
+            typename Compare = std::less<CriteriaGetter>,
+            typename Criteria = std::invoke_result_t<CriteriaGetter, const AssetPrimitiveInfo&>>
+        requires
+            requires(const Criteria &criteria) {
+                // Draw commands with same criteria must have same kind of index type, or no index type (multi draw
+                // indirect requires the same index type).
+                { criteria.indexType } -> std::convertible_to<std::optional<vk::IndexType>>;
+            }
+        [[nodiscard]] auto createPersistentIndirectDrawCommandBuffers(
+            vma::Allocator allocator,
+            const CriteriaGetter &criteriaGetter,
+            concepts::compatible_signature_of<const AssetPrimitiveInfo&, const fastgltf::Primitive&> auto const &primitiveInfoGetter
+        ) const -> std::map<Criteria, std::variant<vulkan::buffer::IndirectDrawCommands<false>, vulkan::buffer::IndirectDrawCommands<true>>, Compare> {
+            // Mesh nodes in the scene are the nodes that have nonzero instance count.
+            std::vector<std::uint32_t> meshNodeIndices { std::from_range, ranges::views::upto(static_cast<std::uint32_t>(instanceCounts.size())) | std::views::filter([this](std::uint32_t nodeIndex) {
+                return instanceCounts[nodeIndex] != 0;
+            }) };
+            std::ranges::sort(meshNodeIndices, {}, [this](std::uint32_t nodeIndex) {
+                return std::pair { *pAsset->nodes[nodeIndex].meshIndex, meshInstanceOffsets[nodeIndex] };
+            });
+
+            return createIndirectDrawCommandBuffers<CriteriaGetter, Compare>(allocator, criteriaGetter, meshNodeIndices, primitiveInfoGetter, false);
+        }
+
+        /**
+         * @brief Update the instance counts of the slots in \p indirectDrawCommands, created by <tt>createPersistentIndirectDrawCommandBuffers()</tt>, by the node visibilities.
+         *
+         * Invisible slots get zero <tt>instanceCount</tt>. Visible slots of the same primitive whose instances are
+         * adjacent are merged into the first one, and the others get zero <tt>instanceCount</tt>. After update, visible
+         * slots are moved to the front of the buffer and the draw count is set to their count. No allocation is performed.
+         *
+         * @param indirectDrawCommands Indirect draw commands to be updated. Its command order may be changed by <tt>IndirectDrawCommands::partition()</tt>.
+         * @param nodeVisibilityGetter Predicate that returns whether the node of given index is visible.
+         */
+        template <bool Indexed>
+        void updateIndirectDrawCommandVisibilities(
+            vulkan::buffer::IndirectDrawCommands<Indexed> &indirectDrawCommands,
+            std::predicate<std::uint32_t> auto const &nodeVisibilityGetter
+        ) const {
+            // Restore the slot order, which is the order of drawIndirections (mesh, primitive, instance offset in the mesh),
+            // as the commands may be reordered by the previous partitions.
+            const std::span commands = indirectDrawCommands.commands();
+            std::ranges::sort(commands, {}, &vulkan::buffer::IndirectDrawCommands<Indexed>::command_t::firstInstance);
+
+            typename vulkan::buffer::IndirectDrawCommands<Indexed>::command_t *runHead = nullptr;
+            for (auto &command : commands) {
+                const DrawIndirection &drawIndirection = drawIndirections[command.firstInstance];
+                if (!nodeVisibilityGetter(drawIndirection.nodeIndex)) {
+                    command.instanceCount = 0;
+                    continue;
+                }
+
+                const std::uint32_t instanceCount = instanceCounts[drawIndirection.nodeIndex];
+                if (runHead && runHead->firstInstance + runHead->instanceCount == command.firstInstance) {
+                    runHead->instanceCount += instanceCount;
+                    command.instanceCount = 0;
+                }
+                else {
+                    runHead = &command;
+                    command.instanceCount = instanceCount;
+                }
+            }
+
+            indirectDrawCommands.partition([](const auto &command) { return command.instanceCount != 0; });
+        }
+
+    private:
+        [[nodiscard]] std::vector<std::uint32_t> createInstanceCounts(const AssetSceneHierarchy &sceneHierarchy) const;
+        [[nodiscard]] std::vector<std::uint32_t> createInstanceOffsets() const;
+
         template <typename BufferDataAdapter = fastgltf::DefaultBufferDataAdapter>
-        void updateMeshNodeTransformsFrom(std::uint16_t nodeIndex, const AssetSceneHierarchy &sceneHierarchy, const BufferDataAdapter &adapter = {}) {
-            const std::span<fastgltf::math::fmat4x4> meshNodeWorldTransforms = meshNodeWorldTransformBuffer.asRange<fastgltf::math::fmat4x4>();
-            algorithm::traverseNode(*pAsset, nodeIndex, [&](std::size_t nodeIndex) {
+        [[nodiscard]] std::vector<fastgltf::math::fmat4x4> createInstanceLocalTransforms(
+            const AssetSceneHierarchy &sceneHierarchy,
+            BS::thread_pool &threadPool,
+            const BufferDataAdapter &adapter
+        ) const {
+            // Split the TRS composition of the large instance count node into blocks, and process them in parallel.
+            const auto composer = [&](
+                std::span<const fastgltf::math::fvec3> translations,
+                std::span<const fastgltf::math::fquat> rotations,
+                std::span<const fastgltf::math::fvec3> scales,
+                std::span<fastgltf::math::fmat4x4> result
+            ) {
+                constexpr std::size_t blockSize = 4096;
+                if (result.size() < 4 * blockSize) {
+                    fastgltf::composeTRS(translations, rotations, scales, result);
+                    return;
+                }
+
+                threadPool.submit_blocks(std::size_t { 0 }, result.size(), [&](std::size_t start, std::size_t end) {
+                    fastgltf::composeTRS(
+                        translations.subspan(start, end - start),
+                        rotations.subspan(start, end - start),
+                        scales.subspan(start, end - start),
+                        result.subspan(start, end - start));
+                }, (result.size() + blockSize - 1) / blockSize).wait();
+            };
+
+            std::vector<fastgltf::math::fmat4x4> result(instanceOffsets.back() + instanceCounts.back(), fastgltf::math::fmat4x4 { 1.f });
+            for (std::size_t nodeIndex : sceneHierarchy.getNodeIndices()) {
                 const fastgltf::Node &node = pAsset->nodes[nodeIndex];
                 if (!node.meshIndex) {
-                    return;
+                    continue;
                 }
 
-                if (std::vector instanceTransforms = getInstanceTransforms(*pAsset, node, adapter); instanceTransforms.empty()) {
-                    meshNodeWorldTransforms[instanceOffsets[nodeIndex]] = sceneHierarchy.nodeWorldTransforms[nodeIndex];
+                std::ranges::copy(getInstanceTransforms(*pAsset, node, adapter, composer), result.begin() + instanceOffsets[nodeIndex]);
+            }
+            return result;
+        }
+
+        [[nodiscard]] std::vector<std::uint32_t> createMeshInstanceCounts(const AssetSceneHierarchy &sceneHierarchy) const;
+        [[nodiscard]] std::vector<std::uint32_t> createMeshInstanceOffsets(const AssetSceneHierarchy &sceneHierarchy) const;
+        [[nodiscard]] std::vector<std::uint32_t> createMeshDrawIndirectionOffsets() const;
+
+        [[nodiscard]] std::vector<DrawIndirection> createDrawIndirections(
+            const AssetSceneHierarchy &sceneHierarchy,
+            concepts::compatible_signature_of<std::uint32_t, std::size_t, const fastgltf::Primitive&> auto const &primitiveIndexGetter
+        ) const {
+            std::vector<DrawIndirection> result(meshDrawIndirectionOffsets.back());
+            for (std::size_t nodeIndex : sceneHierarchy.getNodeIndices()) {
+                const fastgltf::Node &node = pAsset->nodes[nodeIndex];
+                if (!node.meshIndex) {
+                    continue;
                 }
-                else {
+
+                for (const auto &[primitiveIndex, primitive] : pAsset->meshes[*node.meshIndex].primitives | ranges::views::enumerate) {
+                    const std::uint32_t primitiveOrder = primitiveIndexGetter(nodeIndex, primitive);
+                    const std::uint32_t offset = meshDrawIndirectionOffsets[*node.meshIndex] + static_cast<std::uint32_t>(primitiveIndex) * meshInstanceCounts[*node.meshIndex] + meshInstanceOffsets[nodeIndex];
                     for (std::uint32_t instanceIndex : ranges::views::upto(instanceCounts[nodeIndex])) {
-                        meshNodeWorldTransforms[instanceOffsets[nodeIndex] + instanceIndex]
-                            = sceneHierarchy.nodeWorldTransforms[nodeIndex] * instanceTransforms[instanceIndex];
+                        result[offset + instanceIndex] = { static_cast<std::uint32_t>(nodeIndex), instanceIndex, primitiveOrder };
                     }
                 }
-            });
+            }
+            return result;
         }
 
         template <
@@ -110,26 +467,25 @@ namespace vk_gltf_viewer::gltf {
         [[nodiscard]] auto createIndirectDrawCommandBuffers(
             vma::Allocator allocator,
             const CriteriaGetter &criteriaGetter,
-            const std::unordered_set<std::uint16_t> &nodeIndices,
-            concepts::compatible_signature_of<const AssetPrimitiveInfo&, const fastgltf::Primitive&> auto const &primitiveInfoGetter
+            std::span<const std::uint32_t> meshNodeIndices,
+            concepts::compatible_signature_of<const AssetPrimitiveInfo&, const fastgltf::Primitive&> auto const &primitiveInfoGetter,
+            bool mergeInstances
         ) const -> std::map<Criteria, std::variant<vulkan::buffer::IndirectDrawCommands<false>, vulkan::buffer::IndirectDrawCommands<true>>, Compare> {
             std::map<Criteria, std::variant<std::vector<vk::DrawIndirectCommand>, std::vector<vk::DrawIndexedIndirectCommand>>> commandGroups;
 
-            for (std::uint16_t nodeIndex : nodeIndices) {
-                const fastgltf::Node &node = pAsset->nodes[nodeIndex];
-                if (!node.meshIndex) {
-                    continue;
-                }
-
-                // EXT_mesh_gpu_instancing support.
-                std::uint32_t instanceCount = 1;
-                if (!node.instancingAttributes.empty()) {
-                    instanceCount = pAsset->accessors[node.instancingAttributes[0].accessorIndex].count;
+            for (auto it = meshNodeIndices.begin(); it != meshNodeIndices.end();) {
+                // If merging, extend the run while the next node uses the same mesh and its instances follow the current run's.
+                const std::size_t meshIndex = *pAsset->nodes[*it].meshIndex;
+                const std::uint32_t runInstanceOffset = meshInstanceOffsets[*it];
+                std::uint32_t instanceCount = instanceCounts[*it];
+                for (++it; mergeInstances && it != meshNodeIndices.end() && *pAsset->nodes[*it].meshIndex == meshIndex && meshInstanceOffsets[*it] == runInstanceOffset + instanceCount; ++it) {
+                    instanceCount += instanceCounts[*it];
                 }
 
-                const fastgltf::Mesh &mesh = pAsset->meshes[*node.meshIndex];
-                for (const fastgltf::Primitive &primitive : mesh.primitives) {
+                const fastgltf::Mesh &mesh = pAsset->meshes[meshIndex];
+                for (const auto &[primitiveIndex, primitive] : mesh.primitives | ranges::views::enumerate) {
                     const AssetPrimitiveInfo &primitiveInfo = primitiveInfoGetter(primitive);
+                    const std::uint32_t firstInstance = meshDrawIndirectionOffsets[meshIndex] + static_cast<std::uint32_t>(primitiveIndex) * meshInstanceCounts[meshIndex] + runInstanceOffset;
                     const Criteria criteria = criteriaGetter(primitiveInfo);
                     if (const auto &indexInfo = primitiveInfo.indexInfo) {
                         const std::size_t indexByteSize = [=]() {
@@ -146,18 +502,14 @@ namespace vk_gltf_viewer::gltf {
                             .first->second;
                         const std::uint32_t firstIndex = static_cast<std::uint32_t>(primitiveInfo.indexInfo->offset / indexByteSize);
                         get_if<std::vector<vk::DrawIndexedIndirectCommand>>(&commandGroup)
-                            ->emplace_back(
-                                primitiveInfo.drawCount, instanceCount, firstIndex, 0,
-                                (static_cast<std::uint32_t>(nodeIndex) << 16U) | static_cast<std::uint32_t>(primitiveInfo.index));
+                            ->emplace_back(primitiveInfo.drawCount, instanceCount, firstIndex, 0, firstInstance);
                     }
                     else {
                         auto &commandGroup = commandGroups
                             .try_emplace(criteria, std::in_place_type<std::vector<vk::DrawIndirectCommand>>)
                             .first->second;
                         get_if<std::vector<vk::DrawIndirectCommand>>(&commandGroup)
-                            ->emplace_back(
-                                primitiveInfo.drawCount, instanceCount, 0,
-                                (static_cast<std::uint32_t>(nodeIndex) << 16U) | static_cast<std::uint32_t>(primitiveInfo.index));
+                            ->emplace_back(primitiveInfo.drawCount, instanceCount, 0, firstInstance);
                     }
                 }
             }
@@ -185,42 +537,9 @@ namespace vk_gltf_viewer::gltf {
                 | std::ranges::to<std::map<Criteria, result_type, Compare>>();
         }
 
-    private:
-        [[nodiscard]] std::vector<std::uint32_t> createInstanceCounts(const fastgltf::Scene &scene) const;
-        [[nodiscard]] std::vector<std::uint32_t> createInstanceOffsets() const;
-
-        template <typename BufferDataAdapter = fastgltf::DefaultBufferDataAdapter>
-        [[nodiscard]] vku::MappedBuffer createMeshNodeWorldTransformBuffer(
-            const fastgltf::Scene &scene,
-            const AssetSceneHierarchy &sceneHierarchy,
-            vma::Allocator allocator,
-            const BufferDataAdapter &adapter
-        ) const {
-            std::vector<fastgltf::math::fmat4x4> meshNodeWorldTransforms(instanceOffsets.back() + instanceCounts.back());
-            algorithm::traverseScene(*pAsset, scene, [&](std::size_t nodeIndex) {
-                const fastgltf::Node &node = pAsset->nodes[nodeIndex];
-                if (!node.meshIndex) {
-                    return;
-                }
-
-                if (std::vector instanceTransforms = getInstanceTransforms(*pAsset, node, adapter); instanceTransforms.empty()) {
-                    meshNodeWorldTransforms[instanceOffsets[nodeIndex]] = sceneHierarchy.nodeWorldTransforms[nodeIndex];
-                }
-                else {
-                    for (std::uint32_t instanceIndex : ranges::views::upto(instanceCounts[nodeIndex])) {
-                        meshNodeWorldTransforms[instanceOffsets[nodeIndex] + instanceIndex]
-                            = sceneHierarchy.nodeWorldTransforms[nodeIndex] * instanceTransforms[instanceIndex];
-                    }
-                }
-            });
-
-            return vku::MappedBuffer {
-                allocator,
-                std::from_range, as_bytes(std::span { meshNodeWorldTransforms }),
-                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-            };
-        }
-
+        [[nodiscard]] std::vector<fastgltf::math::fmat4x4> createMeshNodeWorldTransforms(const AssetSceneHierarchy &sceneHierarchy) const;
+        [[nodiscard]] vku::AllocatedBuffer createMeshNodeWorldTransformBuffer(const vulkan::Gpu &gpu) const;
         [[nodiscard]] vku::AllocatedBuffer createNodeBuffer(const vulkan::Gpu &gpu) const;
+        [[nodiscard]] vku::AllocatedBuffer createDrawIndirectionBuffer(const vulkan::Gpu &gpu) const;
     };
 }
\ No newline at end of file
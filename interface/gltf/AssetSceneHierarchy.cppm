@@ -2,7 +2,6 @@ export module vk_gltf_viewer:gltf.AssetSceneHierarchy;
 
 import std;
 export import fastgltf;
-import :gltf.algorithm.traversal;
 import :helpers.fastgltf;
 import :helpers.optional;
 import :helpers.ranges;
@@ -12,6 +11,11 @@ namespace vk_gltf_viewer::gltf {
      * @brief Scene hierarchy information of the glTF asset scene.
      *
      * This class contains a hierarchy of the scene nodes and their world transformation matrices.
+     *
+     * The hierarchy is flattened into a pre-order node table at construction time: every node in the scene is assigned
+     * a position such that the descendants of a node occupy the contiguous position range <tt>(position, subtree end)</tt>
+     * and every parent precedes its children. Therefore, subtree traversal, visibility propagation and descendant
+     * transform update can be done by the linear scan over contiguous arrays, without chasing <tt>fastgltf::Node::children</tt>.
      */
     export class AssetSceneHierarchy {
         const fastgltf::Asset *pAsset;
@@ -23,6 +27,26 @@ namespace vk_gltf_viewer::gltf {
          */
         std::vector<std::size_t> parentNodeIndices = createParentNodeIndices();
 
+        /**
+         * @brief Node indices in the pre-order traversal order of the scene. <tt>preorderNodeIndices[position]</tt> = (node index at the position).
+         */
+        std::vector<std::size_t> preorderNodeIndices;
+
+        /**
+         * @brief One past the last position of the subtree rooted at each position. <tt>preorderSubtreeEnds[position]</tt> = (end position of the subtree).
+         */
+        std::vector<std::size_t> preorderSubtreeEnds;
+
+        /**
+         * @brief Depth of the node at each position. Scene root nodes have depth 0.
+         */
+        std::vector<std::uint32_t> preorderDepths;
+
+        /**
+         * @brief Pre-order position of each node. <tt>preorderPositions[nodeIndex]</tt> = (position of the node), or <tt>std::numeric_limits<std::size_t>::max()</tt> if the node is not in the scene.
+         */
+        std::vector<std::size_t> preorderPositions;
+
     public:
         /**
          * @brief World transformation matrices of each node. <tt>nodeWorldTransforms[i]</tt> = (world transformation matrix of the <tt>i</tt>-th node).
@@ -30,8 +54,10 @@ namespace vk_gltf_viewer::gltf {
         std::vector<fastgltf::math::fmat4x4> nodeWorldTransforms;
 
         AssetSceneHierarchy(const fastgltf::Asset &asset, const fastgltf::Scene &scene)
-            : pAsset { &asset }
-            , nodeWorldTransforms { createNodeWorldTransforms(scene) } { }
+            : pAsset { &asset } {
+            createPreorderNodeTable(scene);
+            nodeWorldTransforms = createNodeWorldTransforms();
+        }
 
         /**
          * @brief Get parent node index from current node index.
@@ -43,6 +69,71 @@ namespace vk_gltf_viewer::gltf {
             return value_if(parentNodeIndex != nodeIndex, parentNodeIndex);
         }
 
+        /**
+         * @brief Get indices of all nodes in the scene, in the pre-order traversal order.
+         * @return Span of the node indices. Every node appears after its parent.
+         */
+        [[nodiscard]] std::span<const std::size_t> getNodeIndices() const noexcept {
+            return preorderNodeIndices;
+        }
+
+        /**
+         * @brief Get indices of the nodes in the subtree rooted at \p nodeIndex, in the pre-order traversal order.
+         * @param nodeIndex Index of the subtree root node. It MUST be in the scene.
+         * @return Span of the node indices, whose first element is \p nodeIndex.
+         */
+        [[nodiscard]] std::span<const std::size_t> getSubtreeNodeIndices(std::size_t nodeIndex) const noexcept {
+            const std::size_t position = preorderPositions[nodeIndex];
+            return std::span { preorderNodeIndices }.subspan(position, preorderSubtreeEnds[position] - position);
+        }
+
+        /**
+         * @brief Get indices of the descendant nodes of \p nodeIndex (excluding itself), in the pre-order traversal order.
+         * @param nodeIndex Index of the node. It MUST be in the scene.
+         * @return Span of the descendant node indices.
+         */
+        [[nodiscard]] std::span<const std::size_t> getDescendantNodeIndices(std::size_t nodeIndex) const noexcept {
+            return getSubtreeNodeIndices(nodeIndex).subspan(1);
+        }
+
+        /**
+         * @brief Get depth of the node in the scene hierarchy. Scene root nodes have depth 0.
+         * @param nodeIndex Index of the node. It MUST be in the scene.
+         * @return Depth of the node.
+         */
+        [[nodiscard]] std::uint32_t getNodeDepth(std::size_t nodeIndex) const noexcept {
+            return preorderDepths[preorderPositions[nodeIndex]];
+        }
+
+        /**
+         * @brief Get the nodes in \p nodeIndices that have no ancestor in \p nodeIndices.
+         *
+         * When multiple nodes' local transforms are changed at once, updating the world transforms from these nodes
+         * covers all changed nodes without visiting a subtree twice.
+         *
+         * @param nodeIndices Node indices. Nodes that are not in the scene are ignored.
+         * @return Topmost node indices, in the pre-order traversal order.
+         */
+        [[nodiscard]] std::vector<std::size_t> getTopmostNodeIndices(std::span<const std::size_t> nodeIndices) const {
+            std::vector<std::size_t> positions
+                = nodeIndices
+                | std::views::transform([&](std::size_t nodeIndex) { return preorderPositions[nodeIndex]; })
+                | std::views::filter([](std::size_t position) { return position != std::numeric_limits<std::size_t>::max(); })
+                | std::ranges::to<std::vector>();
+            std::ranges::sort(positions);
+
+            std::vector<std::size_t> result;
+            std::size_t subtreeEnd = 0;
+            for (std::size_t position : positions) {
+                // Positions inside the last added subtree are its descendants.
+                if (position < subtreeEnd) continue;
+
+                result.push_back(preorderNodeIndices[position]);
+                subtreeEnd = preorderSubtreeEnds[position];
+            }
+            return result;
+        }
+
         /**
          * @brief Update the world transform matrices of the current (specified by \p nodeIndex) and its descendant nodes.
          *
@@ -52,9 +143,66 @@ namespace vk_gltf_viewer::gltf {
          * @param worldTransform Start node world transform matrix.
          */
         void updateDescendantNodeTransformsFrom(std::size_t nodeIndex, const fastgltf::math::fmat4x4 &worldTransform) {
-            algorithm::traverseNode(*pAsset, nodeIndex, [this](std::size_t nodeIndex, const fastgltf::math::fmat4x4 &nodeWorldTransform) {
-                nodeWorldTransforms[nodeIndex] = nodeWorldTransform;
-            }, worldTransform);
+            nodeWorldTransforms[nodeIndex] = worldTransform;
+
+            // Parent always precedes its children in pre-order, therefore parent world transform is already updated.
+            for (std::size_t descendantNodeIndex : getDescendantNodeIndices(nodeIndex)) {
+                updateNodeWorldTransform(descendantNodeIndex);
+            }
+        }
+
+        /**
+         * @brief Get \p nodeIndices with all their ancestors, in the pre-order traversal order.
+         *
+         * The result can be passed to <tt>updateNodeTransformsOf()</tt> to update the world transforms of only the
+         * given nodes, without updating the whole subtrees.
+         *
+         * @param nodeIndices Node indices. Nodes that are not in the scene are ignored.
+         * @return Node indices whose every parent is also in the result.
+         */
+        [[nodiscard]] std::vector<std::size_t> getAncestorClosedNodeIndices(std::span<const std::size_t> nodeIndices) const {
+            std::vector<std::size_t> positions;
+            std::vector<bool> visited(pAsset->nodes.size());
+            for (std::size_t nodeIndex : nodeIndices) {
+                if (preorderPositions[nodeIndex] == std::numeric_limits<std::size_t>::max()) continue;
+
+                // Walk up until the already visited ancestor.
+                for (std::optional current = nodeIndex; current && !visited[*current]; current = getParentNodeIndex(*current)) {
+                    visited[*current] = true;
+                    positions.push_back(preorderPositions[*current]);
+                }
+            }
+            std::ranges::sort(positions);
+
+            return positions
+                | std::views::transform([&](std::size_t position) { return preorderNodeIndices[position]; })
+                | std::ranges::to<std::vector>();
+        }
+
+        /**
+         * @brief Update the world transform matrices of only the given nodes from their local transforms.
+         * @param ancestorClosedNodeIndices Node indices from <tt>getAncestorClosedNodeIndices()</tt>.
+         */
+        void updateNodeTransformsOf(std::span<const std::size_t> ancestorClosedNodeIndices) noexcept {
+            // Parent always precedes its children in pre-order, therefore parent world transform is already updated.
+            for (std::size_t nodeIndex : ancestorClosedNodeIndices) {
+                if (getParentNodeIndex(nodeIndex)) {
+                    updateNodeWorldTransform(nodeIndex);
+                }
+                else {
+                    nodeWorldTransforms[nodeIndex] = visit(fastgltf::visitor {
+                        [](const fastgltf::TRS &trs) { return toMatrix(trs); },
+                        [](const fastgltf::math::fmat4x4 &matrix) { return matrix; },
+                    }, pAsset->nodes[nodeIndex].transform);
+                }
+            }
+        }
+
+        /**
+         * @brief Update the world transform matrices of all nodes in the scene from their local transforms.
+         */
+        void updateNodeTransforms() {
+            nodeWorldTransforms = createNodeWorldTransforms();
         }
 
     private:
@@ -68,12 +216,60 @@ namespace vk_gltf_viewer::gltf {
             return result;
         }
 
-        [[nodiscard]] std::vector<fastgltf::math::fmat4x4> createNodeWorldTransforms(const fastgltf::Scene &scene) const noexcept {
+        void createPreorderNodeTable(const fastgltf::Scene &scene) {
+            preorderPositions.assign(pAsset->nodes.size(), std::numeric_limits<std::size_t>::max());
+
+            // Iterative DFS to avoid the stack overflow for the deep hierarchies.
+            std::vector<std::pair<std::size_t /* nodeIndex */, std::uint32_t /* depth */>> stack;
+            std::vector<std::size_t> openPositions;
+            for (std::size_t rootNodeIndex : scene.nodeIndices | std::views::reverse) {
+                stack.emplace_back(rootNodeIndex, 0U);
+            }
+            while (!stack.empty()) {
+                const auto [nodeIndex, depth] = stack.back();
+                stack.pop_back();
+
+                // Close subtrees of the positions that are not ancestors of the current node.
+                while (!openPositions.empty() && preorderDepths[openPositions.back()] >= depth) {
+                    preorderSubtreeEnds[openPositions.back()] = preorderNodeIndices.size();
+                    openPositions.pop_back();
+                }
+
+                const std::size_t position = preorderNodeIndices.size();
+                preorderPositions[nodeIndex] = position;
+                preorderNodeIndices.push_back(nodeIndex);
+                preorderSubtreeEnds.push_back(position + 1);
+                preorderDepths.push_back(depth);
+                openPositions.push_back(position);
+
+                for (std::size_t childNodeIndex : pAsset->nodes[nodeIndex].children | std::views::reverse) {
+                    stack.emplace_back(childNodeIndex, depth + 1);
+                }
+            }
+            for (std::size_t position : openPositions) {
+                preorderSubtreeEnds[position] = preorderNodeIndices.size();
+            }
+        }
+
+        [[nodiscard]] std::vector<fastgltf::math::fmat4x4> createNodeWorldTransforms() const noexcept {
             std::vector<fastgltf::math::fmat4x4> result(pAsset->nodes.size());
-            algorithm::traverseScene(*pAsset, scene, [&](std::size_t nodeIndex, const fastgltf::math::fmat4x4 &nodeWorldTransform) {
-                result[nodeIndex] = nodeWorldTransform;
-            });
+            for (std::size_t nodeIndex : preorderNodeIndices) {
+                const std::optional parentNodeIndex = getParentNodeIndex(nodeIndex);
+                const fastgltf::math::fmat4x4 &parentWorldTransform = parentNodeIndex ? result[*parentNodeIndex] : fastgltf::math::fmat4x4 { 1.f };
+                result[nodeIndex] = visit(fastgltf::visitor {
+                    [&](const fastgltf::TRS &trs) { return toMatrix(trs, parentWorldTransform); },
+                    [&](const fastgltf::math::fmat4x4 &matrix) { return parentWorldTransform * matrix; },
+                }, pAsset->nodes[nodeIndex].transform);
+            }
             return result;
         }
+
+        void updateNodeWorldTransform(std::size_t nodeIndex) noexcept {
+            const fastgltf::math::fmat4x4 &parentWorldTransform = nodeWorldTransforms[parentNodeIndices[nodeIndex]];
+            nodeWorldTransforms[nodeIndex] = visit(fastgltf::visitor {
+                [&](const fastgltf::TRS &trs) { return toMatrix(trs, parentWorldTransform); },
+                [&](const fastgltf::math::fmat4x4 &matrix) { return parentWorldTransform * matrix; },
+            }, pAsset->nodes[nodeIndex].transform);
+        }
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,91 @@
+export module vk_gltf_viewer:gltf.AssetSceneMorphTargets;
+
+import std;
+export import fastgltf;
+export import :gltf.AssetSceneHierarchy;
+
+namespace vk_gltf_viewer::gltf {
+    /**
+     * @brief Morph target weights of the morphed mesh nodes in the scene.
+     *
+     * Like skinning, morphed vertices are written into the node specific outputs (<tt>AssetGpuBuffers::deformedPrimitives</tt>),
+     * therefore every node that uses a morphed mesh has its own weights.
+     */
+    export class AssetSceneMorphTargets {
+    public:
+        struct MorphedNode {
+            std::size_t meshIndex;
+            std::size_t nodeIndex;
+
+            /**
+             * @brief Offset of the first target weight of the node in <tt>weights</tt>.
+             */
+            std::uint32_t weightOffset;
+        };
+
+        /**
+         * @brief Nodes whose mesh has morph targets in the scene.
+         */
+        std::vector<MorphedNode> morphedNodes;
+
+        /**
+         * @brief Target weights of all morphed nodes, concatenated by <tt>morphedNodes</tt> order.
+         */
+        std::vector<float> weights;
+
+        AssetSceneMorphTargets(const fastgltf::Asset &asset, const AssetSceneHierarchy &sceneHierarchy)
+            : pAsset { &asset } {
+            std::uint32_t weightCount = 0;
+            for (std::size_t nodeIndex : sceneHierarchy.getNodeIndices()) {
+                const fastgltf::Node &node = asset.nodes[nodeIndex];
+                if (!node.meshIndex) continue;
+
+                const std::size_t targetCount = getTargetCount(asset.meshes[*node.meshIndex]);
+                if (targetCount == 0) continue;
+
+                morphedNodes.emplace_back(*node.meshIndex, nodeIndex, weightCount);
+                weightCount += static_cast<std::uint32_t>(targetCount);
+            }
+
+            weights.resize(weightCount);
+            updateWeights();
+        }
+
+        /**
+         * @brief Reload <tt>weights</tt> from the current node (or mesh default) weights.
+         */
+        void updateWeights() {
+            for (const MorphedNode &morphedNode : morphedNodes) {
+                const fastgltf::Mesh &mesh = pAsset->meshes[morphedNode.meshIndex];
+                const std::span dst = std::span { weights }.subspan(morphedNode.weightOffset, getTargetCount(mesh));
+
+                // glTF Specification:
+                // When defined, mesh.weights array MUST have the same length as the targets array. [...] Node's
+                // weights, when defined, override mesh's weights.
+                const auto &nodeWeights = pAsset->nodes[morphedNode.nodeIndex].weights;
+                if (nodeWeights.size() == dst.size()) {
+                    std::ranges::copy(nodeWeights, dst.begin());
+                }
+                else if (mesh.weights.size() == dst.size()) {
+                    std::ranges::copy(mesh.weights, dst.begin());
+                }
+                else {
+                    std::ranges::fill(dst, 0.f);
+                }
+            }
+        }
+
+    private:
+        const fastgltf::Asset *pAsset;
+
+        [[nodiscard]] static std::size_t getTargetCount(const fastgltf::Mesh &mesh) noexcept {
+            // All primitives of a mesh MUST have the same number of targets.
+            for (const fastgltf::Primitive &primitive : mesh.primitives) {
+                if (!primitive.targets.empty()) {
+                    return primitive.targets.size();
+                }
+            }
+            return 0;
+        }
+    };
+}
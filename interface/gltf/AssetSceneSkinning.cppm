@@ -0,0 +1,109 @@
+export module vk_gltf_viewer:gltf.AssetSceneSkinning;
+
+import std;
+export import fastgltf;
+export import :gltf.AssetSceneHierarchy;
+import :helpers.fastgltf;
+import :helpers.ranges;
+
+namespace vk_gltf_viewer::gltf {
+    /**
+     * @brief Joint matrices of the skinned mesh nodes in the scene.
+     *
+     * Skinned vertices are written into the node specific outputs (<tt>AssetGpuBuffers::deformedPrimitives</tt>),
+     * therefore every skinned node has its own joint matrices, even if it shares the mesh with other nodes.
+     *
+     * Joint matrices are expressed in the mesh node's local space (<tt>inverse(meshNodeWorld) * jointWorld * inverseBind</tt>),
+     * because the vertex shader still applies the mesh node world transform to the skinned vertices.
+     */
+    export class AssetSceneSkinning {
+    public:
+        struct SkinnedNode {
+            std::size_t nodeIndex;
+
+            /**
+             * @brief Offset of the first joint matrix of the node's skin in <tt>jointMatrices</tt>.
+             */
+            std::uint32_t jointMatrixOffset;
+        };
+
+        /**
+         * @brief Nodes that have both mesh and skin in the scene.
+         */
+        std::vector<SkinnedNode> skinnedNodes;
+
+        /**
+         * @brief Joint matrices of all skinned nodes, concatenated by <tt>skinnedNodes</tt> order.
+         */
+        std::vector<fastgltf::math::fmat4x4> jointMatrices;
+
+        /**
+         * @brief Indices of the skinned mesh nodes and their joint nodes with all their ancestors, from <tt>AssetSceneHierarchy::getAncestorClosedNodeIndices()</tt>.
+         *
+         * Only the world transforms of these nodes are read by <tt>updateJointMatrices()</tt>, therefore updating them
+         * by <tt>AssetSceneHierarchy::updateNodeTransformsOf()</tt> is enough when the whole hierarchy is not updated.
+         */
+        std::vector<std::size_t> dependentNodeIndices;
+
+        template <typename BufferDataAdapter = fastgltf::DefaultBufferDataAdapter>
+        AssetSceneSkinning(
+            const fastgltf::Asset &asset,
+            const AssetSceneHierarchy &sceneHierarchy,
+            const BufferDataAdapter &adapter = {}
+        ) : pAsset { &asset },
+            inverseBindMatrices { std::from_range, asset.skins | std::views::transform([&](const fastgltf::Skin &skin) {
+                // glTF Specification:
+                // When undefined, each matrix is a 4x4 identity matrix.
+                std::vector<fastgltf::math::fmat4x4> result(skin.joints.size(), fastgltf::math::fmat4x4 { 1.f });
+                if (skin.inverseBindMatrices) {
+                    fastgltf::copyFromAccessor<fastgltf::math::fmat4x4>(asset, asset.accessors[*skin.inverseBindMatrices], result.data(), adapter);
+                }
+                return result;
+            }) } {
+            std::uint32_t jointMatrixCount = 0;
+            for (std::size_t nodeIndex : sceneHierarchy.getNodeIndices()) {
+                const fastgltf::Node &node = asset.nodes[nodeIndex];
+                if (!node.meshIndex || !node.skinIndex) continue;
+
+                skinnedNodes.emplace_back(nodeIndex, jointMatrixCount);
+                jointMatrixCount += static_cast<std::uint32_t>(asset.skins[*node.skinIndex].joints.size());
+            }
+
+            jointMatrices.resize(jointMatrixCount);
+            updateJointMatrices(sceneHierarchy);
+
+            std::vector<std::size_t> nodeIndices;
+            for (const SkinnedNode &skinnedNode : skinnedNodes) {
+                nodeIndices.push_back(skinnedNode.nodeIndex);
+                nodeIndices.append_range(asset.skins[*asset.nodes[skinnedNode.nodeIndex].skinIndex].joints);
+            }
+            dependentNodeIndices = sceneHierarchy.getAncestorClosedNodeIndices(nodeIndices);
+        }
+
+        /**
+         * @brief Recalculate <tt>jointMatrices</tt> from the current node world transforms.
+         * @param sceneHierarchy Scene hierarchy whose world transforms are up to date.
+         */
+        void updateJointMatrices(const AssetSceneHierarchy &sceneHierarchy) {
+            for (const SkinnedNode &skinnedNode : skinnedNodes) {
+                const std::size_t skinIndex = *pAsset->nodes[skinnedNode.nodeIndex].skinIndex;
+                const fastgltf::math::fmat4x4 inverseMeshNodeWorldTransform
+                    = fastgltf::math::affineInverse(sceneHierarchy.nodeWorldTransforms[skinnedNode.nodeIndex]);
+                for (const auto &[i, jointNodeIndex] : pAsset->skins[skinIndex].joints | ranges::views::enumerate) {
+                    jointMatrices[skinnedNode.jointMatrixOffset + i]
+                        = inverseMeshNodeWorldTransform
+                        * sceneHierarchy.nodeWorldTransforms[jointNodeIndex]
+                        * inverseBindMatrices[skinIndex][i];
+                }
+            }
+        }
+
+    private:
+        const fastgltf::Asset *pAsset;
+
+        /**
+         * @brief Inverse bind matrices of each skin. <tt>inverseBindMatrices[skinIndex][i]</tt> = (inverse bind matrix of the <tt>i</tt>-th joint).
+         */
+        std::vector<std::vector<fastgltf::math::fmat4x4>> inverseBindMatrices;
+    };
+}
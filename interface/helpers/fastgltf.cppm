@@ -169,18 +169,59 @@ namespace fastgltf {
         return adapter(asset, *accessor.bufferViewIndex).subspan(accessor.byteOffset, byteStride * accessor.count);
     }
 
+    /**
+     * @brief Convert the batch of TRS into 4x4 matrices.
+     *
+     * It is equivalent to <tt>translate(I, translations[i]) * rotate(I, rotations[i]) * scale(I, scales[i])</tt>, but
+     * directly evaluates the closed form of the rotation matrix with the scale folded into its columns, which saves the
+     * three matrix products per instance. It is a plain scalar loop over the array-of-structures inputs, and is not
+     * explicitly vectorized.
+     *
+     * @param translations Translations.
+     * @param rotations Unit quaternion rotations.
+     * @param scales Scales.
+     * @param result Output matrices. All spans must have the same size.
+     */
+    export void composeTRS(
+        std::span<const math::fvec3> translations,
+        std::span<const math::fquat> rotations,
+        std::span<const math::fvec3> scales,
+        std::span<math::fmat4x4> result
+    ) noexcept {
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            const float x = rotations[i].x(), y = rotations[i].y(), z = rotations[i].z(), w = rotations[i].w();
+            const float xx = x * x, yy = y * y, zz = z * z;
+            const float xy = x * y, xz = x * z, yz = y * z;
+            const float wx = w * x, wy = w * y, wz = w * z;
+            const float sx = scales[i].x(), sy = scales[i].y(), sz = scales[i].z();
+            result[i] = math::fmat4x4 {
+                math::fvec4 { sx * (1.f - 2.f * (yy + zz)), sx * 2.f * (xy + wz), sx * 2.f * (xz - wy), 0.f },
+                math::fvec4 { sy * 2.f * (xy - wz), sy * (1.f - 2.f * (xx + zz)), sy * 2.f * (yz + wx), 0.f },
+                math::fvec4 { sz * 2.f * (xz + wy), sz * 2.f * (yz - wx), sz * (1.f - 2.f * (xx + yy)), 0.f },
+                math::fvec4 { translations[i].x(), translations[i].y(), translations[i].z(), 1.f },
+            };
+        }
+    }
+
     /**
      * @brief Get transform matrices of \p node instances.
      *
      * @tparam BufferDataAdapter A functor type that acquires the binary buffer data from a glTF buffer view. If you provided <tt>fastgltf::Options::LoadExternalBuffers</tt> to the <tt>fastgltf::Parser</tt> while loading the glTF, the parameter can be omitted.
+     * @tparam Composer A function type that has the same signature as <tt>composeTRS</tt>.
      * @param asset fastgltf asset.
      * @param node Node to get instance transforms. This MUST be originated from the \p asset.
      * @param adapter Buffer data adapter.
+     * @param composer Function that is invoked with <tt>(translations, rotations, scales, result)</tt> spans and fills \p result. Default: <tt>composeTRS</tt>.
      * @return A vector of instance transform matrices.
      * @note This function has effect only if \p asset is loaded with EXT_mesh_gpu_instancing extension supporting parser (otherwise, it will return the empty vector).
      */
-    export template <typename BufferDataAdapter = DefaultBufferDataAdapter>
-    [[nodiscard]] std::vector<math::fmat4x4> getInstanceTransforms(const Asset &asset, const Node &node, const BufferDataAdapter &adapter = {}) {
+    export template <typename BufferDataAdapter = DefaultBufferDataAdapter, typename Composer = decltype(&composeTRS)>
+    [[nodiscard]] std::vector<math::fmat4x4> getInstanceTransforms(
+        const Asset &asset,
+        const Node &node,
+        const BufferDataAdapter &adapter = {},
+        const Composer &composer = composeTRS
+    ) {
         if (node.instancingAttributes.empty()) {
             // No instance transforms. Returning an empty vector.
             return {};
@@ -220,19 +261,14 @@ namespace fastgltf {
             }
         }
 
-        std::vector<math::fvec3> scale(instanceCount);
+        std::vector<math::fvec3> scale(instanceCount, math::fvec3 { 1.f, 1.f, 1.f });
         if (auto it = node.findInstancingAttribute("SCALE"); it != node.instancingAttributes.end()) {
             const Accessor &accessor = asset.accessors[it->accessorIndex];
             fastgltf::copyFromAccessor<math::fvec3>(asset, accessor, scale.data(), adapter);
         }
 
-        std::vector<math::fmat4x4> result;
-        result.reserve(instanceCount);
-        for (std::uint32_t i = 0; i < instanceCount; ++i) {
-            constexpr math::fmat4x4 identity { 1.f };
-            result.push_back(translate(identity, translations[i]) * rotate(identity, rotations[i]) * math::scale(identity, scale[i]));
-        }
-
+        std::vector<math::fmat4x4> result(instanceCount);
+        composer(std::span<const math::fvec3> { translations }, std::span<const math::fquat> { rotations }, std::span<const math::fvec3> { scale }, std::span { result });
         return result;
     }
 
@@ -252,6 +288,23 @@ namespace fastgltf {
     }
 
 namespace math {
+    /**
+     * @brief Inverse of the affine transform matrix, which is cheaper than the general 4x4 matrix inverse.
+     * @param m Affine transform matrix (last row must be (0, 0, 0, 1)).
+     * @return Inverse matrix.
+     */
+    // TODO: replace this function with fastgltf provided if it exported.
+    export template <typename T>
+    [[nodiscard]] mat<T, 4, 4> affineInverse(const mat<T, 4, 4> &m) noexcept {
+        const auto inv = inverse(mat<T, 3, 3>(m));
+        const auto l = -inv * vec<T, 3>(m.col(3));
+        return mat<T, 4, 4>(
+            vec<T, 4>(inv.col(0).x(), inv.col(0).y(), inv.col(0).z(), 0.f),
+            vec<T, 4>(inv.col(1).x(), inv.col(1).y(), inv.col(1).z(), 0.f),
+            vec<T, 4>(inv.col(2).x(), inv.col(2).y(), inv.col(2).z(), 0.f),
+            vec<T, 4>(l.x(), l.y(), l.z(), 1.f));
+    }
+
     /**
      * @brief Convert matrix of type \tp U to matrix of type \tp T.
      * @tparam T The destination matrix type.
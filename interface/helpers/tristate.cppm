@@ -10,23 +10,23 @@ import std;
 
 namespace tristate {
     /**
-     * Propagate the current node (in \p nodeIndex) state to all its children.
-     * @param childIndicesGetter A function that returns the children indices of a node with the given index.
+     * Propagate the current node (in \p nodeIndex) state to all its descendants.
+     * @param descendantIndices Indices of all descendants of the current node (not only the direct children).
      * @param nodeIndex Current node index.
      * @param tristates Tri-state values of all nodes. Indeterminate state is represented by <tt>std::nullopt</tt>.
      * @note It asserts that the current node state is not indeterminate(<tt>std::nullopt</tt>).
-     * @note This function is a recursive function, and will be terminated when all children have been visited.
+     * @note As all descendants are set to the same state, traversal order of \p descendantIndices does not matter. Passing
+     * a contiguous range (e.g. a subtree range of a flattened pre-order node table) makes this a linear scan.
      */
     export auto propagateTopDown(
-        std::invocable<std::size_t> auto &&childIndicesGetter,
+        std::ranges::input_range auto &&descendantIndices,
         std::size_t nodeIndex,
         std::span<std::optional<bool>> tristates
     ) -> void {
-        const auto &currentState = tristates[nodeIndex];
+        const std::optional<bool> currentState = tristates[nodeIndex];
         assert(currentState.has_value() && "Indeterminate state cannot be propagated top-down.");
-        for (std::size_t childNodeIndex : childIndicesGetter(nodeIndex)) {
-            tristates[childNodeIndex] = currentState;
-            propagateTopDown(childIndicesGetter, childNodeIndex, tristates);
+        for (std::size_t descendantIndex : descendantIndices) {
+            tristates[descendantIndex] = currentState;
         }
     }
 
@@ -0,0 +1,76 @@
+export module vk_gltf_viewer:math.octahedral;
+
+import std;
+export import glm;
+
+namespace vk_gltf_viewer::math {
+    /**
+     * @brief Map the unit vector to the 2-dimensional octahedral coordinate in [-1, 1]^2.
+     * @param v Unit vector.
+     * @return Octahedral coordinate.
+     * @see https://jcgt.org/published/0003/02/01/ (A Survey of Efficient Representations for Independent Unit Vectors)
+     */
+    [[nodiscard]] glm::vec2 toOctahedral(const glm::vec3 &v) noexcept {
+        glm::vec2 p = glm::vec2 { v } / (std::abs(v.x) + std::abs(v.y) + std::abs(v.z));
+        if (v.z < 0.f) {
+            p = (1.f - glm::abs(glm::vec2 { p.y, p.x })) * glm::vec2 { p.x >= 0.f ? 1.f : -1.f, p.y >= 0.f ? 1.f : -1.f };
+        }
+        return p;
+    }
+
+    /**
+     * @brief Inverse of <tt>toOctahedral</tt>.
+     * @param p Octahedral coordinate in [-1, 1]^2.
+     * @return Unit vector.
+     */
+    [[nodiscard]] glm::vec3 fromOctahedral(const glm::vec2 &p) noexcept {
+        glm::vec3 v { p, 1.f - std::abs(p.x) - std::abs(p.y) };
+        if (v.z < 0.f) {
+            const glm::vec2 xy = (1.f - glm::abs(glm::vec2 { v.y, v.x })) * glm::vec2 { v.x >= 0.f ? 1.f : -1.f, v.y >= 0.f ? 1.f : -1.f };
+            v.x = xy.x;
+            v.y = xy.y;
+        }
+        return glm::normalize(v);
+    }
+
+    /**
+     * @brief Encode the unit normal vector into 32-bit integer (two 16-bit snorm octahedral coordinates).
+     *
+     * It can be decoded with <tt>unpackSnorm2x16</tt> and octahedral inverse mapping in the shader.
+     *
+     * @param normal Unit normal vector.
+     * @return Encoded normal.
+     */
+    export
+    [[nodiscard]] std::uint32_t encodeOctahedralNormal(const glm::vec3 &normal) noexcept {
+        return glm::packSnorm2x16(toOctahedral(normal));
+    }
+
+    export
+    [[nodiscard]] glm::vec3 decodeOctahedralNormal(std::uint32_t encoded) noexcept {
+        return fromOctahedral(glm::unpackSnorm2x16(encoded));
+    }
+
+    /**
+     * @brief Encode the tangent (xyz: unit tangent vector, w: bitangent sign) into 32-bit integer.
+     *
+     * Bit layout: [0, 16) = 16-bit snorm octahedral x, [16, 31) = 15-bit snorm octahedral y, [31] = 1 if w is negative.
+     *
+     * @param tangent Tangent vector with bitangent sign at w component.
+     * @return Encoded tangent.
+     */
+    export
+    [[nodiscard]] std::uint32_t encodeOctahedralTangent(const glm::vec4 &tangent) noexcept {
+        const glm::vec2 p = toOctahedral(glm::vec3 { tangent });
+        const auto x = static_cast<std::uint32_t>(glm::packSnorm2x16(p) & 0xFFFFU);
+        const auto y = static_cast<std::uint32_t>(std::round((std::clamp(p.y, -1.f, 1.f) * 0.5f + 0.5f) * 32767.f));
+        return x | (y << 16U) | (tangent.w < 0.f ? 0x80000000U : 0U);
+    }
+
+    export
+    [[nodiscard]] glm::vec4 decodeOctahedralTangent(std::uint32_t encoded) noexcept {
+        const float x = glm::unpackSnorm2x16(encoded).x;
+        const float y = static_cast<float>((encoded >> 16U) & 0x7FFFU) / 32767.f * 2.f - 1.f;
+        return { fromOctahedral({ x, y }), (encoded & 0x80000000U) ? -1.f : 1.f };
+    }
+}
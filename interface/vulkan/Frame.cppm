@@ -7,6 +7,9 @@ export module vk_gltf_viewer:vulkan.Frame;
 import std;
 export import :gltf.AssetGpuBuffers;
 export import :gltf.AssetSceneGpuBuffers;
+export import :gltf.AssetSceneMorphTargets;
+export import :gltf.AssetSceneSkinning;
+export import thread_pool;
 export import :math.Frustum;
 export import :vulkan.SharedData;
 import :vulkan.ag.DepthPrepass;
@@ -20,19 +23,29 @@ namespace vk_gltf_viewer::vulkan {
         struct ExecutionTask {
             struct Gltf {
                 struct RenderingNodes {
-                    std::unordered_set<std::uint16_t> indices;
+                    const std::unordered_set<std::uint32_t> &indices;
+
+                    /**
+                     * @brief Version of the scene. Draw command slots are regenerated only if it is different from the previous one.
+                     */
+                    std::uint64_t sceneVersion;
+
+                    /**
+                     * @brief Version of \p indices. Draw command slots are updated in place only if it is different from the previous one.
+                     */
+                    std::uint64_t version;
                     bool shouldRegenerateDrawCommands;
                 };
 
                 struct HoveringNode {
-                    std::uint16_t index;
+                    std::uint32_t index;
                     glm::vec4 outlineColor;
                     float outlineThickness;
                     bool shouldRegenerateDrawCommands;
                 };
 
                 struct SelectedNodes {
-                    const std::unordered_set<std::uint16_t>& indices;
+                    const std::unordered_set<std::uint32_t>& indices;
                     glm::vec4 outlineColor;
                     float outlineThickness;
                     bool shouldRegenerateDrawCommands;
@@ -42,9 +55,29 @@ namespace vk_gltf_viewer::vulkan {
                 const gltf::AssetGpuBuffers &assetGpuBuffers;
                 const gltf::AssetSceneHierarchy &sceneHierarchy;
                 const gltf::AssetSceneGpuBuffers &sceneGpuBuffers;
+                const gltf::AssetSceneSkinning &sceneSkinning;
+                const gltf::AssetSceneMorphTargets &sceneMorphTargets;
+
+                /**
+                 * @brief Whether the mesh node world transforms have to be calculated from <tt>sceneGpuBuffers.gpuNodeTransformPropagation</tt> in this frame.
+                 */
+                bool shouldPropagateNodeWorldTransforms;
+
+                /**
+                 * @brief Whether the morphed and skinned primitives have to be re-deformed from <tt>sceneMorphTargets.weights</tt> and <tt>sceneSkinning.jointMatrices</tt> in this frame.
+                 */
+                bool shouldDeformMeshes;
+
                 RenderingNodes renderingNodes;
                 std::optional<HoveringNode> hoveringNode;
                 std::optional<SelectedNodes> selectedNodes;
+
+                /**
+                 * @brief Sorted indices of the nodes that may be under the cursor, i.e. the rendering nodes whose
+                 * bounding boxes are intersected by the ray through the cursor. Only they are drawn in the mouse picking
+                 * pass. Ignored if <tt>ExecutionTask::cursorPosFromPassthruRectTopLeft</tt> is <tt>std::nullopt</tt>.
+                 */
+                std::span<const std::uint32_t> mousePickingNodeIndices;
             };
 
             vk::Rect2D passthruRect;
@@ -61,6 +94,23 @@ namespace vk_gltf_viewer::vulkan {
              */
             std::optional<math::Frustum> frustum;
 
+            /**
+             * @brief Whether the instances occluded by the instances visible in the last frame would be culled, by the
+             * two-phase hierarchical depth occlusion culling. Ignored if <tt>frustum</tt> is <tt>std::nullopt</tt>.
+             */
+            bool useOcclusionCulling;
+
+            /**
+             * @brief Whether the command buffers would be recorded concurrently by the command recording thread pool.
+             */
+            bool useMultithreadedCommandRecording;
+
+            /**
+             * @brief Whether the depths of the alphaMode=Opaque and Mask primitives would be rendered before their shading,
+             * so that only the visible fragments are shaded by the equal depth test.
+             */
+            bool useFullDepthPrepass;
+
             /**
              * @brief Cursor position from passthru rect's top left. <tt>std::nullopt</tt> if cursor is outside the passthru rect.
              */
@@ -78,16 +128,61 @@ namespace vk_gltf_viewer::vulkan {
              * This MUST be <tt>true</tt> if previous frame's execution result (obtained by <tt>Frame::execute()</tt>) is <tt>false</tt>.
              */
             bool handleSwapchainResize;
+
+            /**
+             * @brief Whether the cached scene rendering commands have to be re-recorded.
+             *
+             * This MUST be <tt>true</tt> if any descriptor set or pipeline used by the scene rendering pass (i.e.
+             * <tt>SharedData::assetDescriptorSet</tt>, <tt>SharedData::sceneDescriptorSet</tt>,
+             * <tt>SharedData::imageBasedLightingDescriptorSet</tt>, <tt>SharedData::skyboxDescriptorSet</tt> or the
+             * primitive pipelines) is changed after the previous execution of this frame. Changes that are detected by
+             * the frame itself (draw command regeneration, rendering node visibilities, frustum culling, passthru rect and
+             * background type) do not have to be notified.
+             */
+            bool invalidateSceneRenderingCommands;
         };
 
         struct UpdateResult {
+            /**
+             * @brief Pipeline statistics of the scene opaque subpass, which renders the alphaMode=Opaque and Mask
+             * primitives (including their depth prepass) and the skybox.
+             */
+            struct OpaqueSubpassStatistics {
+                std::uint64_t vertexShaderInvocations;
+                std::uint64_t fragmentShaderInvocations;
+            };
+
             /**
              * @brief Node index of the current pointing mesh. <tt>std::nullopt</tt> if there is no mesh under the cursor.
              */
-            std::optional<std::uint16_t> hoveringNodeIndex;
+            std::optional<std::uint32_t> hoveringNodeIndex;
+
+            /**
+             * @brief Instance counts of the occlusion test in the previous execution of this frame. <tt>std::nullopt</tt> if occlusion culling was not performed.
+             */
+            std::optional<CullingComputer::Statistics> occlusionCullingStatistics;
+
+            /**
+             * @brief Pipeline statistics of the previous execution of this frame. <tt>std::nullopt</tt> if the pipeline statistics query is not supported.
+             */
+            std::optional<OpaqueSubpassStatistics> opaqueSubpassStatistics;
+
+            /**
+             * @brief Node world transforms calculated by the GPU node transform propagation in the previous execution of
+             * this frame, indexed by node index. <tt>std::nullopt</tt> if the propagation was not performed.
+             *
+             * The span is valid until the next <tt>recordCommandsAndSubmit()</tt> call of this frame.
+             */
+            std::optional<std::span<const fastgltf::math::fmat4x4>> nodeWorldTransforms;
         };
 
-        Frame(const Gpu &gpu [[clang::lifetimebound]], const SharedData &sharedData [[clang::lifetimebound]]);
+        /**
+         * @brief Construct the frame.
+         * @param gpu GPU.
+         * @param sharedData Resources that are shared by all frames.
+         * @param commandRecordingThreadPool Worker threads that record the command buffers concurrently. It can be shared by the frames, as they are recorded one at a time.
+         */
+        Frame(const Gpu &gpu [[clang::lifetimebound]], const SharedData &sharedData [[clang::lifetimebound]], BS::thread_pool &commandRecordingThreadPool [[clang::lifetimebound]]);
 
         /**
          * @brief Wait for the previous frame execution to finish.
@@ -102,7 +197,12 @@ namespace vk_gltf_viewer::vulkan {
 
         UpdateResult update(const ExecutionTask &task);
 
-        void recordCommandsAndSubmit(std::uint32_t swapchainImageIndex) const;
+        /**
+         * @brief Record the frame commands and submit them.
+         * @param swapchainImageIndex Index of the swapchain image to be rendered.
+         * @return Elapsed time of the command recording in the host.
+         */
+        std::chrono::nanoseconds recordCommandsAndSubmit(std::uint32_t swapchainImageIndex);
 
         /**
          * @brief Frame exclusive semaphore that have to be signaled when the swapchain image is acquired.
@@ -161,16 +261,30 @@ namespace vk_gltf_viewer::vulkan {
                 JumpFloodResources(const Gpu &gpu [[clang::lifetimebound]], const vk::Extent2D &extent);
             };
 
+            struct DepthPyramidResources {
+                vku::AllocatedImage image;
+                vk::raii::ImageView imageView;
+                std::vector<vk::raii::ImageView> mipImageViews;
+
+                DepthPyramidResources(const Gpu &gpu [[clang::lifetimebound]], const vk::Extent2D &extent);
+            };
+
             vk::Extent2D extent;
 
             JumpFloodResources hoveringNodeOutlineJumpFloodResources;
             JumpFloodResources selectedNodeOutlineJumpFloodResources;
+            DepthPyramidResources depthPyramidResources;
 
             // Attachment groups.
             ag::DepthPrepass depthPrepassAttachmentGroup;
             ag::JumpFloodSeed hoveringNodeJumpFloodSeedAttachmentGroup;
             ag::JumpFloodSeed selectedNodeJumpFloodSeedAttachmentGroup;
 
+            /**
+             * @brief 1x1 node index and depth attachments for the mouse picking, whose only pixel is the one under the cursor.
+             */
+            ag::DepthPrepass mousePickingAttachmentGroup;
+
             PassthruResources(const Gpu &gpu [[clang::lifetimebound]], const vk::Extent2D &extent, vk::CommandBuffer graphicsCommandBuffer);
 
         private:
@@ -178,29 +292,97 @@ namespace vk_gltf_viewer::vulkan {
         };
 
         struct RenderingNodes {
-            std::unordered_set<std::uint16_t> indices;
+            std::uint64_t sceneVersion;
+            std::uint64_t version;
+
+            /**
+             * @brief Persistent draw command slots of the scene, created by <tt>AssetSceneGpuBuffers::createPersistentIndirectDrawCommandBuffers()</tt>.
+             */
             CriteriaSeparatedIndirectDrawCommands indirectDrawCommandBuffers;
+
+            /**
+             * @brief Draw commands written by <tt>CullingComputer</tt> from <tt>indirectDrawCommandBuffers</tt>, with the same keys.
+             */
+            CriteriaSeparatedIndirectDrawCommands culledIndirectDrawCommandBuffers;
+
+            /**
+             * @brief Visible draw indirections written by <tt>CullingComputer</tt>, with the same layout as <tt>AssetSceneGpuBuffers::drawIndirectionBuffer</tt>.
+             */
+            vku::AllocatedBuffer culledDrawIndirectionBuffer;
+
+            /**
+             * @brief Draw commands of the instances visible in the last occlusion test, written by the first phase of the occlusion culling.
+             */
+            CriteriaSeparatedIndirectDrawCommands previouslyVisibleIndirectDrawCommandBuffers;
+
+            /**
+             * @brief Draw indirections of the instances visible in the last occlusion test, written by the first phase of the occlusion culling.
+             */
+            vku::AllocatedBuffer previouslyVisibleDrawIndirectionBuffer;
+
+            /**
+             * @brief Visibility bit of each draw indirection in the last occlusion test. Initially all bits are set, so
+             * that the first depth pyramid is built from all instances inside the frustum.
+             */
+            vku::MappedBuffer instanceVisibilityBuffer;
+
+            /**
+             * @brief Whether the draw commands are culled by the frustum in this frame. If <tt>true</tt>, <tt>culledIndirectDrawCommandBuffers</tt> are drawn with <tt>Frame::culledSceneDescriptorSet</tt>.
+             */
+            bool frustumCulled;
+
+            /**
+             * @brief Whether the draw commands are also culled by the occlusion in this frame. Only meaningful if <tt>frustumCulled</tt> is <tt>true</tt>.
+             */
+            bool occlusionCulled;
+
+            [[nodiscard]] const CriteriaSeparatedIndirectDrawCommands &getDrawnIndirectDrawCommandBuffers() const noexcept {
+                return frustumCulled ? culledIndirectDrawCommandBuffers : indirectDrawCommandBuffers;
+            }
         };
 
         struct SelectedNodes {
-            std::unordered_set<std::uint16_t> indices;
+            std::unordered_set<std::uint32_t> indices;
             CriteriaSeparatedIndirectDrawCommands indirectDrawCommandBuffers;
             glm::vec4 outlineColor;
             float outlineThickness;
         };
 
         struct HoveringNode {
-            std::uint16_t index;
+            std::uint32_t index;
             CriteriaSeparatedIndirectDrawCommands indirectDrawCommandBuffers;
             glm::vec4 outlineColor;
             float outlineThickness;
         };
 
+        struct MousePickingNodes {
+            std::uint64_t sceneVersion;
+
+            /**
+             * @brief Sorted indices of the nodes that are visible in <tt>indirectDrawCommandBuffers</tt>. The mouse picking pass is skipped if empty.
+             */
+            std::vector<std::uint32_t> indices;
+
+            /**
+             * @brief Persistent draw command slots of the scene, like <tt>RenderingNodes::indirectDrawCommandBuffers</tt>.
+             */
+            CriteriaSeparatedIndirectDrawCommands indirectDrawCommandBuffers;
+        };
+
         const Gpu &gpu;
         const SharedData &sharedData;
+        BS::thread_pool &commandRecordingThreadPool;
 
         // Buffer, image and image views.
         vku::MappedBuffer hoveringNodeIndexBuffer;
+        vku::MappedBuffer cullingParameterBuffer;
+        vku::MappedBuffer occlusionCullingStatisticsBuffer;
+        vku::MappedBuffer cameraBuffer; // pl::Primitive::Camera, referenced by the cached scene rendering commands.
+        vku::MappedBuffer skyboxProjectionViewBuffer; // Translationless projection view matrix, referenced by the cached skybox draw command.
+        std::optional<vku::MappedBuffer> jointMatrixBuffer; // Grown on demand.
+        std::optional<vku::MappedBuffer> morphTargetWeightBuffer; // Grown on demand.
+        std::optional<vku::MappedBuffer> nodeTransformUploadBuffer; // Source of nodeTransformBufferCopies, grown on demand.
+        std::optional<vku::MappedBuffer> nodeWorldTransformReadbackBuffer; // Recreated if the node count is changed.
         std::optional<PassthruResources> passthruResources = std::nullopt;
 
         // Attachment groups.
@@ -214,6 +396,11 @@ namespace vk_gltf_viewer::vulkan {
         vk::raii::DescriptorPool descriptorPool = createDescriptorPool();
         vk::raii::CommandPool computeCommandPool { gpu.device, vk::CommandPoolCreateInfo { {}, gpu.queueFamilies.compute } };
         vk::raii::CommandPool graphicsCommandPool { gpu.device, vk::CommandPoolCreateInfo { {}, gpu.queueFamilies.graphicsPresent } };
+        vk::raii::CommandPool scenePrepassCommandPool { gpu.device, vk::CommandPoolCreateInfo { {}, gpu.queueFamilies.graphicsPresent } }; // Separated from graphicsCommandPool for the concurrent recording.
+        vk::raii::CommandPool sceneSubpassCommandPool { gpu.device, vk::CommandPoolCreateInfo { vk::CommandPoolCreateFlagBits::eResetCommandBuffer, gpu.queueFamilies.graphicsPresent } }; // Not reset per frame, as its command buffers are reused.
+
+        // Query pools.
+        std::optional<vk::raii::QueryPool> opaqueSubpassStatisticsQueryPool = createOpaqueSubpassStatisticsQueryPool(); // std::nullopt if the pipeline statistics query is not supported.
 
         // Descriptor sets.
         vku::DescriptorSet<JumpFloodComputer::DescriptorSetLayout> hoveringNodeJumpFloodSet;
@@ -221,12 +408,19 @@ namespace vk_gltf_viewer::vulkan {
         vku::DescriptorSet<OutlineRenderer::DescriptorSetLayout> hoveringNodeOutlineSet;
         vku::DescriptorSet<OutlineRenderer::DescriptorSetLayout> selectedNodeOutlineSet;
         vku::DescriptorSet<WeightedBlendedCompositionRenderer::DescriptorSetLayout> weightedBlendedCompositionSet;
+        vku::DescriptorSet<dsl::Scene> culledSceneDescriptorSet; // Scene descriptor set with RenderingNodes::culledDrawIndirectionBuffer.
+        vku::DescriptorSet<dsl::Scene> previouslyVisibleSceneDescriptorSet; // Scene descriptor set with RenderingNodes::previouslyVisibleDrawIndirectionBuffer.
+        vku::DescriptorSet<DepthPyramidComputer::DescriptorSetLayout> depthPyramidSet;
+        vku::DescriptorSet<CullingComputer::DescriptorSetLayout> cullingSet;
 
         // Command buffers.
         vk::CommandBuffer scenePrepassCommandBuffer;
         vk::CommandBuffer sceneRenderingCommandBuffer;
+        vk::CommandBuffer sceneOpaqueSubpassCommandBuffer; // Secondary, reused while sceneSubpassCommandsOutdated is false.
+        vk::CommandBuffer sceneBlendSubpassCommandBuffer; // Secondary, reused while sceneSubpassCommandsOutdated is false.
         vk::CommandBuffer compositionCommandBuffer;
         vk::CommandBuffer jumpFloodCommandBuffer;
+        vk::CommandBuffer deformationCommandBuffer;
 
         // Synchronization stuffs.
         vk::raii::Semaphore scenePrepassFinishSema { gpu.device, vk::SemaphoreCreateInfo{} };
@@ -234,28 +428,52 @@ namespace vk_gltf_viewer::vulkan {
         vk::raii::Semaphore sceneRenderingFinishSema { gpu.device, vk::SemaphoreCreateInfo{} };
         vk::raii::Semaphore compositionFinishSema { gpu.device, vk::SemaphoreCreateInfo{} };
         vk::raii::Semaphore jumpFloodFinishSema { gpu.device, vk::SemaphoreCreateInfo{} };
+        vk::raii::Semaphore scenePrepassDeformationFinishSema { gpu.device, vk::SemaphoreCreateInfo{} };
+        vk::raii::Semaphore sceneRenderingDeformationFinishSema { gpu.device, vk::SemaphoreCreateInfo{} };
         vk::raii::Fence inFlightFence { gpu.device, vk::FenceCreateInfo { vk::FenceCreateFlagBits::eSignaled } };
 
         vk::Rect2D passthruRect;
         glm::mat4 projectionViewMatrix;
-        glm::vec3 viewPosition;
-        glm::mat4 translationlessProjectionViewMatrix;
         std::optional<vk::Offset2D> cursorPosFromPassthruRectTopLeft;
+        bool useMultithreadedCommandRecording;
+        bool useFullDepthPrepass = false;
         std::unordered_map<vk::IndexType, vk::Buffer> indexBuffers;
         std::optional<RenderingNodes> renderingNodes;
         std::optional<SelectedNodes> selectedNodes;
         std::optional<HoveringNode> hoveringNode;
+        std::optional<MousePickingNodes> mousePickingNodes; // std::nullopt until the cursor is in the passthru rect with any node to be picked.
+        std::vector<std::pair<vk::Buffer, vk::BufferCopy>> nodeTransformBufferCopies; // (destination buffer, region) copied from nodeTransformUploadBuffer. Empty if no transform is changed in this frame.
+        std::optional<NodeWorldTransformComputer::PropagationInfo> nodeWorldTransformPropagationInfo;
+        vk::Buffer nodeWorldTransformBuffer; // Source of the readback copy. Only meaningful if nodeWorldTransformPropagationInfo is not std::nullopt.
+        std::vector<MorphTargetComputer::PushConstant> morphTargetPushConstants; // Empty if morph target blending is not performed in this frame.
+        std::vector<SkinningComputer::PushConstant> skinningPushConstants; // Empty if skinning is not performed in this frame.
+        std::vector<CullingComputer::PushConstant> cullingPushConstants; // Empty if frustum culling is not performed in this frame.
+        std::vector<CullingComputer::PushConstant> previouslyVisibleCullingPushConstants; // Empty if occlusion culling is not performed in this frame.
+        bool occlusionCullingStatisticsPending = false; // Whether occlusionCullingStatisticsBuffer will be written by the current execution.
+        bool opaqueSubpassStatisticsPending = false; // Whether opaqueSubpassStatisticsQueryPool will be written by the current execution.
+        bool nodeWorldTransformReadbackPending = false; // Whether nodeWorldTransformReadbackBuffer will be written by the current execution.
         std::variant<vku::DescriptorSet<dsl::Skybox>, glm::vec3> background;
 
+        /**
+         * @brief Whether the secondary command buffers of the scene rendering subpasses have to be re-recorded in the
+         * next execution. Set by <tt>update()</tt> when any state they depend on is changed.
+         */
+        bool sceneSubpassCommandsOutdated = true;
+        bool sceneHasBlendMesh = false; // Whether sceneBlendSubpassCommandBuffer has any draw command.
+
         [[nodiscard]] auto createFramebuffers() const -> std::vector<vk::raii::Framebuffer>;
         [[nodiscard]] auto createDescriptorPool() const -> decltype(descriptorPool);
+        [[nodiscard]] auto createOpaqueSubpassStatisticsQueryPool() const -> decltype(opaqueSubpassStatisticsQueryPool);
 
         auto recordScenePrepassCommands(vk::CommandBuffer cb) const -> void;
         // Return true if last jump flood calculation direction is forward (result is in pong image), false if backward.
         [[nodiscard]] auto recordJumpFloodComputeCommands(vk::CommandBuffer cb, const vku::Image &image, vku::DescriptorSet<JumpFloodComputer::DescriptorSetLayout> descriptorSet, std::uint32_t initialSampleOffset) const -> bool;
+        [[nodiscard]] auto getRenderingNodesSceneDescriptorSet() const noexcept -> vk::DescriptorSet;
         auto recordSceneOpaqueMeshDrawCommands(vk::CommandBuffer cb) const -> void;
         auto recordSceneBlendMeshDrawCommands(vk::CommandBuffer cb) const -> bool;
         auto recordSkyboxDrawCommands(vk::CommandBuffer cb) const -> void;
+        // Return true if any blend mesh draw command is recorded into sceneBlendSubpassCommandBuffer.
+        [[nodiscard]] auto recordSceneSubpassCommands() const -> bool;
         auto recordNodeOutlineCompositionCommands(vk::CommandBuffer cb, std::optional<bool> hoveringNodeJumpFloodForward, std::optional<bool> selectedNodeJumpFloodForward, std::uint32_t swapchainImageIndex) const -> void;
         auto recordImGuiCompositionCommands(vk::CommandBuffer cb, std::uint32_t swapchainImageIndex) const -> void;
 
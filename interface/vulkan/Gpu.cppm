@@ -68,6 +68,7 @@ namespace vk_gltf_viewer::vulkan {
         bool supportSwapchainMutableFormat;
         bool supportDrawIndirectCount;
         bool supportUint8Index;
+        bool supportPipelineStatisticsQuery;
         std::uint32_t subgroupSize;
         bool supportShaderImageLoadStoreLod;
 
@@ -10,15 +10,22 @@ export import :vulkan.ag.Swapchain;
 export import :vulkan.Gpu;
 export import :vulkan.pipeline.BlendPrimitiveRenderer;
 export import :vulkan.pipeline.BlendUnlitPrimitiveRenderer;
+export import :vulkan.pipeline.CullingComputer;
+export import :vulkan.pipeline.DepthPyramidComputer;
 export import :vulkan.pipeline.DepthRenderer;
 export import :vulkan.pipeline.JumpFloodComputer;
 export import :vulkan.pipeline.JumpFloodSeedRenderer;
 export import :vulkan.pipeline.MaskDepthRenderer;
 export import :vulkan.pipeline.MaskJumpFloodSeedRenderer;
+export import :vulkan.pipeline.MaskPrimitiveDepthRenderer;
 export import :vulkan.pipeline.MaskPrimitiveRenderer;
 export import :vulkan.pipeline.MaskUnlitPrimitiveRenderer;
+export import :vulkan.pipeline.MorphTargetComputer;
+export import :vulkan.pipeline.NodeWorldTransformComputer;
 export import :vulkan.pipeline.OutlineRenderer;
+export import :vulkan.pipeline.PrimitiveDepthRenderer;
 export import :vulkan.pipeline.PrimitiveRenderer;
+export import :vulkan.pipeline.SkinningComputer;
 export import :vulkan.pipeline.SkyboxRenderer;
 export import :vulkan.pipeline.UnlitPrimitiveRenderer;
 export import :vulkan.pipeline.WeightedBlendedCompositionRenderer;
@@ -60,18 +67,29 @@ namespace vk_gltf_viewer::vulkan {
         BlendPrimitiveRenderer blendFacetedPrimitiveRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, true };
         BlendPrimitiveRenderer blendPrimitiveRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, false };
         BlendUnlitPrimitiveRenderer blendUnlitPrimitiveRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass };
+        CullingComputer cullingComputer { gpu.device, singleTexelSampler };
+        DepthPyramidComputer depthPyramidComputer { gpu.device, singleTexelSampler };
         DepthRenderer depthRenderer { gpu.device, primitiveNoShadingPipelineLayout };
+        PrimitiveDepthRenderer facetedPrimitiveDepthRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::FacetedPrimitive };
         PrimitiveRenderer facetedPrimitiveRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, true };
         JumpFloodComputer jumpFloodComputer { gpu.device };
         JumpFloodSeedRenderer jumpFloodSeedRenderer { gpu.device, primitiveNoShadingPipelineLayout };
         MaskDepthRenderer maskDepthRenderer { gpu.device, primitiveNoShadingPipelineLayout };
+        MaskPrimitiveDepthRenderer maskFacetedPrimitiveDepthRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::FacetedPrimitive };
         MaskPrimitiveRenderer maskFacetedPrimitiveRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, true };
         MaskJumpFloodSeedRenderer maskJumpFloodSeedRenderer { gpu.device, primitiveNoShadingPipelineLayout };
+        MaskPrimitiveDepthRenderer maskPrimitiveDepthRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::Primitive };
         MaskPrimitiveRenderer maskPrimitiveRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, false };
+        MaskPrimitiveDepthRenderer maskUnlitPrimitiveDepthRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::UnlitPrimitive };
         MaskUnlitPrimitiveRenderer maskUnlitPrimitiveRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass };
+        MorphTargetComputer morphTargetComputer { gpu.device };
+        NodeWorldTransformComputer nodeWorldTransformComputer { gpu.device };
         OutlineRenderer outlineRenderer { gpu.device };
+        PrimitiveDepthRenderer primitiveDepthRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::Primitive };
         PrimitiveRenderer primitiveRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, false };
+        SkinningComputer skinningComputer { gpu.device };
         SkyboxRenderer skyboxRenderer { gpu.device, skyboxDescriptorSetLayout, true, sceneRenderPass, cubeIndices };
+        PrimitiveDepthRenderer unlitPrimitiveDepthRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::UnlitPrimitive };
         UnlitPrimitiveRenderer unlitPrimitiveRenderer { gpu.device, primitivePipelineLayout, sceneRenderPass };
         WeightedBlendedCompositionRenderer weightedBlendedCompositionRenderer { gpu.device, sceneRenderPass };
 
@@ -93,6 +111,26 @@ namespace vk_gltf_viewer::vulkan {
         vku::DescriptorSet<dsl::ImageBasedLighting> imageBasedLightingDescriptorSet;
         vku::DescriptorSet<dsl::Skybox> skyboxDescriptorSet;
 
+        // Synchronization stuffs.
+
+        /**
+         * @brief Timeline semaphore that is signaled with <tt>sceneRenderingTimelineValue + 1</tt> when the scene rendering of a frame is finished.
+         *
+         * Deformed vertex attribute buffers are shared by the frames in flight, therefore the mesh deformation of a frame
+         * waits for the scene rendering of the previously submitted frame, which is the last reader of them.
+         */
+        vk::raii::Semaphore sceneRenderingTimelineSema { gpu.device, vk::StructureChain {
+            vk::SemaphoreCreateInfo{},
+            vk::SemaphoreTypeCreateInfo { vk::SemaphoreType::eTimeline, 0 },
+        }.get() };
+
+        /**
+         * @brief Number of the scene rendering submissions of all frames, which is the last value signaled to <tt>sceneRenderingTimelineSema</tt>.
+         *
+         * It MUST be incremented after each <tt>Frame::recordCommandsAndSubmit()</tt> call.
+         */
+        std::uint64_t sceneRenderingTimelineValue = 0;
+
         SharedData(const Gpu &gpu [[clang::lifetimebound]], const vk::Extent2D &swapchainExtent, std::span<const vk::Image> swapchainImages)
             : gpu { gpu }
             , swapchainExtent { swapchainExtent }
@@ -130,14 +168,20 @@ namespace vk_gltf_viewer::vulkan {
             blendPrimitiveRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, false };
             blendUnlitPrimitiveRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass };
             depthRenderer = { gpu.device, primitiveNoShadingPipelineLayout };
+            facetedPrimitiveDepthRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::FacetedPrimitive };
             facetedPrimitiveRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, true };
             jumpFloodSeedRenderer = { gpu.device, primitiveNoShadingPipelineLayout };
             maskDepthRenderer = { gpu.device, primitiveNoShadingPipelineLayout };
+            maskFacetedPrimitiveDepthRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::FacetedPrimitive };
             maskFacetedPrimitiveRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, true };
             maskJumpFloodSeedRenderer = { gpu.device, primitiveNoShadingPipelineLayout };
+            maskPrimitiveDepthRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::Primitive };
             maskPrimitiveRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, false };
+            maskUnlitPrimitiveDepthRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::UnlitPrimitive };
             maskUnlitPrimitiveRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass };
+            primitiveDepthRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::Primitive };
             primitiveRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, false };
+            unlitPrimitiveDepthRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass, PrimitiveDepthRenderer::VertexShader::UnlitPrimitive };
             unlitPrimitiveRenderer = { gpu.device, primitivePipelineLayout, sceneRenderPass };
 
             textureDescriptorPool = createTextureDescriptorPool();
@@ -11,10 +11,13 @@ namespace vk_gltf_viewer::vulkan::ag {
         ) : AttachmentGroup { extent } {
             addColorAttachment(
                 gpu.device,
-                storeImage(createColorImage(gpu.allocator, vk::Format::eR16Uint, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc)));
+                storeImage(createColorImage(gpu.allocator, vk::Format::eR32Uint, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc)));
             setDepthStencilAttachment(
                 gpu.device,
-                storeImage(createDepthStencilImage(gpu.allocator, vk::Format::eD32Sfloat)));
+                storeImage(createDepthStencilImage(
+                    gpu.allocator, vk::Format::eD32Sfloat,
+                    vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled /* read in DepthPyramidComputer */,
+                    vku::allocation::deviceLocal)));
         }
     };
 }
\ No newline at end of file
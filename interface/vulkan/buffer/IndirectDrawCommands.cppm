@@ -11,7 +11,7 @@ namespace vk_gltf_viewer::vulkan::buffer {
      * (which is either <tt>vk::DrawIndexedIndirectCommand</tt> or <tt>vk::DrawIndirectCommand</tt> based on the
      * template parameter) in the rest of the buffer.
      *
-     * It provides some convenient methods that reorder the draw commands based on the predicate, and a method to reset the draw count to
+     * It provides some convenient methods that reorder the draw commands based on the predicate, and a method to set the draw count.
      *
      * @tparam Indexed Boolean flag to indicate whether the draw command is indexed or not.
      */
@@ -23,7 +23,8 @@ namespace vk_gltf_viewer::vulkan::buffer {
             : MappedBuffer { allocator, vk::BufferCreateInfo {
                 {},
                 sizeof(std::uint32_t) /* draw count */ + sizeof(command_t) * commands.size(),
-                vk::BufferUsageFlagBits::eIndirectBuffer,
+                // Storage buffer usage is for the frustum culling compute shader, which reads and writes the commands.
+                vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
             }, vku::allocation::hostRead } {
             asValue<std::uint32_t>() = commands.size();
             std::ranges::copy(as_bytes(commands), static_cast<std::byte*>(data) + sizeof(std::uint32_t));
@@ -45,6 +46,14 @@ namespace vk_gltf_viewer::vulkan::buffer {
             return (size - sizeof(std::uint32_t)) / sizeof(command_t);
         }
 
+        /**
+         * @brief All draw commands in the buffer, regardless of the draw count.
+         * @return Span of the draw commands.
+         */
+        [[nodiscard]] std::span<command_t> commands() noexcept {
+            return asRange<command_t>(sizeof(std::uint32_t));
+        }
+
         /**
          * @brief Reorder the indirect draw commands to be in the head whose corresponding predicate returns <tt>true</tt>, and adjust the draw count accordingly.
          * @tparam F
@@ -52,16 +61,17 @@ namespace vk_gltf_viewer::vulkan::buffer {
          */
         template <std::invocable<const command_t&> F>
         void partition(F &&f) noexcept(std::is_nothrow_invocable_v<F>) {
-            const std::span commands = asRange<command_t>(sizeof(std::uint32_t));
+            const std::span commands = this->commands();
             const auto tail = std::ranges::partition(commands, f);
             asValue<std::uint32_t>() = std::distance(commands.begin(), tail.begin());
         }
 
         /**
-         * @brief Reset the draw count to the number of commands in the buffer.
+         * @brief Set the draw count, e.g. before the commands are written by the device.
+         * @param drawCount Number of draw commands. Must not be greater than <tt>maxDrawCount()</tt>.
          */
-        void resetDrawCount() noexcept {
-            asValue<std::uint32_t>() = maxDrawCount();
+        void setDrawCount(std::uint32_t drawCount) noexcept {
+            asValue<std::uint32_t>() = drawCount;
         }
 
         /**
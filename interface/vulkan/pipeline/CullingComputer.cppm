@@ -0,0 +1,140 @@
+module;
+
+#include <vulkan/vulkan_hpp_macros.hpp>
+
+export module vk_gltf_viewer:vulkan.pipeline.CullingComputer;
+
+import std;
+export import glm;
+import vku;
+export import vulkan_hpp;
+export import :vulkan.sampler.SingleTexelSampler;
+
+namespace vk_gltf_viewer::vulkan::inline pipeline {
+    /**
+     * @brief Compute pipeline that culls the instances of the indirect draw commands by the camera frustum, and
+     * optionally by the depth pyramid built by <tt>DepthPyramidComputer</tt>.
+     *
+     * For each source command, its visible instances are written into the same range of the culled draw indirection
+     * buffer, and the command is written into the destination buffer with the visible instance count. All buffers are
+     * accessed by their device addresses, and only the depth pyramid is bound by the descriptor set.
+     */
+    export class CullingComputer {
+    public:
+        enum Flags : std::uint32_t {
+            /**
+             * @brief Append only the commands with visible instances, and count them at the start of the destination
+             * buffer. Requires <tt>drawIndirectCount</tt> to use the result.
+             */
+            Compact = 1U,
+
+            /**
+             * @brief Consider only the instances whose bit in the instance visibility buffer is set, i.e. visible in the
+             * last occlusion test. Used for the first phase of the occlusion culling.
+             */
+            PreviouslyVisibleOnly = 2U,
+
+            /**
+             * @brief Test the instances against the depth pyramid, record their visibilities into the instance
+             * visibility buffer and accumulate the statistics. Used for the second phase of the occlusion culling.
+             */
+            OcclusionTest = 4U,
+        };
+
+        /**
+         * @brief Per-frame culling parameters, shared by all indirect draw command buffers.
+         */
+        struct Parameters {
+            std::array<glm::vec4, 6> frustumPlanes; /// 6 planes as (normal, distance).
+            glm::mat4 projectionView;
+        };
+
+        /**
+         * @brief Instance counts accumulated by the occlusion test.
+         */
+        struct Statistics {
+            std::uint32_t testedInstanceCount;   /// Number of the instances inside the frustum.
+            std::uint32_t occludedInstanceCount;
+        };
+
+        /**
+         * @brief Culling parameters of an indirect draw command buffer, which are directly pushed as the push constant.
+         */
+        struct PushConstant {
+            vk::DeviceAddress pSrcCommands;           /// Address of the first source command.
+            vk::DeviceAddress pDstCommandBuffer;      /// Address of the destination buffer, which starts with the draw count.
+            vk::DeviceAddress pDrawIndirections;
+            vk::DeviceAddress pCulledDrawIndirections;
+            vk::DeviceAddress pNodes;
+            vk::DeviceAddress pPrimitiveBoundingSpheres;
+            vk::DeviceAddress pParameters;
+            vk::DeviceAddress pInstanceVisibilities;  /// Visibility bit per draw indirection. Unused if no occlusion flag is set.
+            vk::DeviceAddress pStatistics;            /// Unused if <tt>OcclusionTest</tt> is not set.
+            std::uint32_t commandCount;
+            std::uint32_t commandDwordCount;          /// 5 if indexed, otherwise 4.
+            std::uint32_t flags;
+        };
+
+        struct DescriptorSetLayout : vku::DescriptorSetLayout<vk::DescriptorType::eCombinedImageSampler> {
+            DescriptorSetLayout(
+                const vk::raii::Device &device [[clang::lifetimebound]],
+                const SingleTexelSampler &sampler [[clang::lifetimebound]]
+            ) : vku::DescriptorSetLayout<vk::DescriptorType::eCombinedImageSampler> {
+                    device,
+                    vk::DescriptorSetLayoutCreateInfo {
+                        {},
+                        vku::unsafeProxy(vk::DescriptorSetLayoutBinding { 0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, &*sampler }),
+                    },
+                } { }
+        };
+
+        DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+        CullingComputer(
+            const vk::raii::Device &device [[clang::lifetimebound]],
+            const SingleTexelSampler &sampler [[clang::lifetimebound]]
+        ) : descriptorSetLayout { device, sampler },
+            pipelineLayout { device, vk::PipelineLayoutCreateInfo {
+                {},
+                *descriptorSetLayout,
+                vku::unsafeProxy(vk::PushConstantRange {
+                    vk::ShaderStageFlagBits::eCompute,
+                    0, sizeof(PushConstant),
+                }),
+            } },
+            pipeline { device, nullptr, vk::ComputePipelineCreateInfo {
+                {},
+                createPipelineStages(
+                    device,
+                    vku::Shader::fromSpirvFile(COMPILED_SHADER_DIR "/culling.comp.spv", vk::ShaderStageFlagBits::eCompute)).get()[0],
+                *pipelineLayout,
+            } } { }
+
+        /**
+         * @brief Record the commands that cull the indirect draw commands, and make the results visible to the indirect draw and vertex shader stages.
+         * @param commandBuffer Command buffer to be recorded.
+         * @param descriptorSet Descriptor set of the depth pyramid. It must be valid even if no occlusion flag is set.
+         * @param pushConstants Culling parameters of each indirect draw command buffer.
+         */
+        auto compute(
+            vk::CommandBuffer commandBuffer,
+            vku::DescriptorSet<DescriptorSetLayout> descriptorSet,
+            std::span<const PushConstant> pushConstants
+        ) const -> void {
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, descriptorSet, {});
+            for (const PushConstant &pushConstant : pushConstants) {
+                commandBuffer.pushConstants<PushConstant>(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+                commandBuffer.dispatch(pushConstant.commandCount, 1, 1);
+            }
+
+            commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader,
+                {},
+                vk::MemoryBarrier { vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead },
+                {}, {});
+        }
+    };
+}
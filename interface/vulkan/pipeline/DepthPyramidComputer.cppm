@@ -0,0 +1,105 @@
+module;
+
+#include <vulkan/vulkan_hpp_macros.hpp>
+
+export module vk_gltf_viewer:vulkan.pipeline.DepthPyramidComputer;
+
+import std;
+import vku;
+export import vulkan_hpp;
+import :math.extended_arithmetic;
+export import :vulkan.sampler.SingleTexelSampler;
+
+namespace vk_gltf_viewer::vulkan::inline pipeline {
+    /**
+     * @brief Compute pipeline that builds the hierarchical depth (Hi-Z) pyramid from a depth image.
+     *
+     * Each texel of the pyramid has the farthest depth of the region it covers. Level 0 has the same extent as the depth
+     * image, and the extent of each next level is the half (floored) of the previous one. Unlike
+     * <tt>SubgroupMipmapComputer</tt>, the base extent does not have to be power of 2.
+     */
+    export class DepthPyramidComputer {
+    public:
+        /**
+         * @brief Maximum mip level count of the pyramid, which limits the depth image extent to 32768.
+         */
+        static constexpr std::uint32_t MAX_MIP_LEVELS = 16;
+
+        struct DescriptorSetLayout : vku::DescriptorSetLayout<vk::DescriptorType::eCombinedImageSampler, vk::DescriptorType::eStorageImage> {
+            DescriptorSetLayout(
+                const vk::raii::Device &device [[clang::lifetimebound]],
+                const SingleTexelSampler &sampler [[clang::lifetimebound]]
+            ) : vku::DescriptorSetLayout<vk::DescriptorType::eCombinedImageSampler, vk::DescriptorType::eStorageImage> {
+                    device,
+                    vk::DescriptorSetLayoutCreateInfo {
+                        {},
+                        vku::unsafeProxy({
+                            vk::DescriptorSetLayoutBinding { 0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, &*sampler },
+                            vk::DescriptorSetLayoutBinding { 1, vk::DescriptorType::eStorageImage, MAX_MIP_LEVELS, vk::ShaderStageFlagBits::eCompute },
+                        }),
+                    },
+                } { }
+        };
+
+        DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+        DepthPyramidComputer(
+            const vk::raii::Device &device [[clang::lifetimebound]],
+            const SingleTexelSampler &sampler [[clang::lifetimebound]]
+        ) : descriptorSetLayout { device, sampler },
+            pipelineLayout { device, vk::PipelineLayoutCreateInfo {
+                {},
+                *descriptorSetLayout,
+                vku::unsafeProxy(vk::PushConstantRange {
+                    vk::ShaderStageFlagBits::eCompute,
+                    0, sizeof(std::uint32_t),
+                }),
+            } },
+            pipeline { device, nullptr, vk::ComputePipelineCreateInfo {
+                {},
+                createPipelineStages(
+                    device,
+                    vku::Shader::fromSpirvFile(COMPILED_SHADER_DIR "/depth_pyramid.comp.spv", vk::ShaderStageFlagBits::eCompute)).get()[0],
+                *pipelineLayout,
+            } } { }
+
+        /**
+         * @brief Record the commands that build the depth pyramid.
+         *
+         * The depth image must be in <tt>ShaderReadOnlyOptimal</tt> layout, and the pyramid image must be in
+         * <tt>General</tt> layout. The synchronization of the built pyramid is up to the caller.
+         *
+         * @param commandBuffer Command buffer to be recorded.
+         * @param descriptorSet Descriptor set whose binding 0 is the depth image and binding 1 is the mip level image views
+         * of the pyramid. Unused array elements must be filled with any valid image view.
+         * @param baseExtent Extent of the depth image.
+         * @param mipLevels Mip level count of the pyramid.
+         */
+        auto compute(
+            vk::CommandBuffer commandBuffer,
+            vku::DescriptorSet<DescriptorSetLayout> descriptorSet,
+            const vk::Extent2D &baseExtent,
+            std::uint32_t mipLevels
+        ) const -> void {
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, descriptorSet, {});
+            for (std::uint32_t level = 0; level < mipLevels; ++level) {
+                if (level != 0) {
+                    commandBuffer.pipelineBarrier(
+                        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+                        {},
+                        vk::MemoryBarrier { vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead },
+                        {}, {});
+                }
+
+                commandBuffer.pushConstants<std::uint32_t>(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, level);
+                commandBuffer.dispatch(
+                    math::divCeil(std::max(baseExtent.width >> level, 1U), 16U),
+                    math::divCeil(std::max(baseExtent.height >> level, 1U), 16U),
+                    1);
+            }
+        }
+    };
+}
@@ -29,7 +29,7 @@ namespace vk_gltf_viewer::vulkan::inline pipeline {
                     })),
                 vk::PipelineRenderingCreateInfo {
                     {},
-                    vku::unsafeProxy(vk::Format::eR16Uint),
+                    vku::unsafeProxy(vk::Format::eR32Uint),
                     vk::Format::eD32Sfloat,
                 }
             }.get() } { }
@@ -0,0 +1,55 @@
+export module vk_gltf_viewer:vulkan.pipeline.MaskPrimitiveDepthRenderer;
+
+import std;
+import vku;
+export import :vulkan.pipeline.PrimitiveDepthRenderer;
+
+namespace vk_gltf_viewer::vulkan::inline pipeline {
+    /**
+     * @brief Depth only pipeline of the scene opaque subpass, for the full depth prepass of the alphaMode=Mask primitives.
+     *
+     * Its fragment shader only calculates the base color alpha for the alpha to coverage, in the same way of the paired
+     * shading pipeline, so that both pipelines cover the same samples.
+     */
+    export struct MaskPrimitiveDepthRenderer : vk::raii::Pipeline {
+        MaskPrimitiveDepthRenderer(
+            const vk::raii::Device &device [[clang::lifetimebound]],
+            const pl::Primitive &layout [[clang::lifetimebound]],
+            const rp::Scene &sceneRenderPass [[clang::lifetimebound]],
+            PrimitiveDepthRenderer::VertexShader vertexShader
+        ) : Pipeline { device, nullptr, vku::getDefaultGraphicsPipelineCreateInfo(
+                createPipelineStages(
+                    device,
+                    vku::Shader::fromSpirvFile(PrimitiveDepthRenderer::getVertexShaderPath(vertexShader), vk::ShaderStageFlagBits::eVertex),
+                    vku::Shader::fromSpirvFile(
+                        std::format(COMPILED_SHADER_DIR "/mask_primitive_depth.frag_VERTEX_SHADER_TYPE_{}.spv", std::to_underlying(vertexShader)),
+                        vk::ShaderStageFlagBits::eFragment)).get(),
+                *layout, 1, true, vk::SampleCountFlagBits::e4)
+            .setPDepthStencilState(vku::unsafeAddress(vk::PipelineDepthStencilStateCreateInfo {
+                {},
+                true, true, vk::CompareOp::eGreater, // Use reverse Z.
+            }))
+            .setPMultisampleState(vku::unsafeAddress(vk::PipelineMultisampleStateCreateInfo {
+                {},
+                vk::SampleCountFlagBits::e4,
+                {}, {}, {},
+                true,
+            }))
+            .setPColorBlendState(vku::unsafeAddress(vk::PipelineColorBlendStateCreateInfo {
+                {},
+                false, {},
+                vku::unsafeProxy(vk::PipelineColorBlendAttachmentState { false, {}, {}, {}, {}, {}, {}, {} /* No color write. */ }),
+            }))
+            .setPDynamicState(vku::unsafeAddress(vk::PipelineDynamicStateCreateInfo {
+                {},
+                vku::unsafeProxy({
+                    vk::DynamicState::eViewport,
+                    vk::DynamicState::eScissor,
+                    vk::DynamicState::eCullMode,
+                }),
+            }))
+            .setRenderPass(*sceneRenderPass)
+            .setSubpass(0)
+        } { }
+    };
+}
\ No newline at end of file
@@ -32,6 +32,9 @@ namespace vk_gltf_viewer::vulkan::inline pipeline {
                     vk::DynamicState::eViewport,
                     vk::DynamicState::eScissor,
                     vk::DynamicState::eCullMode,
+                    // Depth test is changed to the equal test without write if full depth prepass is done.
+                    vk::DynamicState::eDepthWriteEnable,
+                    vk::DynamicState::eDepthCompareOp,
                 }),
             }))
             .setRenderPass(*sceneRenderPass)
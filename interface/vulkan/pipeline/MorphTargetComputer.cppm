@@ -0,0 +1,78 @@
+module;
+
+#include <vulkan/vulkan_hpp_macros.hpp>
+
+export module vk_gltf_viewer:vulkan.pipeline.MorphTargetComputer;
+
+import std;
+import vku;
+export import vulkan_hpp;
+import :math.extended_arithmetic;
+
+namespace vk_gltf_viewer::vulkan::inline pipeline {
+    /**
+     * @brief Compute pipeline that writes the morph target blended positions, normals and tangents of the morphed primitives.
+     *
+     * All buffers are accessed by their device addresses, therefore no descriptor set is needed.
+     */
+    export class MorphTargetComputer {
+    public:
+        /**
+         * @brief Blending parameters of a primitive, which are directly pushed as the push constant.
+         */
+        struct PushConstant {
+            vk::DeviceAddress pDeltaBuffer;
+            vk::DeviceAddress pVertexDeltaOffsetBuffer;
+            vk::DeviceAddress pSourcePositionBuffer;
+            vk::DeviceAddress pSourceNormalBuffer;  /// 0 if the primitive has no normal.
+            vk::DeviceAddress pSourceTangentBuffer; /// 0 if the primitive has no tangent.
+            vk::DeviceAddress pMorphedPositionBuffer;
+            vk::DeviceAddress pMorphedNormalBuffer;
+            vk::DeviceAddress pMorphedTangentBuffer;
+            vk::DeviceAddress pWeights;             /// Address of the first target weight of the primitive's mesh.
+            std::uint32_t vertexCount;
+            std::uint32_t positionByteStride;
+            std::uint32_t normalByteStride;
+            std::uint32_t tangentByteStride;
+            std::uint32_t attributeEncodingFlags;
+        };
+
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+        explicit MorphTargetComputer(
+            const vk::raii::Device &device [[clang::lifetimebound]]
+        ) : pipelineLayout { device, vk::PipelineLayoutCreateInfo {
+                {},
+                {},
+                vku::unsafeProxy(vk::PushConstantRange {
+                    vk::ShaderStageFlagBits::eCompute,
+                    0, sizeof(PushConstant),
+                }),
+            } },
+            pipeline { device, nullptr, vk::ComputePipelineCreateInfo {
+                {},
+                createPipelineStages(
+                    device,
+                    vku::Shader::fromSpirvFile(COMPILED_SHADER_DIR "/morph_target.comp.spv", vk::ShaderStageFlagBits::eCompute)).get()[0],
+                *pipelineLayout,
+            } } { }
+
+        /**
+         * @brief Record the commands that blend the morph targets of the primitives.
+         *
+         * If the morphed attributes are consumed by the following compute shader (e.g. skinning), a compute to compute
+         * barrier must be recorded after this.
+         *
+         * @param commandBuffer Command buffer to be recorded.
+         * @param pushConstants Blending parameters of each primitive.
+         */
+        auto compute(vk::CommandBuffer commandBuffer, std::span<const PushConstant> pushConstants) const -> void {
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+            for (const PushConstant &pushConstant : pushConstants) {
+                commandBuffer.pushConstants<PushConstant>(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+                commandBuffer.dispatch(math::divCeil(pushConstant.vertexCount, 256U), 1, 1);
+            }
+        }
+    };
+}
@@ -0,0 +1,144 @@
+module;
+
+#include <vulkan/vulkan_hpp_macros.hpp>
+
+export module vk_gltf_viewer:vulkan.pipeline.NodeWorldTransformComputer;
+
+import std;
+import vku;
+export import vulkan_hpp;
+import :math.extended_arithmetic;
+
+namespace vk_gltf_viewer::vulkan::inline pipeline {
+    /**
+     * @brief Compute pipelines that propagate the node local transforms to the world transforms, and expand them into the flattened mesh node instance world transforms.
+     *
+     * All buffers are accessed by their device addresses, therefore no descriptor set is needed.
+     */
+    export class NodeWorldTransformComputer {
+    public:
+        struct PropagationInfo {
+            vk::DeviceAddress pNodeLocalTransforms;
+            vk::DeviceAddress pNodeWorldTransforms;
+            vk::DeviceAddress pLevelOrderedNodeIndices;
+            vk::DeviceAddress pParentNodeIndices;
+            vk::DeviceAddress pInstanceNodeIndices;
+            vk::DeviceAddress pInstanceLocalTransforms;
+            vk::DeviceAddress pMeshNodeWorldTransforms;
+
+            /**
+             * @brief Start offsets of each hierarchy level in the level ordered node indices, with the total node count at the end.
+             */
+            std::vector<std::uint32_t> levelOffsets;
+
+            std::uint32_t instanceCount;
+        };
+
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline propagationPipeline;
+        vk::raii::Pipeline expansionPipeline;
+
+        explicit NodeWorldTransformComputer(
+            const vk::raii::Device &device [[clang::lifetimebound]]
+        ) : pipelineLayout { device, vk::PipelineLayoutCreateInfo {
+                {},
+                {},
+                vku::unsafeProxy(vk::PushConstantRange {
+                    vk::ShaderStageFlagBits::eCompute,
+                    0, std::max<std::uint32_t>(sizeof(PropagationPushConstant), sizeof(ExpansionPushConstant)),
+                }),
+            } },
+            propagationPipeline { device, nullptr, vk::ComputePipelineCreateInfo {
+                {},
+                createPipelineStages(
+                    device,
+                    vku::Shader::fromSpirvFile(COMPILED_SHADER_DIR "/node_world_transform.comp.spv", vk::ShaderStageFlagBits::eCompute)).get()[0],
+                *pipelineLayout,
+            } },
+            expansionPipeline { device, nullptr, vk::ComputePipelineCreateInfo {
+                {},
+                createPipelineStages(
+                    device,
+                    vku::Shader::fromSpirvFile(COMPILED_SHADER_DIR "/mesh_node_world_transform.comp.spv", vk::ShaderStageFlagBits::eCompute)).get()[0],
+                *pipelineLayout,
+            } } { }
+
+        /**
+         * @brief Record the commands that calculate the node world transforms level by level, and write the mesh node instance world transforms.
+         *
+         * After the commands, the written mesh node world transforms are visible to the vertex shader.
+         *
+         * @param commandBuffer Command buffer to be recorded.
+         * @param info Buffer addresses and hierarchy level information.
+         */
+        auto compute(vk::CommandBuffer commandBuffer, const PropagationInfo &info) const -> void {
+            constexpr vk::MemoryBarrier computeToComputeBarrier {
+                vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead,
+            };
+
+            // World transforms may be still read by the previously submitted commands in the same queue (write-after-read).
+            commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eComputeShader,
+                {}, {}, {}, {});
+
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *propagationPipeline);
+            for (const auto &[levelStart, levelEnd] : info.levelOffsets | std::views::pairwise) {
+                commandBuffer.pushConstants<PropagationPushConstant>(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, PropagationPushConstant {
+                    .pNodeLocalTransforms = info.pNodeLocalTransforms,
+                    .pNodeWorldTransforms = info.pNodeWorldTransforms,
+                    .pLevelOrderedNodeIndices = info.pLevelOrderedNodeIndices,
+                    .pParentNodeIndices = info.pParentNodeIndices,
+                    .levelStart = levelStart,
+                    .levelCount = levelEnd - levelStart,
+                });
+                commandBuffer.dispatch(math::divCeil(levelEnd - levelStart, 256U), 1, 1);
+
+                // Next level reads the world transforms of the current level.
+                commandBuffer.pipelineBarrier(
+                    vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+                    {}, computeToComputeBarrier, {}, {});
+            }
+
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *expansionPipeline);
+            commandBuffer.pushConstants<ExpansionPushConstant>(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, ExpansionPushConstant {
+                .pNodeWorldTransforms = info.pNodeWorldTransforms,
+                .pInstanceLocalTransforms = info.pInstanceLocalTransforms,
+                .pInstanceNodeIndices = info.pInstanceNodeIndices,
+                .pMeshNodeWorldTransforms = info.pMeshNodeWorldTransforms,
+                .instanceCount = info.instanceCount,
+            });
+            commandBuffer.dispatch(math::divCeil(info.instanceCount, 256U), 1, 1);
+
+            // Mesh node world transforms are read by the vertex shaders and the frustum culling, and node world transforms
+            // are copied for the host readback.
+            commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eComputeShader,
+                vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+                {},
+                vk::MemoryBarrier {
+                    vk::AccessFlagBits::eShaderWrite,
+                    vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead,
+                },
+                {}, {});
+        }
+
+    private:
+        struct PropagationPushConstant {
+            vk::DeviceAddress pNodeLocalTransforms;
+            vk::DeviceAddress pNodeWorldTransforms;
+            vk::DeviceAddress pLevelOrderedNodeIndices;
+            vk::DeviceAddress pParentNodeIndices;
+            std::uint32_t levelStart;
+            std::uint32_t levelCount;
+        };
+
+        struct ExpansionPushConstant {
+            vk::DeviceAddress pNodeWorldTransforms;
+            vk::DeviceAddress pInstanceLocalTransforms;
+            vk::DeviceAddress pInstanceNodeIndices;
+            vk::DeviceAddress pMeshNodeWorldTransforms;
+            std::uint32_t instanceCount;
+        };
+    };
+}
@@ -0,0 +1,68 @@
+export module vk_gltf_viewer:vulkan.pipeline.PrimitiveDepthRenderer;
+
+import std;
+import vku;
+export import :vulkan.pl.Primitive;
+export import :vulkan.rp.Scene;
+
+namespace vk_gltf_viewer::vulkan::inline pipeline {
+    /**
+     * @brief Depth only pipeline of the scene opaque subpass, for the full depth prepass of the alphaMode=Opaque primitives.
+     *
+     * It has no fragment shader and doesn't write the color attachment. The vertex shader of the paired shading pipeline
+     * is used, so that the shading pipeline can test the fragments with <tt>CompareOp::eEqual</tt>.
+     */
+    export struct PrimitiveDepthRenderer : vk::raii::Pipeline {
+        /**
+         * @brief Vertex shader of the shading pipeline to be paired with.
+         */
+        enum class VertexShader : std::uint8_t {
+            Primitive,        /// primitive.vert, used by <tt>PrimitiveRenderer</tt> and <tt>MaskPrimitiveRenderer</tt>.
+            FacetedPrimitive, /// faceted_primitive.vert, used by the faceted <tt>PrimitiveRenderer</tt> and <tt>MaskPrimitiveRenderer</tt>.
+            UnlitPrimitive,   /// unlit_primitive.vert, used by <tt>UnlitPrimitiveRenderer</tt> and <tt>MaskUnlitPrimitiveRenderer</tt>.
+        };
+
+        PrimitiveDepthRenderer(
+            const vk::raii::Device &device [[clang::lifetimebound]],
+            const pl::Primitive &layout [[clang::lifetimebound]],
+            const rp::Scene &sceneRenderPass [[clang::lifetimebound]],
+            VertexShader vertexShader
+        ) : Pipeline { device, nullptr, vku::getDefaultGraphicsPipelineCreateInfo(
+                createPipelineStages(
+                    device,
+                    vku::Shader::fromSpirvFile(getVertexShaderPath(vertexShader), vk::ShaderStageFlagBits::eVertex)).get(),
+                *layout, 1, true, vk::SampleCountFlagBits::e4)
+            .setPDepthStencilState(vku::unsafeAddress(vk::PipelineDepthStencilStateCreateInfo {
+                {},
+                true, true, vk::CompareOp::eGreater, // Use reverse Z.
+            }))
+            .setPColorBlendState(vku::unsafeAddress(vk::PipelineColorBlendStateCreateInfo {
+                {},
+                false, {},
+                vku::unsafeProxy(vk::PipelineColorBlendAttachmentState { false, {}, {}, {}, {}, {}, {}, {} /* No color write. */ }),
+            }))
+            .setPDynamicState(vku::unsafeAddress(vk::PipelineDynamicStateCreateInfo {
+                {},
+                vku::unsafeProxy({
+                    vk::DynamicState::eViewport,
+                    vk::DynamicState::eScissor,
+                    vk::DynamicState::eCullMode,
+                }),
+            }))
+            .setRenderPass(*sceneRenderPass)
+            .setSubpass(0)
+        } { }
+
+        [[nodiscard]] static auto getVertexShaderPath(VertexShader vertexShader) -> const char* {
+            switch (vertexShader) {
+                case VertexShader::Primitive:
+                    return COMPILED_SHADER_DIR "/primitive.vert.spv";
+                case VertexShader::FacetedPrimitive:
+                    return COMPILED_SHADER_DIR "/faceted_primitive.vert.spv";
+                case VertexShader::UnlitPrimitive:
+                    return COMPILED_SHADER_DIR "/unlit_primitive.vert.spv";
+            }
+            std::unreachable();
+        }
+    };
+}
\ No newline at end of file
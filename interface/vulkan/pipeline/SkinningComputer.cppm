@@ -0,0 +1,78 @@
+module;
+
+#include <vulkan/vulkan_hpp_macros.hpp>
+
+export module vk_gltf_viewer:vulkan.pipeline.SkinningComputer;
+
+import std;
+import vku;
+export import vulkan_hpp;
+import :math.extended_arithmetic;
+
+namespace vk_gltf_viewer::vulkan::inline pipeline {
+    /**
+     * @brief Compute pipeline that writes the skinned positions, normals and tangents of the skinned primitives.
+     *
+     * All buffers are accessed by their device addresses, therefore no descriptor set is needed.
+     */
+    export class SkinningComputer {
+    public:
+        /**
+         * @brief Skinning parameters of a primitive, which are directly pushed as the push constant.
+         */
+        struct PushConstant {
+            vk::DeviceAddress pInfluenceBuffer;
+            vk::DeviceAddress pSourcePositionBuffer;
+            vk::DeviceAddress pSourceNormalBuffer;  /// 0 if the primitive has no normal.
+            vk::DeviceAddress pSourceTangentBuffer; /// 0 if the primitive has no tangent.
+            vk::DeviceAddress pSkinnedPositionBuffer;
+            vk::DeviceAddress pSkinnedNormalBuffer;
+            vk::DeviceAddress pSkinnedTangentBuffer;
+            vk::DeviceAddress pJointMatrices;       /// Address of the first joint matrix of the skin.
+            std::uint32_t vertexCount;
+            std::uint32_t influenceSetCount;
+            std::uint32_t positionByteStride;
+            std::uint32_t normalByteStride;
+            std::uint32_t tangentByteStride;
+            std::uint32_t attributeEncodingFlags;
+        };
+
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+        explicit SkinningComputer(
+            const vk::raii::Device &device [[clang::lifetimebound]]
+        ) : pipelineLayout { device, vk::PipelineLayoutCreateInfo {
+                {},
+                {},
+                vku::unsafeProxy(vk::PushConstantRange {
+                    vk::ShaderStageFlagBits::eCompute,
+                    0, sizeof(PushConstant),
+                }),
+            } },
+            pipeline { device, nullptr, vk::ComputePipelineCreateInfo {
+                {},
+                createPipelineStages(
+                    device,
+                    vku::Shader::fromSpirvFile(COMPILED_SHADER_DIR "/skinning.comp.spv", vk::ShaderStageFlagBits::eCompute)).get()[0],
+                *pipelineLayout,
+            } } { }
+
+        /**
+         * @brief Record the commands that skin the primitives.
+         *
+         * Skinned attributes are written to the buffers that are shared with the graphics queue, therefore the
+         * visibility to the vertex shader must be established by the semaphore of the queue submission.
+         *
+         * @param commandBuffer Command buffer to be recorded.
+         * @param pushConstants Skinning parameters of each primitive.
+         */
+        auto compute(vk::CommandBuffer commandBuffer, std::span<const PushConstant> pushConstants) const -> void {
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+            for (const PushConstant &pushConstant : pushConstants) {
+                commandBuffer.pushConstants<PushConstant>(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+                commandBuffer.dispatch(math::divCeil(pushConstant.vertexCount, 256U), 1, 1);
+            }
+        }
+    };
+}
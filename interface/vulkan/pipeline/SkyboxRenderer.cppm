@@ -14,7 +14,7 @@ namespace vk_gltf_viewer::vulkan::inline pipeline {
     export class SkyboxRenderer {
     public:
         struct PushConstant {
-            glm::mat4 projectionView;
+            vk::DeviceAddress pProjectionView; /// Address of the translationless projection view matrix.
         };
 
         vk::raii::PipelineLayout pipelineLayout;
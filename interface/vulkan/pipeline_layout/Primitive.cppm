@@ -14,11 +14,21 @@ export import :vulkan.dsl.Scene;
 
 namespace vk_gltf_viewer::vulkan::pl {
     export struct Primitive : vk::raii::PipelineLayout {
-        struct PushConstant {
+        /**
+         * @brief Camera data that is referenced by <tt>PushConstant::pCamera</tt>.
+         *
+         * It is read through the buffer device address rather than pushed directly, so that the recorded draw commands
+         * remain valid when only the camera is changed.
+         */
+        struct Camera {
             glm::mat4 projectionView;
             glm::vec3 viewPosition;
         };
 
+        struct PushConstant {
+            vk::DeviceAddress pCamera;
+        };
+
         Primitive(
             const vk::raii::Device &device [[clang::lifetimebound]],
             std::tuple<const dsl::ImageBasedLighting&, const dsl::Asset&, const dsl::Scene&> descriptorSetLayouts [[clang::lifetimebound]]
@@ -0,0 +1,40 @@
+// --------------------
+// Source vertex attribute fetching of the compute vertex deformation (morph target blending and skinning).
+// --------------------
+
+#define ATTRIBUTE_ENCODING_FLAG_OCTAHEDRAL_NORMAL 1U
+#define ATTRIBUTE_ENCODING_FLAG_OCTAHEDRAL_TANGENT 2U
+
+layout (std430, buffer_reference, buffer_reference_align = 16) readonly buffer ReadonlyVec4Ref { vec4 data; };
+layout (std430, buffer_reference, buffer_reference_align = 16) writeonly buffer Vec4Ref { vec4 data[]; };
+layout (std430, buffer_reference, buffer_reference_align = 4) readonly buffer Uint32Ref { uint data; };
+
+// Inverse of the octahedral mapping. See https://jcgt.org/published/0003/02/01/.
+vec3 fromOctahedral(vec2 p){
+    vec3 v = vec3(p, 1.0 - abs(p.x) - abs(p.y));
+    if (v.z < 0.0){
+        v.xy = (1.0 - abs(v.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(v.xy, vec2(0.0)));
+    }
+    return normalize(v);
+}
+
+vec3 getPosition(uint64_t address){
+    return ReadonlyVec4Ref(address).data.xyz;
+}
+
+vec3 getNormal(uint64_t address, uint attributeEncodingFlags){
+    if ((attributeEncodingFlags & ATTRIBUTE_ENCODING_FLAG_OCTAHEDRAL_NORMAL) != 0U){
+        return fromOctahedral(unpackSnorm2x16(Uint32Ref(address).data));
+    }
+    return ReadonlyVec4Ref(address).data.xyz;
+}
+
+vec4 getTangent(uint64_t address, uint attributeEncodingFlags){
+    if ((attributeEncodingFlags & ATTRIBUTE_ENCODING_FLAG_OCTAHEDRAL_TANGENT) != 0U){
+        // [0, 16): 16-bit snorm x, [16, 31): 15-bit snorm y, [31]: bitangent sign.
+        uint encoded = Uint32Ref(address).data;
+        vec2 p = vec2(unpackSnorm2x16(encoded).x, float((encoded >> 16U) & 0x7FFFU) / 32767.0 * 2.0 - 1.0);
+        return vec4(fromOctahedral(p), (encoded & 0x80000000U) != 0U ? -1.0 : 1.0);
+    }
+    return ReadonlyVec4Ref(address).data;
+}
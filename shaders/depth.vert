@@ -21,6 +21,9 @@ layout (set = 0, binding = 0) readonly buffer PrimitiveBuffer {
 layout (set = 1, binding = 0, std430) readonly buffer NodeBuffer {
     Node nodes[];
 };
+layout (set = 1, binding = 1, std430) readonly buffer DrawIndirectionBuffer {
+    DrawIndirection drawIndirections[];
+};
 
 layout (push_constant) uniform PushConstant {
     mat4 projectionView;
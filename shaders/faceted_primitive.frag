@@ -1,6 +1,7 @@
 #version 460
 #extension GL_GOOGLE_include_directive : require
 #extension GL_EXT_shader_16bit_storage : require
+#extension GL_EXT_buffer_reference : require
 #extension GL_EXT_nonuniform_qualifier : require
 #extension GL_EXT_shader_8bit_storage : require
 #extension GL_EXT_scalar_block_layout : require
@@ -19,6 +20,7 @@ layout (location = 3) in vec2 inNormalTexcoord;
 layout (location = 4) in vec2 inOcclusionTexcoord;
 layout (location = 5) in vec2 inEmissiveTexcoord;
 layout (location = 6) flat in uint inMaterialIndex;
+layout (location = 7) in vec4 inColor0;
 
 layout (location = 0) out vec4 outColor;
 
@@ -33,9 +35,14 @@ layout (set = 1, binding = 1) readonly buffer MaterialBuffer {
 };
 layout (set = 1, binding = 2) uniform sampler2D textures[];
 
-layout (push_constant, std430) uniform PushConstant {
+// Must be matched to vk_gltf_viewer::vulkan::pl::Primitive::Camera.
+layout (std430, buffer_reference, buffer_reference_align = 16) readonly buffer Camera {
     mat4 projectionView;
     vec3 viewPosition;
+};
+
+layout (push_constant, std430) uniform PushConstant {
+    Camera camera;
 } pc;
 
 layout (early_fragment_tests) in;
@@ -54,7 +61,7 @@ vec3 diffuseIrradiance(vec3 normal){
 }
 
 void main(){
-    vec4 baseColor = MATERIAL.baseColorFactor * texture(textures[int(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord);
+    vec4 baseColor = inColor0 * MATERIAL.baseColorFactor * texture(textures[int(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord);
 
     vec2 metallicRoughness = vec2(MATERIAL.metallicFactor, MATERIAL.roughnessFactor) * texture(textures[int(MATERIAL.metallicRoughnessTextureIndex) + 1], inMetallicRoughnessTexcoord).bg;
     float metallic = metallicRoughness.x;
@@ -78,7 +85,7 @@ void main(){
 
     vec3 emissive = MATERIAL.emissiveFactor * texture(textures[int(MATERIAL.emissiveTextureIndex) + 1], inEmissiveTexcoord).rgb;
 
-    vec3 V = normalize(pc.viewPosition - inPosition);
+    vec3 V = normalize(pc.camera.viewPosition - inPosition);
     float NdotV = dot(N, V);
     // If normal is not facing the camera, normal have to be flipped.
     if (NdotV < 0.0) {
@@ -22,6 +22,10 @@ layout (location = 3) out vec2 outNormalTexcoord;
 layout (location = 4) out vec2 outOcclusionTexcoord;
 layout (location = 5) out vec2 outEmissiveTexcoord;
 layout (location = 6) flat out uint outMaterialIndex;
+layout (location = 7) out vec4 outColor0;
+
+// Depth prepass pipelines share this shader, and their depths must be exactly matched for the equal depth test.
+invariant gl_Position;
 
 layout (set = 1, binding = 0) readonly buffer PrimitiveBuffer {
     Primitive primitives[];
@@ -33,12 +37,22 @@ layout (set = 1, binding = 1) readonly buffer MaterialBuffer {
 layout (set = 2, binding = 0, std430) readonly buffer NodeBuffer {
     Node nodes[];
 };
+layout (set = 2, binding = 1, std430) readonly buffer DrawIndirectionBuffer {
+    DrawIndirection drawIndirections[];
+};
 
-layout (push_constant, std430) uniform PushConstant {
+// Must be matched to vk_gltf_viewer::vulkan::pl::Primitive::Camera.
+layout (std430, buffer_reference, buffer_reference_align = 16) readonly buffer Camera {
     mat4 projectionView;
     vec3 viewPosition;
+};
+
+layout (push_constant, std430) uniform PushConstant {
+    Camera camera;
 } pc;
 
+#include "vertex_color.glsl"
+
 // --------------------
 // Functions.
 // --------------------
@@ -57,7 +71,11 @@ vec4 getVec4(uint64_t address){
 
 vec2 getTexcoord(uint texcoordIndex){
     IndexedAttributeMappingInfo mappingInfo = PRIMITIVE.texcoordAttributeMappingInfos.data[texcoordIndex];
-    return getVec2(mappingInfo.bytesPtr + uint(mappingInfo.stride) * gl_VertexIndex);
+    uint64_t address = mappingInfo.bytesPtr + uint(mappingInfo.stride) * gl_VertexIndex;
+    if (uint(mappingInfo.componentType) == COMPONENT_TYPE_HALF_FLOAT){
+        return unpackHalf2x16(Uint32Ref(address).data);
+    }
+    return getVec2(address);
 }
 
 void main(){
@@ -80,7 +98,8 @@ void main(){
     if (int(MATERIAL.emissiveTextureIndex) != -1){
         outEmissiveTexcoord = getTexcoord(uint(MATERIAL.emissiveTexcoordIndex));
     }
+    outColor0 = getColor(0);
     outMaterialIndex = MATERIAL_INDEX;
 
-    gl_Position = pc.projectionView * vec4(outPosition, 1.0);
+    gl_Position = pc.camera.projectionView * vec4(outPosition, 1.0);
 }
\ No newline at end of file
@@ -4,10 +4,13 @@
 // Indexing macros that are used in vertex shader.
 // --------------------
 
-#define PRIMITIVE_INDEX gl_BaseInstance & 0xFFFFU
+// Instances of an instanced draw may come from different nodes that share the mesh, and deformed primitive is node
+// specific, therefore the primitive is also looked up per instance.
+#define DRAW_INDIRECTION drawIndirections[gl_InstanceIndex]
+#define PRIMITIVE_INDEX DRAW_INDIRECTION.primitiveIndex
 #define PRIMITIVE primitives[PRIMITIVE_INDEX]
-#define NODE_INDEX gl_BaseInstance >> 16U
-#define TRANSFORM Node(nodes[NODE_INDEX]).transforms[gl_InstanceIndex - gl_BaseInstance]
+#define NODE_INDEX DRAW_INDIRECTION.nodeIndex
+#define TRANSFORM Node(nodes[NODE_INDEX]).transforms[DRAW_INDIRECTION.instanceIndex]
 #define MATERIAL_INDEX PRIMITIVE.materialIndex
 #define MATERIAL materials[MATERIAL_INDEX]
 
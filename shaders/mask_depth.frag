@@ -11,6 +11,7 @@
 layout (location = 0) in vec2 inBaseColorTexcoord;
 layout (location = 1) flat in uint inNodeIndex;
 layout (location = 2) flat in uint inMaterialIndex;
+layout (location = 3) in vec4 inColor0;
 
 layout (location = 0) out uint outNodeIndex;
 
@@ -20,7 +21,7 @@ layout (set = 0, binding = 1) readonly buffer MaterialBuffer {
 layout (set = 0, binding = 2) uniform sampler2D textures[];
 
 void main(){
-    float baseColorAlpha = MATERIAL.baseColorFactor.a * texture(textures[uint(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord).a;
+    float baseColorAlpha = inColor0.a * MATERIAL.baseColorFactor.a * texture(textures[uint(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord).a;
     if (baseColorAlpha < MATERIAL.alphaCutoff) discard;
 
     outNodeIndex = inNodeIndex;
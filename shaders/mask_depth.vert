@@ -18,6 +18,7 @@ layout (std430, buffer_reference, buffer_reference_align = 64) readonly buffer N
 layout (location = 0) out vec2 outBaseColorTexcoord;
 layout (location = 1) flat out uint outNodeIndex;
 layout (location = 2) flat out uint outMaterialIndex;
+layout (location = 3) out vec4 outColor0;
 
 layout (set = 0, binding = 0) readonly buffer PrimitiveBuffer {
     Primitive primitives[];
@@ -29,11 +30,16 @@ layout (set = 0, binding = 1) readonly buffer MaterialBuffer {
 layout (set = 1, binding = 0, std430) readonly buffer NodeBuffer {
     Node nodes[];
 };
+layout (set = 1, binding = 1, std430) readonly buffer DrawIndirectionBuffer {
+    DrawIndirection drawIndirections[];
+};
 
 layout (push_constant) uniform PushConstant {
     mat4 projectionView;
 } pc;
 
+#include "vertex_color.glsl"
+
 // --------------------
 // Functions.
 // --------------------
@@ -48,7 +54,11 @@ vec3 getVec3(uint64_t address){
 
 vec2 getTexcoord(uint texcoordIndex){
     IndexedAttributeMappingInfo mappingInfo = PRIMITIVE.texcoordAttributeMappingInfos.data[texcoordIndex];
-    return getVec2(mappingInfo.bytesPtr + uint(mappingInfo.stride) * gl_VertexIndex);
+    uint64_t address = mappingInfo.bytesPtr + uint(mappingInfo.stride) * gl_VertexIndex;
+    if (uint(mappingInfo.componentType) == COMPONENT_TYPE_HALF_FLOAT){
+        return unpackHalf2x16(Uint32Ref(address).data);
+    }
+    return getVec2(address);
 }
 
 void main(){
@@ -56,6 +66,7 @@ void main(){
         outBaseColorTexcoord = getTexcoord(uint(MATERIAL.baseColorTexcoordIndex));
     }
     outNodeIndex = NODE_INDEX;
+    outColor0 = getColor(0);
     outMaterialIndex = MATERIAL_INDEX;
 
     vec3 inPosition = getVec3(PRIMITIVE.pPositionBuffer + uint(PRIMITIVE.positionByteStride) * gl_VertexIndex);
@@ -17,6 +17,7 @@ layout (std430, buffer_reference, buffer_reference_align = 64) readonly buffer N
 
 layout (location = 0) out vec2 outBaseColorTexcoord;
 layout (location = 1) flat out uint outMaterialIndex;
+layout (location = 2) out vec4 outColor0;
 
 layout (set = 0, binding = 0) readonly buffer PrimitiveBuffer {
     Primitive primitives[];
@@ -28,11 +29,16 @@ layout (set = 0, binding = 1) readonly buffer MaterialBuffer {
 layout (set = 1, binding = 0, std430) readonly buffer NodeBuffer {
     Node nodes[];
 };
+layout (set = 1, binding = 1, std430) readonly buffer DrawIndirectionBuffer {
+    DrawIndirection drawIndirections[];
+};
 
 layout (push_constant, std430) uniform PushConstant {
     mat4 projectionView;
 } pc;
 
+#include "vertex_color.glsl"
+
 // --------------------
 // Functions.
 // --------------------
@@ -47,13 +53,18 @@ vec3 getVec3(uint64_t address){
 
 vec2 getTexcoord(uint texcoordIndex){
     IndexedAttributeMappingInfo mappingInfo = PRIMITIVE.texcoordAttributeMappingInfos.data[texcoordIndex];
-    return getVec2(mappingInfo.bytesPtr + uint(mappingInfo.stride) * gl_VertexIndex);
+    uint64_t address = mappingInfo.bytesPtr + uint(mappingInfo.stride) * gl_VertexIndex;
+    if (uint(mappingInfo.componentType) == COMPONENT_TYPE_HALF_FLOAT){
+        return unpackHalf2x16(Uint32Ref(address).data);
+    }
+    return getVec2(address);
 }
 
 void main(){
     if (int(MATERIAL.baseColorTextureIndex) != -1){
         outBaseColorTexcoord = getTexcoord(uint(MATERIAL.baseColorTexcoordIndex));
     }
+    outColor0 = getColor(0);
     outMaterialIndex = MATERIAL_INDEX;
 
     vec3 inPosition = getVec3(PRIMITIVE.pPositionBuffer + uint(PRIMITIVE.positionByteStride) * gl_VertexIndex);
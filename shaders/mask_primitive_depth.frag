@@ -0,0 +1,52 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_shader_16bit_storage : require
+#extension GL_EXT_nonuniform_qualifier : require
+#extension GL_EXT_shader_8bit_storage : require
+
+#define FRAGMENT_SHADER
+#include "indexing.glsl"
+#include "types.glsl"
+
+// Input locations must be matched to the paired vertex shader's outputs.
+// VERTEX_SHADER_TYPE=0: primitive.vert, 1: faceted_primitive.vert, 2: unlit_primitive.vert.
+#if VERTEX_SHADER_TYPE == 0
+layout (location = 4) in vec2 inBaseColorTexcoord;
+layout (location = 9) flat in uint inMaterialIndex;
+layout (location = 10) in vec4 inColor0;
+#elif VERTEX_SHADER_TYPE == 1
+layout (location = 1) in vec2 inBaseColorTexcoord;
+layout (location = 6) flat in uint inMaterialIndex;
+layout (location = 7) in vec4 inColor0;
+#else
+layout (location = 0) in vec2 inBaseColorTexcoord;
+layout (location = 1) flat in uint inMaterialIndex;
+layout (location = 2) in vec4 inColor0;
+#endif
+
+layout (location = 0) out vec4 outColor;
+
+layout (set = 1, binding = 1) readonly buffer MaterialBuffer {
+    Material materials[];
+};
+layout (set = 1, binding = 2) uniform sampler2D textures[];
+
+// --------------------
+// Functions.
+// --------------------
+
+float geometricMean(vec2 v){
+    return sqrt(v.x * v.y);
+}
+
+void main(){
+    // Alpha must be calculated in the same way of the mask_*primitive.frag, for the same alpha to coverage result.
+    float alpha = (inColor0 * MATERIAL.baseColorFactor * texture(textures[int(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord)).a;
+    alpha *= 1.0 + geometricMean(textureQueryLod(textures[int(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord)) * 0.25;
+    // Apply sharpness to the alpha.
+    // See: https://bgolus.medium.com/anti-aliased-alpha-test-the-esoteric-alpha-to-coverage-8b177335ae4f.
+    alpha = (alpha - MATERIAL.alphaCutoff) / max(fwidth(alpha), 1e-4) + 0.5;
+
+    // Only alpha is used, as color write is disabled.
+    outColor = vec4(0.0, 0.0, 0.0, alpha);
+}
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 layout (location = 0) in vec2 inBaseColorTexcoord;
 layout (location = 1) flat in uint inMaterialIndex;
+layout (location = 2) in vec4 inColor0;
 
 layout (location = 0) out vec4 outColor;
 
@@ -27,7 +28,7 @@ float geometricMean(vec2 v){
 }
 
 void main(){
-    vec4 baseColor = MATERIAL.baseColorFactor * texture(textures[int(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord);
+    vec4 baseColor = inColor0 * MATERIAL.baseColorFactor * texture(textures[int(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord);
 
     float alpha = baseColor.a;
     alpha *= 1.0 + geometricMean(textureQueryLod(textures[int(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord)) * 0.25;
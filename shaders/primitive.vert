@@ -23,6 +23,10 @@ layout (location = 6) out vec2 outNormalTexcoord;
 layout (location = 7) out vec2 outOcclusionTexcoord;
 layout (location = 8) out vec2 outEmissiveTexcoord;
 layout (location = 9) flat out uint outMaterialIndex;
+layout (location = 10) out vec4 outColor0;
+
+// Depth prepass pipelines share this shader, and their depths must be exactly matched for the equal depth test.
+invariant gl_Position;
 
 layout (set = 1, binding = 0) readonly buffer PrimitiveBuffer {
     Primitive primitives[];
@@ -34,12 +38,22 @@ layout (set = 1, binding = 1) readonly buffer MaterialBuffer {
 layout (set = 2, binding = 0, std430) readonly buffer NodeBuffer {
     Node nodes[];
 };
+layout (set = 2, binding = 1, std430) readonly buffer DrawIndirectionBuffer {
+    DrawIndirection drawIndirections[];
+};
 
-layout (push_constant, std430) uniform PushConstant {
+// Must be matched to vk_gltf_viewer::vulkan::pl::Primitive::Camera.
+layout (std430, buffer_reference, buffer_reference_align = 16) readonly buffer Camera {
     mat4 projectionView;
     vec3 viewPosition;
+};
+
+layout (push_constant, std430) uniform PushConstant {
+    Camera camera;
 } pc;
 
+#include "vertex_color.glsl"
+
 // --------------------
 // Functions.
 // --------------------
@@ -58,12 +72,44 @@ vec4 getVec4(uint64_t address){
 
 vec2 getTexcoord(uint texcoordIndex){
     IndexedAttributeMappingInfo mappingInfo = PRIMITIVE.texcoordAttributeMappingInfos.data[texcoordIndex];
-    return getVec2(mappingInfo.bytesPtr + uint(mappingInfo.stride) * gl_VertexIndex);
+    uint64_t address = mappingInfo.bytesPtr + uint(mappingInfo.stride) * gl_VertexIndex;
+    if (uint(mappingInfo.componentType) == COMPONENT_TYPE_HALF_FLOAT){
+        return unpackHalf2x16(Uint32Ref(address).data);
+    }
+    return getVec2(address);
+}
+
+// Inverse of the octahedral mapping. See https://jcgt.org/published/0003/02/01/.
+vec3 fromOctahedral(vec2 p){
+    vec3 v = vec3(p, 1.0 - abs(p.x) - abs(p.y));
+    if (v.z < 0.0){
+        v.xy = (1.0 - abs(v.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(v.xy, vec2(0.0)));
+    }
+    return normalize(v);
+}
+
+vec3 getNormal(){
+    uint64_t address = PRIMITIVE.pNormalBuffer + uint(PRIMITIVE.normalByteStride) * gl_VertexIndex;
+    if ((uint(PRIMITIVE.attributeEncodingFlags) & ATTRIBUTE_ENCODING_FLAG_OCTAHEDRAL_NORMAL) != 0U){
+        return fromOctahedral(unpackSnorm2x16(Uint32Ref(address).data));
+    }
+    return getVec3(address);
+}
+
+vec4 getTangent(){
+    uint64_t address = PRIMITIVE.pTangentBuffer + uint(PRIMITIVE.tangentByteStride) * gl_VertexIndex;
+    if ((uint(PRIMITIVE.attributeEncodingFlags) & ATTRIBUTE_ENCODING_FLAG_OCTAHEDRAL_TANGENT) != 0U){
+        // [0, 16): 16-bit snorm x, [16, 31): 15-bit snorm y, [31]: bitangent sign.
+        uint encoded = Uint32Ref(address).data;
+        vec2 p = vec2(unpackSnorm2x16(encoded).x, float((encoded >> 16U) & 0x7FFFU) / 32767.0 * 2.0 - 1.0);
+        return vec4(fromOctahedral(p), (encoded & 0x80000000U) != 0U ? -1.0 : 1.0);
+    }
+    return getVec4(address);
 }
 
 void main(){
     vec3 inPosition = getVec3(PRIMITIVE.pPositionBuffer + uint(PRIMITIVE.positionByteStride) * gl_VertexIndex);
-    vec3 inNormal = getVec3(PRIMITIVE.pNormalBuffer + uint(PRIMITIVE.normalByteStride) * gl_VertexIndex);
+    vec3 inNormal = getNormal();
 
     mat4 transform = TRANSFORM;
     outPosition = (transform * vec4(inPosition, 1.0)).xyz;
@@ -76,7 +122,7 @@ void main(){
         outMetallicRoughnessTexcoord = getTexcoord(uint(MATERIAL.metallicRoughnessTexcoordIndex));
     }
     if (int(MATERIAL.normalTextureIndex) != -1){
-        vec4 inTangent = getVec4(PRIMITIVE.pTangentBuffer + uint(PRIMITIVE.tangentByteStride) * gl_VertexIndex);
+        vec4 inTangent = getTangent();
         outTBN[0] = normalize(mat3(transform) * inTangent.xyz); // T
         outTBN[1] = cross(outTBN[2], outTBN[0]) * -inTangent.w; // B
 
@@ -88,7 +134,8 @@ void main(){
     if (int(MATERIAL.emissiveTextureIndex) != -1){
         outEmissiveTexcoord = getTexcoord(uint(MATERIAL.emissiveTexcoordIndex));
     }
+    outColor0 = getColor(0);
     outMaterialIndex = MATERIAL_INDEX;
 
-    gl_Position = pc.projectionView * vec4(outPosition, 1.0);
+    gl_Position = pc.camera.projectionView * vec4(outPosition, 1.0);
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #version 460
+#extension GL_EXT_buffer_reference : require
 
 const vec3[] positions = {
     { -1.0, -1.0, -1.0 },
@@ -13,12 +14,14 @@ const vec3[] positions = {
 
 layout (location = 0) out vec3 outPosition;
 
+layout (std430, buffer_reference, buffer_reference_align = 16) readonly buffer Mat4Ref { mat4 data; };
+
 layout (push_constant) uniform PushConstant {
-    mat4 projectionView;
+    Mat4Ref projectionView;
 } pc;
 
 void main() {
     outPosition = positions[gl_VertexIndex];
-    gl_Position = (pc.projectionView * vec4(outPosition, 1.0));
+    gl_Position = (pc.projectionView.data * vec4(outPosition, 1.0));
     gl_Position.z = 0.0; // Use reverse Z.
 }
\ No newline at end of file
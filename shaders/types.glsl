@@ -25,9 +25,23 @@ struct Material {
 
 #ifdef VERTEX_SHADER
 
+// Must be matched to vk_gltf_viewer::gltf::AssetPrimitiveInfo::ComponentType.
+#define COMPONENT_TYPE_FLOAT 0U
+#define COMPONENT_TYPE_UNSIGNED_BYTE_NORMALIZED 1U
+#define COMPONENT_TYPE_UNSIGNED_SHORT_NORMALIZED 2U
+#define COMPONENT_TYPE_HALF_FLOAT 3U
+#define COMPONENT_TYPE_OCTAHEDRAL 4U
+
+#define ATTRIBUTE_ENCODING_FLAG_OCTAHEDRAL_NORMAL 1U
+#define ATTRIBUTE_ENCODING_FLAG_OCTAHEDRAL_TANGENT 2U
+
+layout (std430, buffer_reference, buffer_reference_align = 4) readonly buffer Uint32Ref { uint data; };
+
 struct IndexedAttributeMappingInfo {
     uint64_t bytesPtr;
     uint8_t stride;
+    uint8_t componentType;
+    uint8_t componentCount;
 };
 
 layout (std430, buffer_reference, buffer_reference_align = 8) readonly buffer IndexedAttributeMappingInfos { IndexedAttributeMappingInfo data[]; };
@@ -41,8 +55,15 @@ struct Primitive {
     uint8_t positionByteStride;
     uint8_t normalByteStride;
     uint8_t tangentByteStride;
-    uint8_t padding;
+    uint8_t attributeEncodingFlags;
     uint materialIndex;
 };
 
+// Must be matched to vk_gltf_viewer::gltf::AssetSceneGpuBuffers::DrawIndirection.
+struct DrawIndirection {
+    uint nodeIndex;
+    uint instanceIndex;
+    uint primitiveIndex;
+};
+
 #endif
\ No newline at end of file
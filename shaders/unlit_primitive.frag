@@ -10,6 +10,7 @@
 
 layout (location = 0) in vec2 inBaseColorTexcoord;
 layout (location = 1) flat in uint inMaterialIndex;
+layout (location = 2) in vec4 inColor0;
 
 layout (location = 0) out vec4 outColor;
 
@@ -21,6 +22,6 @@ layout (set = 1, binding = 2) uniform sampler2D textures[];
 layout (early_fragment_tests) in;
 
 void main(){
-    vec4 baseColor = MATERIAL.baseColorFactor * texture(textures[int(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord);
+    vec4 baseColor = inColor0 * MATERIAL.baseColorFactor * texture(textures[int(MATERIAL.baseColorTextureIndex) + 1], inBaseColorTexcoord);
     outColor = vec4(baseColor.rgb, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+// --------------------
+// Vertex color (COLOR_<i>) attribute fetching. PRIMITIVE macro and Primitive type MUST be defined before including this.
+// --------------------
+
+layout (std430, buffer_reference, buffer_reference_align = 4) readonly buffer FloatComponents { float data[]; };
+layout (std430, buffer_reference, buffer_reference_align = 2) readonly buffer Uint16Components { uint16_t data[]; };
+layout (std430, buffer_reference, buffer_reference_align = 1) readonly buffer Uint8Components { uint8_t data[]; };
+
+// Get the COLOR_<colorIndex> attribute of the current vertex, or vec4(1.0) if primitive doesn't have any color attribute.
+vec4 getColor(uint colorIndex){
+    if (uint64_t(PRIMITIVE.colorAttributeMappingInfos) == 0UL){
+        return vec4(1.0);
+    }
+
+    IndexedAttributeMappingInfo mappingInfo = PRIMITIVE.colorAttributeMappingInfos.data[colorIndex];
+    uint64_t address = mappingInfo.bytesPtr + uint(mappingInfo.stride) * gl_VertexIndex;
+
+    // glTF Specification:
+    // COLOR_n: VEC3/VEC4 of float, unsigned byte normalized or unsigned short normalized.
+    // If alpha is not presented (VEC3), it is treated as 1.0.
+    vec4 color = vec4(1.0);
+    for (uint i = 0; i < uint(mappingInfo.componentCount); ++i){
+        switch (uint(mappingInfo.componentType)){
+        case COMPONENT_TYPE_FLOAT:
+            color[i] = FloatComponents(address).data[i];
+            break;
+        case COMPONENT_TYPE_UNSIGNED_BYTE_NORMALIZED:
+            color[i] = float(uint(Uint8Components(address).data[i])) / 255.0;
+            break;
+        case COMPONENT_TYPE_UNSIGNED_SHORT_NORMALIZED:
+            color[i] = float(uint(Uint16Components(address).data[i])) / 65535.0;
+            break;
+        }
+    }
+    return color;
+}